@@ -18,6 +18,12 @@ import Foundation
         return debugImages ?? super.getDebugImagesFromCacheForThreads(threads: threads)
     }
     
+    public var getDebugImagesFromCacheForInstructionAddressesInvocations = Invocations<[NSNumber]>()
+    public override func getDebugImagesFromCacheForInstructionAddresses(_ addresses: [NSNumber]) -> [DebugMeta] {
+        getDebugImagesFromCacheForInstructionAddressesInvocations.record(addresses)
+        return debugImages ?? super.getDebugImagesFromCacheForInstructionAddresses(addresses)
+    }
+    
     public var getDebugImagesFromCacheInvocations = Invocations<Void>()
     public override func getDebugImagesFromCache() -> [DebugMeta] {
         getDebugImagesFromCacheInvocations.record(Void())
@@ -6,6 +6,9 @@
 #import "SentryHub+Private.h"
 #import "SentryInternalDefines.h"
 #import "SentryProfileCollector.h"
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+#    import "SentryProfiler+Private.h"
+#endif // SENTRY_TARGET_PROFILING_SUPPORTED
 #import "SentrySDK+Private.h"
 #import "SentrySerialization.h"
 #import "SentrySwift.h"
@@ -15,6 +18,7 @@
 #import <SentryUser.h>
 
 #if SENTRY_TARGET_PROFILING_SUPPORTED
+#    import "SentryContinuousProfiler.h"
 #    import "SentryProfiledTracerConcurrency.h"
 #    import "SentryProfilerSerialization.h"
 #    import "SentryTraceProfiler.h"
@@ -204,6 +208,17 @@ static BOOL _framesTrackingMeasurementHybridSDKMode = NO;
     sentry_discardProfilerCorrelatedToTrace(traceId, SentrySDKInternal.currentHub);
 }
 
++ (nullable NSDictionary<NSString *, id> *)profilerSamplingTelemetry
+{
+    return [SentryContinuousProfiler samplingTelemetry];
+}
+
++ (void)setProfilerAdaptiveSamplingWithCPUBudget:(double)cpuBudget
+                         idleTicksBeforeSkipping:(uint32_t)idleTicksBeforeSkipping
+{
+    sentry_setProfilerAdaptiveSampling(cpuBudget, idleTicksBeforeSkipping);
+}
+
 #endif // SENTRY_TARGET_PROFILING_SUPPORTED
 
 + (BOOL)framesTrackingMeasurementHybridSDKMode
@@ -64,13 +64,19 @@ _sentry_threadUnsafe_transmitChunkEnvelope(void)
     }
     SentryProfiler *_Nonnull profiler
         = SENTRY_UNWRAP_NULLABLE(SentryProfiler, _threadUnsafe_gContinuousCurrentProfiler);
-    const auto profilerState = [profiler.state copyProfilingData];
-    [profiler.state clear]; // !!!: profile this to see if it takes longer than one sample duration
-                            // length: ~9ms
-
-    NSDictionary *_Nonnull metricProfilerState = [profiler.metricProfiler copyMetricProfilerData];
+    // Each chunk gets its own frame and stack tables so that it can be symbolicated on its own,
+    // and detaching them means the sampler never waits on a copy of the chunk. Samples still
+    // waiting to be drained belong to this chunk.
+    [profiler drainPendingSamples];
+    SentryProfilerMutableState *const profilerState = [profiler.state detachMutableState];
+
+    SentryMetricProfilerSnapshot *const metricProfilerState =
+        [profiler.metricProfiler snapshotMetricProfilerData];
     [profiler.metricProfiler clear];
 
+    NSDictionary *_Nullable samplingTelemetry =
+        [profiler serializedSamplingTelemetrySinceLastChunk];
+
 #    if SENTRY_HAS_UIKIT
     SentryScreenFrames *screenFrameData =
         [SentryProfilingScreenFramesHelper copyScreenFrames:sentry_framesTrackerGetCurrentFrames()];
@@ -85,8 +91,8 @@ _sentry_threadUnsafe_transmitChunkEnvelope(void)
     sentry_dispatchAsync(SentryDependencyContainerSwiftHelper.dispatchQueueWrapper, ^{
         NSDictionary *_Nonnull serializedMetrics
             = serializeContinuousProfileMetrics(metricProfilerState);
-        SentryEnvelope *_Nullable envelope
-            = sentry_continuousProfileChunkEnvelope(profilerID, profilerState, serializedMetrics
+        SentryEnvelope *_Nullable envelope = sentry_continuousProfileChunkEnvelope(
+            profilerID, profilerState, serializedMetrics, samplingTelemetry
 #    if SENTRY_HAS_UIKIT
                 ,
                 screenFrameData
@@ -189,6 +195,12 @@ _sentry_unsafe_stopTimerAndCleanup()
     return _threadUnsafe_gContinuousCurrentProfiler.profilerId;
 }
 
++ (nullable NSDictionary<NSString *, id> *)samplingTelemetry
+{
+    std::lock_guard<std::mutex> l(_threadUnsafe_gContinuousProfilerLock);
+    return [_threadUnsafe_gContinuousCurrentProfiler serializedSamplingTelemetry];
+}
+
 #    pragma mark - Private
 
 /**
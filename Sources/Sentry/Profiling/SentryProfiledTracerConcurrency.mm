@@ -323,7 +323,12 @@ sentry_stopProfilerDueToFinishedTransaction(SentryHubInternal *hub,
     // milliseconds. Therefore, we move this to a background thread to avoid potentially
     // blocking the main thread.
     sentry_dispatchAsync(dispatchQueue, ^{
-        const auto profilingData = [profiler.state copyProfilingData];
+        // The profiler may keep running for other transactions, so the samples taken until the
+        // end of this one might not have been drained yet.
+        [profiler drainPendingSamples];
+        const auto profilingData =
+            [profiler.state copyProfilingDataFromSystemTime:transaction.startSystemTime
+                                               toSystemTime:transaction.endSystemTime];
 
         const auto profileEnvelopeItem = sentry_traceProfileEnvelopeItem(
             hub, profiler, profilingData, transaction, startTimestamp);
@@ -68,25 +68,21 @@ _sentry_serializedTraceProfileSamplesWithRelativeTimestamps(
 }
 
 /**
- * Given an array of continuous profile samples with absolute NSDate timestamps, return the
- * serialized JSON mapping with their data.
- * */
-NSArray<NSDictionary *> *
-_sentry_serializedContinuousProfileSamples(NSArray<SentrySample *> *samples)
+ * Returns the debug images containing the instruction addresses of the given profile frames, so
+ * that a profile only carries the few images it references instead of every loaded image.
+ */
+static NSArray<SentryDebugMeta *> *
+_sentry_debugImagesForProfileFrames(NSArray<NSDictionary<NSString *, id> *> *frames)
 {
-    NSMutableArray<NSDictionary *> *result = [NSMutableArray<NSDictionary *> array];
-    [samples enumerateObjectsUsingBlock:^(
-        SentrySample *_Nonnull sample, NSUInteger idx, BOOL *_Nonnull stop) {
-        NSMutableDictionary *dict = [NSMutableDictionary dictionary];
-        dict[@"timestamp"] = @(sample.absoluteNSDateInterval);
-        dict[@"thread_id"] = sentry_stringForUInt64(sample.threadID);
-        dict[@"stack_id"] = sample.stackIndex;
-        if (sample.queueAddress) {
-            dict[@"queue_address"] = sample.queueAddress;
+    NSMutableArray<NSNumber *> *addresses = [NSMutableArray arrayWithCapacity:frames.count];
+    for (NSDictionary<NSString *, id> *frame in frames) {
+        NSString *_Nullable instructionAddress = frame[@"instruction_addr"];
+        if (instructionAddress != nil) {
+            [addresses addObject:@(strtoull(instructionAddress.UTF8String, NULL, 16))];
         }
-        [result addObject:dict];
-    }];
-    return result;
+    }
+    return [SentryDependencyContainer.sharedInstance.debugImageProvider
+        getDebugImagesFromCacheForInstructionAddresses:addresses];
 }
 
 #    pragma mark - Exported for tests
@@ -219,17 +215,20 @@ sentry_serializedTraceProfileData(
     return payload;
 }
 
+/**
+ * Builds the payload of a continuous profile chunk, except for its @c profile object, which is
+ * streamed directly from the profiler's tables by @c sentry_continuousProfileChunkEnvelope.
+ */
 NSMutableDictionary<NSString *, id> *
 sentry_serializedContinuousProfileChunk(SentryId *profileID, SentryId *chunkID,
-    NSDictionary<NSString *, id> *profileData, NSDictionary<NSString *, id> *serializedMetrics,
-    NSArray<SentryDebugMeta *> *debugMeta, SentryHubInternal *hub
+    NSDictionary<NSString *, id> *serializedMetrics, NSArray<SentryDebugMeta *> *debugMeta,
+    SentryHubInternal *hub
 #    if SENTRY_HAS_UIKIT
     ,
     SentryScreenFrames *gpuData
 #    endif // SENTRY_HAS_UIKIT
 )
 {
-    NSMutableArray<SentrySample *> *const samples = profileData[@"profile"][@"samples"];
     // !!!: assumption: in trace profiling, we would avoid sending a payload with less than 2
     // samples. now, we may have previously sent a chunk with many samples, and then this chunk may
     // be the last of the continuous profiling session and it only has 1 sample. assuming we'll want
@@ -238,11 +237,6 @@ sentry_serializedContinuousProfileChunk(SentryId *profileID, SentryId *chunkID,
     // a 1-sample chunk is acceptable.
 
     NSMutableDictionary<NSString *, id> *payload = [NSMutableDictionary<NSString *, id> dictionary];
-    NSMutableDictionary<NSString *, id> *const profile = [profileData[@"profile"] mutableCopy];
-    profile[@"samples"] = _sentry_serializedContinuousProfileSamples(samples);
-
-    payload[@"profile"] = profile;
-
     payload[@"version"] = @"2";
     NSMutableArray<NSDictionary<NSString *, id> *> *debugImages =
         [[NSMutableArray<NSDictionary<NSString *, id> *> alloc] init];
@@ -304,8 +298,9 @@ sentry_serializedContinuousProfileChunk(SentryId *profileID, SentryId *chunkID,
 
 #    pragma mark - Public
 
-SentryEnvelope *_Nullable sentry_continuousProfileChunkEnvelope(
-    SentryId *profileID, NSDictionary *profileState, NSDictionary *metricProfilerState
+SentryEnvelope *_Nullable sentry_continuousProfileChunkEnvelope(SentryId *profileID,
+    SentryProfilerMutableState *profileState, NSDictionary *metricProfilerState,
+    NSDictionary *_Nullable samplingTelemetry
 #    if SENTRY_HAS_UIKIT
     ,
     SentryScreenFrames *gpuData
@@ -314,8 +309,9 @@ SentryEnvelope *_Nullable sentry_continuousProfileChunkEnvelope(
 {
     SentryId *chunkID = [[SentryId alloc] init];
     NSMutableDictionary<NSString *, id> *payload = sentry_serializedContinuousProfileChunk(
-        profileID, chunkID, profileState, metricProfilerState,
-        [SentryDependencyContainer.sharedInstance.debugImageProvider getDebugImagesFromCache],
+        profileID, chunkID, metricProfilerState,
+        [SentryDependencyContainer.sharedInstance.debugImageProvider
+            getDebugImagesFromCacheForInstructionAddresses:profileState.frameInstructionAddresses],
         SentrySDKInternal.currentHub
 #    if SENTRY_HAS_UIKIT
         ,
@@ -328,12 +324,29 @@ SentryEnvelope *_Nullable sentry_continuousProfileChunkEnvelope(
         return nil;
     }
 
-    NSData *JSONData = [SentrySerializationSwift dataWithJSONObject:payload];
-    if (JSONData == nil) {
+    if (samplingTelemetry != nil) {
+        payload[@"sampling_telemetry"] = samplingTelemetry;
+    }
+
+    NSData *payloadJSONData = [SentrySerializationSwift dataWithJSONObject:payload];
+    if (payloadJSONData == nil || payloadJSONData.length < 2) {
         SENTRY_LOG_DEBUG(@"Failed to encode profile to JSON.");
         return nil;
     }
 
+    // The samples, stacks and frames make up nearly all of a chunk, so instead of building them
+    // into the payload dictionary, stream them into the envelope data and splice the rest of the
+    // payload in after them, dropping its opening brace.
+    NSMutableData *JSONData = [NSMutableData dataWithCapacity:payloadJSONData.length];
+    static const char kProfileKey[] = "{\"profile\":";
+    [JSONData appendBytes:kProfileKey length:sizeof(kProfileKey) - 1];
+    [profileState appendContinuousProfileChunkJSONToData:JSONData];
+    if (payloadJSONData.length > 2) {
+        [JSONData appendBytes:"," length:1];
+    }
+    [JSONData appendBytes:(const char *)payloadJSONData.bytes + 1
+                   length:payloadJSONData.length - 1];
+
     SENTRY_LOG_DEBUG(@"Transmitting continuous profile chunk.");
 
 #    if defined(SENTRY_TEST) || defined(SENTRY_TEST_CI)
@@ -360,8 +373,8 @@ SentryEnvelopeItem *_Nullable sentry_traceProfileEnvelopeItem(SentryHubInternal
     SentryProfiler *profiler, NSDictionary<NSString *, id> *profilingData,
     SentryTransaction *transaction, NSDate *startTimestamp)
 {
-    NSArray<SentryDebugMeta *> *images =
-        [SentryDependencyContainer.sharedInstance.debugImageProvider getDebugImagesFromCache];
+    NSArray<SentryDebugMeta *> *images
+        = _sentry_debugImagesForProfileFrames(profilingData[@"profile"][@"frames"]);
     NSMutableDictionary<NSString *, id> *payload = sentry_serializedTraceProfileData(
         profilingData, transaction.startSystemTime, transaction.endSystemTime,
         sentry_profilerTruncationReasonName(profiler.truncationReason),
@@ -395,6 +408,11 @@ SentryEnvelopeItem *_Nullable sentry_traceProfileEnvelopeItem(SentryHubInternal
     payload[@"transaction"] = transactionDict;
     payload[@"timestamp"] = sentry_toIso8601String(startTimestamp);
 
+    NSDictionary *_Nullable samplingTelemetry = [profiler serializedSamplingTelemetry];
+    if (samplingTelemetry != nil) {
+        payload[@"sampling_telemetry"] = samplingTelemetry;
+    }
+
     NSData *JSONData = [SentrySerializationSwift dataWithJSONObject:payload];
     if (JSONData == nil) {
         SENTRY_LOG_DEBUG(@"Failed to encode profile to JSON.");
@@ -418,11 +436,14 @@ NSMutableDictionary<NSString *, id> *_Nullable sentry_collectProfileDataHybridSD
         return nil;
     }
 
-    return sentry_serializedTraceProfileData([profiler.state copyProfilingData], startSystemTime,
-        endSystemTime, sentry_profilerTruncationReasonName(profiler.truncationReason),
+    [profiler drainPendingSamples];
+    NSDictionary<NSString *, id> *profilingData =
+        [profiler.state copyProfilingDataFromSystemTime:startSystemTime toSystemTime:endSystemTime];
+    return sentry_serializedTraceProfileData(profilingData, startSystemTime, endSystemTime,
+        sentry_profilerTruncationReasonName(profiler.truncationReason),
         [profiler.metricProfiler serializeTraceProfileMetricsBetween:startSystemTime
                                                                  and:endSystemTime],
-        [SentryDependencyContainer.sharedInstance.debugImageProvider getDebugImagesFromCache], hub
+        _sentry_debugImagesForProfileFrames(profilingData[@"profile"][@"frames"]), hub
 #    if SENTRY_HAS_UIKIT
         ,
         profiler.screenFrameData
@@ -5,11 +5,14 @@
 #    import "SentryDependencyContainerSwiftHelper.h"
 #    import "SentryFormatter.h"
 #    import "SentryInternalDefines.h"
-#    import "SentryProfileDebugLoggerHelper.h"
+#    import "SentryProfileInterningTables.hpp"
 #    import "SentryProfileTimeseries.h"
 #    import "SentryProfilerSampleCreation.h"
+#    import "SentryProfilerState+ObjCpp.h"
 #    import "SentryProfilingSwiftHelpers.h"
 #    import <mach/mach_types.h>
+#    import <algorithm>
+#    import <cstring>
 #    import <mach/port.h>
 #    import <mutex>
 
@@ -45,21 +48,372 @@ parseBacktraceSymbolsFunctionName(const char *symbol)
     return [symbolNSStr substringWithRange:[match rangeAtIndex:1]];
 }
 
-@implementation SentryProfilerMutableState
+namespace {
+
+/** The function name of the frame that ends a truncated stack. */
+const char *const kTruncatedStackMarkerFunction = "<truncated>";
+
+/**
+ * Returns the wall clock time a sample was taken at. Backtraces are appended on the drain queue,
+ * some time after they were sampled, so the current date is moved back by the system time that has
+ * passed since the sample's timestamp.
+ */
+NSTimeInterval
+dateIntervalOfSample(std::uint64_t absoluteTimestamp)
+{
+    const auto nowDateInterval = sentry_getDate().timeIntervalSince1970;
+    // The difference is taken as unsigned and then converted, so that a timestamp that is ahead of
+    // the current system time results in a negative delay instead of a huge one.
+    const auto delayNs = static_cast<std::int64_t>(sentry_getSystemTime() - absoluteTimestamp);
+    return nowDateInterval - static_cast<double>(delayNs) / 1e9;
+}
+
+#    if defined(DEBUG)
+NSString *_Nullable
+symbolicatedFunctionName(std::uintptr_t address)
+{
+    void *const symbolAddress = reinterpret_cast<void *>(address);
+    const auto symbols = backtrace_symbols(&symbolAddress, 1);
+    if (symbols == nullptr) {
+        return nil;
+    }
+    const auto functionName = parseBacktraceSymbolsFunctionName(symbols[0]);
+    free(symbols);
+    return functionName;
+}
+#    endif // defined(DEBUG)
+
+/**
+ * Writes JSON tokens into an @c NSMutableData through a small stack buffer, so that a chunk is
+ * encoded with a handful of appends instead of one per token.
+ */
+class JSONWriter {
+public:
+    explicit JSONWriter(NSMutableData *data)
+        : data_(data)
+    {
+    }
+
+    ~JSONWriter() { flush(); }
+
+    JSONWriter(const JSONWriter &) = delete;
+    JSONWriter &operator=(const JSONWriter &) = delete;
+
+    void
+    append(const char *bytes, std::size_t count)
+    {
+        if (length_ + count > sizeof(buffer_)) {
+            flush();
+            if (count > sizeof(buffer_)) {
+                [data_ appendBytes:bytes length:count];
+                return;
+            }
+        }
+        std::memcpy(buffer_ + length_, bytes, count);
+        length_ += count;
+    }
+
+    void
+    append(const char *cString)
+    {
+        append(cString, std::strlen(cString));
+    }
+
+    void
+    appendChar(char c)
+    {
+        append(&c, 1);
+    }
+
+    void
+    appendUInt64(std::uint64_t value)
+    {
+        char number[24];
+        const auto count = snprintf(number, sizeof(number), "%llu", value);
+        append(number, static_cast<std::size_t>(count));
+    }
+
+    void
+    appendDouble(double value)
+    {
+        // 17 significant digits round-trip every double, matching NSJSONSerialization.
+        char number[32];
+        const auto count = snprintf(number, sizeof(number), "%.17g", value);
+        append(number, static_cast<std::size_t>(count));
+    }
+
+    void
+    appendString(const char *utf8)
+    {
+        appendChar('"');
+        for (auto c = utf8; *c != '\0'; c++) {
+            const auto byte = static_cast<unsigned char>(*c);
+            if (byte == '"' || byte == '\\') {
+                const char escaped[] = { '\\', static_cast<char>(byte) };
+                append(escaped, sizeof(escaped));
+            } else if (byte < 0x20) {
+                char escaped[8];
+                const auto count = snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+                append(escaped, static_cast<std::size_t>(count));
+            } else {
+                appendChar(static_cast<char>(byte));
+            }
+        }
+        appendChar('"');
+    }
+
+    void
+    appendValue(id value)
+    {
+        if ([value isKindOfClass:[NSString class]]) {
+            const auto utf8 = [(NSString *)value UTF8String];
+            appendString(utf8 != nullptr ? utf8 : "");
+            return;
+        }
+        NSNumber *const number = value;
+        const auto type = number.objCType[0];
+        if (type == 'f' || type == 'd') {
+            appendDouble(number.doubleValue);
+        } else {
+            char string[24];
+            const auto count = snprintf(string, sizeof(string), "%lld", number.longLongValue);
+            append(string, static_cast<std::size_t>(count));
+        }
+    }
+
+    void
+    flush()
+    {
+        if (length_ > 0) {
+            [data_ appendBytes:buffer_ length:length_];
+            length_ = 0;
+        }
+    }
+
+private:
+    NSMutableData *data_;
+    char buffer_[4096];
+    std::size_t length_ = 0;
+};
+
+} // namespace
+
+@implementation SentryProfilerMutableState {
+    FrameTable _frameTable;
+    StackTable _stackTable;
+    /** Scratch storage for the frame indices of the backtrace being interned. */
+    std::vector<std::uint32_t> _frameIndices;
+
+    std::vector<std::uint64_t> _sampleTimestamps;
+    std::vector<NSTimeInterval> _sampleNSDateIntervals;
+    std::vector<std::uint32_t> _sampleStackIndices;
+    std::vector<std::uint64_t> _sampleThreadIDs;
+
+    NSMutableArray<SentrySample *> *_samples;
+    NSMutableArray<NSDictionary<NSString *, id> *> *_frames;
+    NSMutableArray<NSArray<NSNumber *> *> *_stacks;
+}
 
 - (instancetype)init
 {
     if (self = [super init]) {
         _samples = [NSMutableArray<SentrySample *> array];
-        _stacks = [NSMutableArray<NSArray<NSNumber *> *> array];
         _frames = [NSMutableArray<NSDictionary<NSString *, id> *> array];
+        _stacks = [NSMutableArray<NSArray<NSNumber *> *> array];
         _threadMetadata = [NSMutableDictionary<NSString *, NSMutableDictionary *> dictionary];
-        _frameIndexLookup = [NSMutableDictionary<NSString *, NSNumber *> dictionary];
-        _stackIndexLookup = [NSMutableDictionary<NSString *, NSNumber *> dictionary];
     }
     return self;
 }
 
+- (std::uint32_t)internStackWithAddresses:(const std::vector<std::uintptr_t> &)addresses
+                              isTruncated:(BOOL)isTruncated
+                               isNewStack:(nullable BOOL *)isNewStack
+{
+    _frameIndices.resize(addresses.size());
+    for (std::vector<std::uintptr_t>::size_type i = 0; i < addresses.size(); i++) {
+        _frameIndices[i] = _frameTable.intern(addresses[i]);
+    }
+    if (isTruncated) {
+        _frameIndices.push_back(_frameTable.intern(kTruncatedStackMarkerAddress));
+        _numTruncatedSamples++;
+    }
+    const auto stackCount = _stackTable.size();
+    const auto stackIndex = _stackTable.intern(_frameIndices.data(), _frameIndices.size());
+    if (isNewStack != nullptr) {
+        *isNewStack = _stackTable.size() > stackCount;
+    }
+    return stackIndex;
+}
+
+- (void)appendSampleWithStackIndex:(std::uint32_t)stackIndex
+                 absoluteTimestamp:(std::uint64_t)absoluteTimestamp
+            absoluteNSDateInterval:(NSTimeInterval)absoluteNSDateInterval
+                          threadID:(std::uint64_t)threadID
+{
+    _sampleTimestamps.push_back(absoluteTimestamp);
+    _sampleNSDateIntervals.push_back(absoluteNSDateInterval);
+    _sampleStackIndices.push_back(stackIndex);
+    _sampleThreadIDs.push_back(threadID);
+}
+
+- (NSArray<SentrySample *> *)samples
+{
+    for (auto i = static_cast<std::size_t>(_samples.count); i < _sampleTimestamps.size(); i++) {
+        const auto sample = sentry_profilerSampleWithStackIndex(_sampleStackIndices[i],
+            _sampleTimestamps[i], _sampleNSDateIntervals[i], _sampleThreadIDs[i]);
+        [_samples addObject:sample];
+    }
+    return _samples;
+}
+
+- (NSRange)rangeOfSamplesFromSystemTime:(uint64_t)startSystemTime
+                           toSystemTime:(uint64_t)endSystemTime
+{
+    const auto first
+        = std::lower_bound(_sampleTimestamps.cbegin(), _sampleTimestamps.cend(), startSystemTime);
+    const auto end = std::upper_bound(first, _sampleTimestamps.cend(), endSystemTime);
+    return NSMakeRange(static_cast<NSUInteger>(first - _sampleTimestamps.cbegin()),
+        static_cast<NSUInteger>(end - first));
+}
+
+- (NSArray<NSDictionary<NSString *, id> *> *)frames
+{
+    for (auto frameIndex = static_cast<std::uint32_t>(_frames.count);
+        frameIndex < _frameTable.size(); frameIndex++) {
+        const auto address = _frameTable.addressAt(frameIndex);
+        const auto frame = [NSMutableDictionary<NSString *, id> dictionary];
+        if (address == kTruncatedStackMarkerAddress) {
+            frame[@"function"] = @(kTruncatedStackMarkerFunction);
+            [_frames addObject:frame];
+            continue;
+        }
+        frame[@"instruction_addr"] = sentry_formatHexAddressUInt64(address);
+#    if defined(DEBUG)
+        frame[@"function"] = symbolicatedFunctionName(address);
+#    endif // defined(DEBUG)
+        [_frames addObject:frame];
+    }
+    return _frames;
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)stacks
+{
+    for (auto stackIndex = static_cast<std::uint32_t>(_stacks.count);
+        stackIndex < _stackTable.size(); stackIndex++) {
+        _stackTable.framesOfStack(stackIndex, _frameIndices);
+        const auto stack = [NSMutableArray<NSNumber *> arrayWithCapacity:_frameIndices.size()];
+        for (const auto frameIndex : _frameIndices) {
+            [stack addObject:@(frameIndex)];
+        }
+        [_stacks addObject:stack];
+    }
+    return _stacks;
+}
+
+- (NSArray<NSNumber *> *)frameInstructionAddresses
+{
+    const auto addresses = [NSMutableArray<NSNumber *> arrayWithCapacity:_frameTable.size()];
+    for (std::uint32_t frameIndex = 0; frameIndex < _frameTable.size(); frameIndex++) {
+        const auto address = _frameTable.addressAt(frameIndex);
+        if (address != kTruncatedStackMarkerAddress) {
+            [addresses addObject:@(address)];
+        }
+    }
+    return addresses;
+}
+
+- (void)appendContinuousProfileChunkJSONToData:(NSMutableData *)data
+{
+    JSONWriter writer(data);
+
+    writer.append("{\"samples\":[");
+    for (std::size_t i = 0; i < _sampleTimestamps.size(); i++) {
+        if (i > 0) {
+            writer.appendChar(',');
+        }
+        writer.append("{\"timestamp\":");
+        writer.appendDouble(_sampleNSDateIntervals[i]);
+        // thread IDs are serialized as strings, see sentry_stringForUInt64
+        writer.append(",\"thread_id\":\"");
+        writer.appendUInt64(_sampleThreadIDs[i]);
+        writer.append("\",\"stack_id\":");
+        writer.appendUInt64(_sampleStackIndices[i]);
+        writer.appendChar('}');
+    }
+
+    writer.append("],\"stacks\":[");
+    for (std::uint32_t stackIndex = 0; stackIndex < _stackTable.size(); stackIndex++) {
+        if (stackIndex > 0) {
+            writer.appendChar(',');
+        }
+        writer.appendChar('[');
+        _stackTable.framesOfStack(stackIndex, _frameIndices);
+        for (std::size_t i = 0; i < _frameIndices.size(); i++) {
+            if (i > 0) {
+                writer.appendChar(',');
+            }
+            writer.appendUInt64(_frameIndices[i]);
+        }
+        writer.appendChar(']');
+    }
+
+    writer.append("],\"frames\":[");
+    for (std::uint32_t frameIndex = 0; frameIndex < _frameTable.size(); frameIndex++) {
+        if (frameIndex > 0) {
+            writer.appendChar(',');
+        }
+        const auto address = _frameTable.addressAt(frameIndex);
+        if (address == kTruncatedStackMarkerAddress) {
+            writer.append("{\"function\":");
+            writer.appendString(kTruncatedStackMarkerFunction);
+            writer.appendChar('}');
+            continue;
+        }
+        char hexAddress[SENTRY_HEX_ADDRESS_LENGTH];
+        snprintf(hexAddress, sizeof(hexAddress), "0x%016llx", static_cast<uint64_t>(address));
+        writer.append("{\"instruction_addr\":");
+        writer.appendString(hexAddress);
+#    if defined(DEBUG)
+        NSString *const functionName = symbolicatedFunctionName(address);
+        if (functionName != nil) {
+            writer.append(",\"function\":");
+            writer.appendString(functionName.UTF8String);
+        }
+#    endif // defined(DEBUG)
+        writer.appendChar('}');
+    }
+
+    writer.append("],\"thread_metadata\":{");
+    BOOL firstThread = YES;
+    for (NSString *threadID in _threadMetadata) {
+        if (!firstThread) {
+            writer.appendChar(',');
+        }
+        firstThread = NO;
+        writer.appendString(threadID.UTF8String);
+        writer.append(":{");
+        NSDictionary<NSString *, id> *const metadata = _threadMetadata[threadID];
+        BOOL firstField = YES;
+        for (NSString *key in metadata) {
+            if (!firstField) {
+                writer.appendChar(',');
+            }
+            firstField = NO;
+            writer.appendString(key.UTF8String);
+            writer.appendChar(':');
+            writer.appendValue(metadata[key]);
+        }
+        writer.appendChar('}');
+    }
+    writer.appendChar('}');
+
+    if (_numTruncatedSamples > 0) {
+        writer.append(",\"truncated_samples\":");
+        writer.appendUInt64(_numTruncatedSamples);
+    }
+    writer.appendChar('}');
+}
+
 @end
 
 @implementation SentryProfilerState {
@@ -93,6 +447,15 @@ parseBacktraceSymbolsFunctionName(const char *symbol)
     _mutableState = [[SentryProfilerMutableState alloc] init];
 }
 
+- (SentryProfilerMutableState *)detachMutableState
+{
+    SentryProfilerMutableState *const freshState = [[SentryProfilerMutableState alloc] init];
+    std::lock_guard<std::mutex> l(_lock);
+    SentryProfilerMutableState *const detachedState = _mutableState;
+    _mutableState = freshState;
+    return detachedState;
+}
+
 - (void)cacheMainThreadID
 {
     std::lock_guard<std::mutex> l(_lock);
@@ -125,61 +488,54 @@ parseBacktraceSymbolsFunctionName(const char *symbol)
         if (backtrace.threadMetadata.priority != -1 && metadata[@"priority"] == nil) {
             metadata[@"priority"] = @(backtrace.threadMetadata.priority);
         }
-#    if defined(DEBUG)
-        const auto symbols
-            = backtrace_symbols(reinterpret_cast<void *const *>(backtrace.addresses.data()),
-                static_cast<int>(backtrace.addresses.size()));
-        const auto *backtraceFunctionNames = [NSMutableArray<NSString *> array];
-#    endif // defined(DEBUG)
-
-        const auto stack = [NSMutableArray<NSNumber *> array];
-        for (std::vector<uintptr_t>::size_type backtraceAddressIdx = 0;
-            backtraceAddressIdx < backtrace.addresses.size(); backtraceAddressIdx++) {
-            const auto instructionAddress
-                = sentry_formatHexAddressUInt64(backtrace.addresses[backtraceAddressIdx]);
-            const auto frameIndex = state.frameIndexLookup[instructionAddress];
-            if (frameIndex == nil) {
-                const auto frame = [NSMutableDictionary<NSString *, id> dictionary];
-                frame[@"instruction_addr"] = instructionAddress;
-#    if defined(DEBUG)
-                const auto functionName
-                    = parseBacktraceSymbolsFunctionName(symbols[backtraceAddressIdx]);
-                frame[@"function"] = functionName;
-                [backtraceFunctionNames addObject:functionName];
-#    endif
-                const auto newFrameIndex = @(state.frames.count);
-                [stack addObject:newFrameIndex];
-                state.frameIndexLookup[instructionAddress] = newFrameIndex;
-                [state.frames addObject:frame];
-            } else {
-                [stack addObject:SENTRY_UNWRAP_NULLABLE(NSNumber, frameIndex)];
-            }
-        }
-#    if defined(DEBUG)
-        free(symbols);
-#    endif // defined(DEBUG)
 
-        const auto sample = sentry_profilerSampleWithStack(stack, backtrace.absoluteTimestamp,
-            sentry_getDate().timeIntervalSince1970, backtrace.threadMetadata.threadID, state);
+        BOOL isNewStack = NO;
+        const auto stackIndex = [state internStackWithAddresses:backtrace.addresses
+                                                    isTruncated:backtrace.isTruncated
+                                                     isNewStack:&isNewStack];
+        [state appendSampleWithStackIndex:stackIndex
+                        absoluteTimestamp:backtrace.absoluteTimestamp
+                   absoluteNSDateInterval:dateIntervalOfSample(backtrace.absoluteTimestamp)
+                                 threadID:backtrace.threadMetadata.threadID];
 
 #    if defined(DEBUG)
-        if (backtraceFunctionNames.count > 0) {
+        if (isNewStack && !backtrace.addresses.empty()) {
+            const auto symbols
+                = backtrace_symbols(reinterpret_cast<void *const *>(backtrace.addresses.data()),
+                    static_cast<int>(backtrace.addresses.size()));
+            const auto backtraceFunctionNames = [NSMutableArray<NSString *> array];
+            for (std::vector<uintptr_t>::size_type i = 0; i < backtrace.addresses.size(); i++) {
+                [backtraceFunctionNames addObject:parseBacktraceSymbolsFunctionName(symbols[i])];
+            }
+            free(symbols);
             SENTRY_ASYNC_SAFE_LOG_DEBUG("Recorded backtrace for thread %s at %llu: %s",
-                threadID.UTF8String,
-                [SentryProfileDebugLoggerHelper getAbsoluteTimeStampFromSample:sample],
+                threadID.UTF8String, backtrace.absoluteTimestamp,
                 backtraceFunctionNames.description.UTF8String);
         }
 #    endif // defined(DEBUG)
-
-        [state.samples addObject:sample];
     }];
 }
 
 - (NSDictionary<NSString *, id> *)copyProfilingData
 {
     std::lock_guard<std::mutex> l(_lock);
+    return [self copyProfilingDataWithSamples:[_mutableState.samples copy]];
+}
+
+- (NSDictionary<NSString *, id> *)copyProfilingDataFromSystemTime:(uint64_t)startSystemTime
+                                                     toSystemTime:(uint64_t)endSystemTime
+{
+    std::lock_guard<std::mutex> l(_lock);
+    const auto range = [_mutableState rangeOfSamplesFromSystemTime:startSystemTime
+                                                      toSystemTime:endSystemTime];
+    return [self copyProfilingDataWithSamples:[_mutableState.samples subarrayWithRange:range]];
+}
 
-    NSMutableArray<SentrySample *> *const samples = [_mutableState.samples copy];
+/**
+ * Copies everything but the samples from the mutable state, which the caller must have locked.
+ */
+- (NSDictionary<NSString *, id> *)copyProfilingDataWithSamples:(NSArray<SentrySample *> *)samples
+{
     NSMutableArray<NSArray<NSNumber *> *> *const stacks = [_mutableState.stacks copy];
     NSMutableArray<NSDictionary<NSString *, id> *> *const frames = [_mutableState.frames copy];
 
@@ -189,14 +545,15 @@ parseBacktraceSymbolsFunctionName(const char *symbol)
     [_mutableState.threadMetadata enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key,
         NSDictionary *_Nonnull obj, BOOL *_Nonnull stop) { threadMetadata[key] = [obj copy]; }];
 
-    return @{
-        @"profile" : @ {
-            @"samples" : samples,
-            @"stacks" : stacks,
-            @"frames" : frames,
-            @"thread_metadata" : threadMetadata,
-        }
-    };
+    const auto profile = [NSMutableDictionary<NSString *, id> dictionary];
+    profile[@"samples"] = samples;
+    profile[@"stacks"] = stacks;
+    profile[@"frames"] = frames;
+    profile[@"thread_metadata"] = threadMetadata;
+    if (_mutableState.numTruncatedSamples > 0) {
+        profile[@"truncated_samples"] = @(_mutableState.numTruncatedSamples);
+    }
+    return @{ @"profile" : profile };
 }
 
 @end
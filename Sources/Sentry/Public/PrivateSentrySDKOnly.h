@@ -104,6 +104,23 @@ typedef void (^SentryOnAppStartMeasurementAvailable)(
  * This only needs to be called in case you haven't collected the profile (and don't intend to).
  */
 + (void)discardProfilerForTrace:(SentryId *)traceId;
+
+/**
+ * Histograms and counters describing the overhead of the running continuous profiler's sampling
+ * thread since it started: tick and thread suspension durations, walked stack depths, and the
+ * number of threads skipped or failed per tick. Returns @c nil if no continuous profiler is
+ * running.
+ */
++ (nullable NSDictionary<NSString *, id> *)profilerSamplingTelemetry;
+
+/**
+ * Lowers the sampling rate of profilers started from now on while sampling costs more than
+ * @c cpuBudget of a CPU core, e.g. @c 0.1 for 10%, and skips threads that were idle for more than
+ * @c idleTicksBeforeSkipping ticks until they run again. Both are off by default, as they lower
+ * the resolution of profiles; pass @c 0 to turn them off again.
+ */
++ (void)setProfilerAdaptiveSamplingWithCPUBudget:(double)cpuBudget
+                         idleTicksBeforeSkipping:(uint32_t)idleTicksBeforeSkipping;
 #endif // SENTRY_TARGET_PROFILING_SUPPORTED
 
 @property (class, nullable, nonatomic, copy)
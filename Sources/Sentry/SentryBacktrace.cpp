@@ -5,6 +5,9 @@
 #    include "SentryAsyncSafeLog.h"
 #    include "SentryCompiler.h"
 #    include "SentryMachLogging.hpp"
+#    include "SentrySampleRingBuffer.hpp"
+#    include "SentrySamplingPolicy.hpp"
+#    include "SentrySamplingTelemetry.hpp"
 #    include "SentryStackBounds.hpp"
 #    include "SentryStackFrame.hpp"
 #    include "SentryThreadHandle.hpp"
@@ -17,9 +20,12 @@ extern "C" {
 #    include "SentryCrashMemory.h"
 #    undef restrict
 }
+#    include <algorithm>
 #    include <cassert>
 #    include <cstring>
 #    include <dispatch/dispatch.h>
+#    include <mach/mach.h>
+#    include <time.h>
 
 using namespace sentry::profiling;
 using namespace sentry::profiling::thread;
@@ -31,8 +37,6 @@ isValidFrame(std::uintptr_t frame, const StackBounds &bounds)
     return bounds.contains(frame) && StackFrame::isAligned(frame);
 }
 
-constexpr std::size_t kMaxBacktraceDepth = 128;
-
 } // namespace
 
 namespace sentry {
@@ -40,7 +44,7 @@ namespace profiling {
     NOT_TAIL_CALLED NEVER_INLINE std::size_t
     backtrace(const ThreadHandle &targetThread, const ThreadHandle &callingThread,
         std::uintptr_t *addresses, const StackBounds &bounds, bool *reachedEndOfStackPtr,
-        std::size_t maxDepth, std::size_t skip) noexcept
+        std::size_t maxDepth, std::size_t skip, const StackBounds *readableBounds) noexcept
     {
         assert(addresses != nullptr);
         if (UNLIKELY(maxDepth == 0 || !bounds.isValid())) {
@@ -83,10 +87,12 @@ namespace profiling {
             return 0;
         }
 
+        const auto hasReadableBounds = readableBounds != nullptr && readableBounds->isValid();
         bool reachedEndOfStack = false;
         while (depth < maxDepth) {
             const auto frame = reinterpret_cast<StackFrame *>(current);
-            if (!sentrycrashmem_isMemoryReadable(frame, sizeof(StackFrame))) {
+            if (!(hasReadableBounds && readableBounds->contains(current))
+                && !sentrycrashmem_isMemoryReadable(frame, sizeof(StackFrame))) {
                 break;
             }
             if (LIKELY(skip == 0)) {
@@ -109,37 +115,201 @@ namespace profiling {
         return depth;
     }
 
-    void
-    enumerateBacktracesForAllThreads(
-        const std::function<void(const Backtrace &)> &f, ThreadMetadataCache *cache)
+    StackBounds
+    readableStackBounds(const StackBounds &bounds) noexcept
     {
-        const auto pair = ThreadHandle::allExcludingCurrent();
-        for (const auto &thread : pair.first) {
-            Backtrace bt;
+        StackBounds readableBounds;
+        if (UNLIKELY(!bounds.isValid())) {
+            return readableBounds;
+        }
+        // Regions are looked up in ascending order, so track where the readable run of regions
+        // that is contiguous with the last region began.
+        vm_address_t address = bounds.end;
+        vm_address_t readableRunStart = 0;
+        while (address < bounds.start) {
+            vm_address_t regionAddress = address;
+            vm_size_t regionSize = 0;
+            vm_region_basic_info_data_64_t info;
+            mach_msg_type_number_t count = VM_REGION_BASIC_INFO_COUNT_64;
+            memory_object_name_t object;
+            if (vm_region_64(mach_task_self(), &regionAddress, &regionSize,
+                    VM_REGION_BASIC_INFO_64, (vm_region_info_64_t)&info, &count, &object)
+                    != KERN_SUCCESS
+                || regionAddress >= bounds.start) {
+                // Nothing is mapped between here and the start of the stack.
+                return readableBounds;
+            }
+            const auto isReadable = (info.protection & VM_PROT_READ) != 0;
+            if (regionAddress > address || !isReadable) {
+                readableRunStart = 0;
+            }
+            if (isReadable && readableRunStart == 0) {
+                readableRunStart = regionAddress;
+            }
+            address = regionAddress + regionSize;
+        }
+        if (readableRunStart != 0) {
+            readableBounds.start = bounds.start;
+            readableBounds.end = std::max<std::uintptr_t>(readableRunStart, bounds.end);
+        }
+        return readableBounds;
+    }
+
+    StackCopy::StackCopy(std::size_t capacity)
+        : capacity(capacity - capacity % sizeof(std::uintptr_t))
+        , memory(new std::uintptr_t[capacity / sizeof(std::uintptr_t)])
+    {
+    }
+
+    bool
+    copyStack(
+        const ThreadHandle &targetThread, const StackBounds &bounds, StackCopy *copy) noexcept
+    {
+        assert(copy != nullptr);
+        copy->size = 0;
+        if (UNLIKELY(!bounds.isValid())) {
+            return false;
+        }
+        MachineContext machineContext;
+        if (fillThreadState(targetThread.nativeHandle(), &machineContext) != KERN_SUCCESS) {
+            SENTRY_ASYNC_SAFE_LOG_ERROR("Failed to fill thread state");
+            return false;
+        }
+        copy->programCounter = getProgramCounter(&machineContext);
+        copy->linkRegister = getLinkRegister(&machineContext);
+        copy->framePointer = getFrameAddress(&machineContext);
+
+        const auto stackPointer = getStackPointer(&machineContext);
+        if (UNLIKELY(stackPointer <= bounds.end || stackPointer >= bounds.start)) {
+            return false;
+        }
+        const auto size = std::min<std::size_t>(bounds.start - stackPointer, copy->capacity);
+        // A single copy for the whole window, where walking the stack in place has to check that
+        // each frame is readable.
+        if (!sentrycrashmem_copySafely(reinterpret_cast<const void *>(stackPointer),
+                copy->memory.get(), static_cast<int>(size))) {
+            return false;
+        }
+        copy->base = stackPointer;
+        copy->size = size;
+        return true;
+    }
+
+    std::size_t
+    backtrace(const StackCopy &copy, std::uintptr_t *addresses, const StackBounds &bounds,
+        bool *reachedEndOfStackPtr, bool *reachedEndOfCopyPtr, std::size_t maxDepth) noexcept
+    {
+        assert(addresses != nullptr);
+        if (UNLIKELY(maxDepth == 0 || copy.size == 0)) {
+            return 0;
+        }
+        std::size_t depth = 0;
+        addresses[depth++] = getPreviousInstructionAddress(copy.programCounter);
+        // Mirrors the check in the other overload, so that both collect the same frames.
+        if (LIKELY(depth < maxDepth) && isValidFrame(copy.linkRegister, bounds)) {
+            addresses[depth++] = getPreviousInstructionAddress(copy.linkRegister);
+        }
+        auto current = copy.framePointer;
+        if (UNLIKELY(!isValidFrame(current, bounds))) {
+            return 0;
+        }
+
+        const auto memory = reinterpret_cast<const std::uint8_t *>(copy.memory.get());
+        bool reachedEndOfStack = false;
+        bool reachedEndOfCopy = false;
+        while (depth < maxDepth) {
+            // Frames below the stack pointer mean the frame pointer is inconsistent.
+            if (UNLIKELY(current < copy.base)) {
+                break;
+            }
+            if (current - copy.base + sizeof(StackFrame) > copy.size) {
+                reachedEndOfCopy = true;
+                break;
+            }
+            const auto frame = reinterpret_cast<const StackFrame *>(memory + (current - copy.base));
+            addresses[depth++] = getPreviousInstructionAddress(frame->returnAddress);
+            const auto next = reinterpret_cast<std::uintptr_t>(frame->next);
+            if (next > current && isValidFrame(next, bounds)) {
+                current = next;
+            } else {
+                reachedEndOfStack = true;
+                break;
+            }
+        }
+
+        if (LIKELY(reachedEndOfStackPtr != nullptr)) {
+            *reachedEndOfStackPtr = reachedEndOfStack;
+        }
+        if (LIKELY(reachedEndOfCopyPtr != nullptr)) {
+            *reachedEndOfCopyPtr = reachedEndOfCopy;
+        }
+        return depth;
+    }
+
+    namespace {
+        enum class SampleOutcome {
+            /** The record holds a sample for the thread. */
+            Recorded,
+            /** The thread isn't meant to be sampled, e.g. because it's owned by Sentry. */
+            Skipped,
+            /** The thread's backtrace couldn't be collected, or was truncated and not kept. */
+            Failed,
+        };
+
+        /**
+         * Collects the backtrace of a single thread into @c record. The record's timestamp is
+         * left for the caller to fill in.
+         *
+         * @param isIdle Whether @c thread is idle, in which case its stack isn't walked.
+         * @param maxDepth The number of addresses @c record has room for.
+         * @param keepTruncatedStacks Whether to keep the innermost frames of a stack that is
+         * deeper than @c maxDepth , instead of failing.
+         * @param telemetry If not null, receives the cost and failures of collecting the
+         * backtrace.
+         * @param stackCopy If not null, the stack is copied into it while the thread is suspended
+         * and walked after it was resumed.
+         */
+        SampleOutcome
+        collectSampleRecord(const ThreadHandle &thread, const ThreadHandle &currentThread,
+            ThreadMetadataCache *cache, bool isIdle, std::size_t maxDepth,
+            bool keepTruncatedStacks, SamplingTelemetry *telemetry, StackCopy *stackCopy,
+            SampleRecord *record)
+        {
+            record->threadID = thread.tid();
+            record->isTruncated = false;
 
             // Log an empty stack for an idle thread, we don't need to walk the stack.
-            if (thread->isIdle()) {
-                bt.threadMetadata.threadID = thread->tid();
-                bt.threadMetadata.priority = -1;
-                f(bt);
-                continue;
+            if (isIdle) {
+                record->priority = -1;
+                record->threadName[0] = '\0';
+                record->depth = 0;
+                return SampleOutcome::Recorded;
             }
 
-            auto metadata = cache->metadataForThread(*thread);
+            const auto &metadata = cache->metadataForThread(thread);
             if (metadata.threadID == 0) {
-                continue;
-            } else {
-                bt.threadMetadata = std::move(metadata);
+                return SampleOutcome::Skipped;
             }
+            record->threadID = metadata.threadID;
+            record->priority = metadata.priority;
+            const auto nameLength = std::min(metadata.name.size(), kMaxThreadNameLength);
+            std::memcpy(record->threadName, metadata.name.data(), nameLength);
+            record->threadName[nameLength] = '\0';
 
             // This function calls `pthread_from_mach_thread_np`, which takes a lock,
             // so we must read the value before suspending the thread to avoid risking
             // a deadlock. See the comment below.
-            const auto stackBounds = thread->stackBounds();
+            const auto stackBounds = thread.stackBounds();
+            // Looking up the readable part of the stack once per sample, outside of the
+            // suspension, spares the walk a syscall per frame.
+            StackBounds readableBounds;
+            if (stackCopy == nullptr) {
+                readableBounds = readableStackBounds(stackBounds);
+            }
 
             // ############################################
             // DEADLOCK WARNING: It is not safe to call any functions that acquire a
-            // lock between here and `thread->resume()` -- this may cause a deadlock.
+            // lock between here and `thread.resume()` -- this may cause a deadlock.
             //
             // Heap allocations are unsafe, because `nanov2_malloc` takes an unfair
             // lock.
@@ -154,28 +324,175 @@ namespace profiling {
             // lock by going here and searching for `_pthread_list_lock:
             // https://github.com/apple/darwin-libpthread/blob/master/src/pthread.c
             // ############################################
-            if (!thread->suspend()) {
-                continue;
+            const auto suspendStart = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            if (!thread.suspend()) {
+                if (telemetry != nullptr) {
+                    telemetry->suspendFailures.fetch_add(1, std::memory_order_relaxed);
+                }
+                return SampleOutcome::Failed;
             }
 
             bool reachedEndOfStack = false;
-            std::uintptr_t addresses[kMaxBacktraceDepth];
-            const auto depth = backtrace(*thread, *pair.second, addresses, stackBounds,
-                &reachedEndOfStack, kMaxBacktraceDepth, 0);
+            bool reachedEndOfCopy = false;
+            std::size_t depth = 0;
+            bool copiedStack = false;
+            if (stackCopy != nullptr) {
+                copiedStack = copyStack(thread, stackBounds, stackCopy);
+            } else {
+                depth = backtrace(thread, currentThread, record->addresses, stackBounds,
+                    &reachedEndOfStack, maxDepth, 0, &readableBounds);
+            }
 
-            thread->resume();
+            thread.resume();
 
             // ############################################
             // END DEADLOCK WARNING
             // ############################################
-            // Consider the backtraces only if we're able to collect the full stack
-            if (reachedEndOfStack) {
-                for (std::remove_const<decltype(depth)>::type i = 0; i < depth; i++) {
-                    bt.addresses.push_back(addresses[i]);
+            const auto suspendEnd = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+
+            if (copiedStack) {
+                depth = backtrace(*stackCopy, record->addresses, stackBounds, &reachedEndOfStack,
+                    &reachedEndOfCopy, maxDepth);
+            }
+
+            // A walk that ran out of room, or out of copied stack memory, was truncated; if it
+            // stopped early for any other reason, the frame chain couldn't be followed.
+            const auto isTruncated
+                = !reachedEndOfStack && (depth == maxDepth || reachedEndOfCopy);
+            if (telemetry != nullptr) {
+                telemetry->suspendDurationNs.record(suspendEnd - suspendStart);
+                telemetry->stackDepth.record(depth);
+                if (!reachedEndOfStack) {
+                    auto &counter
+                        = isTruncated ? telemetry->truncatedStacks : telemetry->unwindFailures;
+                    counter.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            // Consider the backtraces only if we're able to collect the full stack, or were asked
+            // to keep the innermost frames of stacks that are too deep.
+            record->depth = static_cast<std::uint32_t>(depth);
+            record->isTruncated = isTruncated;
+            if (reachedEndOfStack || (isTruncated && keepTruncatedStacks)) {
+                return SampleOutcome::Recorded;
+            }
+            return SampleOutcome::Failed;
+        }
+
+        /**
+         * Starts a new generation of @c cache in which all of @c threads are alive, before any of
+         * them is sampled, so that threads skipped in this tick aren't evicted.
+         */
+        void
+        beginCacheGeneration(ThreadMetadataCache *cache, const ThreadSnapshot &threads)
+        {
+            cache->beginGeneration();
+            for (const auto &thread : threads) {
+                cache->markThreadAlive(*thread);
+            }
+        }
+
+        /**
+         * Evicts the threads that have exited from @c cache . This frees memory, so it must only be
+         * called once no thread is suspended anymore.
+         */
+        void
+        endCacheGeneration(ThreadMetadataCache *cache, const ThreadSnapshot &threads)
+        {
+            // An empty list means the threads couldn't be enumerated, not that they all exited.
+            if (!threads.empty()) {
+                cache->evictStaleThreads();
+            }
+        }
+    } // namespace
+
+    void
+    enumerateBacktracesForAllThreads(
+        const std::function<void(const Backtrace &)> &f, ThreadMetadataCache *cache)
+    {
+        ThreadSnapshot threads;
+        ThreadHandle::allExcludingCurrent(&threads);
+        beginCacheGeneration(cache, threads);
+        std::uintptr_t addresses[kMaxBacktraceDepth];
+        SampleRecord record;
+        record.addresses = addresses;
+        for (const auto &thread : threads) {
+            const auto outcome = collectSampleRecord(*thread, threads.current(), cache,
+                thread->isIdle(), kMaxBacktraceDepth, false, nullptr, nullptr, &record);
+            if (outcome != SampleOutcome::Recorded) {
+                continue;
+            }
+            Backtrace bt;
+            bt.threadMetadata.threadID = record.threadID;
+            bt.threadMetadata.priority = record.priority;
+            bt.threadMetadata.name = record.threadName;
+            bt.addresses.assign(record.addresses, record.addresses + record.depth);
+            f(bt);
+        }
+        endCacheGeneration(cache, threads);
+    }
+
+    std::size_t
+    enumerateBacktracesForAllThreads(SampleRingBuffer &buffer, ThreadMetadataCache *cache,
+        std::uint64_t (*getTimestamp)(void), SamplingPolicy *policy, SamplingTelemetry *telemetry,
+        StackCopy *stackCopy, ThreadSnapshot *threads)
+    {
+        std::unique_ptr<ThreadSnapshot> ownedThreads;
+        if (threads == nullptr) {
+            ownedThreads = std::make_unique<ThreadSnapshot>();
+            threads = ownedThreads.get();
+        }
+        ThreadHandle::allExcludingCurrent(threads);
+        beginCacheGeneration(cache, *threads);
+        const auto keepTruncatedStacks = policy != nullptr && policy->keepsTruncatedStacks();
+        std::size_t numRecords = 0;
+        std::size_t numSkipped = 0;
+        std::size_t numFailed = 0;
+        std::size_t numDropped = 0;
+        for (const auto &thread : *threads) {
+            const auto isIdle = thread->isIdle();
+            if (policy != nullptr && !policy->shouldSampleThread(*thread, isIdle)) {
+                numSkipped++;
+                continue;
+            }
+            if (numDropped > 0) {
+                // The drain queue has fallen behind, so the remaining threads would be dropped as
+                // well; there is no point in walking their stacks, but they count as dropped.
+                numDropped++;
+                continue;
+            }
+            const auto record = buffer.reserve();
+            if (record == nullptr) {
+                numDropped++;
+                continue;
+            }
+            const auto outcome = collectSampleRecord(*thread, threads->current(), cache, isIdle,
+                buffer.maxDepth(), keepTruncatedStacks, telemetry, stackCopy, record);
+            if (outcome != SampleOutcome::Recorded) {
+                if (outcome == SampleOutcome::Skipped) {
+                    numSkipped++;
+                } else {
+                    numFailed++;
                 }
-                f(bt);
+                continue;
             }
+            record->absoluteTimestamp = getTimestamp();
+            buffer.commit();
+            numRecords++;
+        }
+        if (numDropped > 1) {
+            // The failed reservation already counted the first one.
+            buffer.addDropped(numDropped - 1);
+        }
+        endCacheGeneration(cache, *threads);
+        // Release the thread ports right away, as the threads may exit before the next tick.
+        threads->clear();
+        if (telemetry != nullptr) {
+            telemetry->sampledThreadsPerTick.record(numRecords);
+            telemetry->skippedThreadsPerTick.record(numSkipped);
+            telemetry->failedThreadsPerTick.record(numFailed);
         }
+        return numRecords;
     }
 
 } // namespace profiling
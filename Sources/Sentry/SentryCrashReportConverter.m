@@ -21,12 +21,61 @@
 static NSString *const SentryCrashReportConverterErrorDomain
     = @"io.sentry.SentryCrashReportConverter";
 
+/** The address range of the binary image at @c index of the report's binary images. */
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+    NSUInteger index;
+    /** The largest end of this range and all ranges sorted before it. */
+    uintptr_t maxEnd;
+} SentryBinaryImageRange;
+
+static int
+compareBinaryImageRanges(const void *a, const void *b)
+{
+    const SentryBinaryImageRange *lhs = a;
+    const SentryBinaryImageRange *rhs = b;
+    if (lhs->start != rhs->start) {
+        return lhs->start < rhs->start ? -1 : 1;
+    }
+    if (lhs->index != rhs->index) {
+        return lhs->index < rhs->index ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @return The position of the last range in @c ranges starting at or below @c address, or
+ * @c NSNotFound if all ranges start above it.
+ */
+static NSUInteger
+lastBinaryImageRangeStartingAtOrBelow(
+    const SentryBinaryImageRange *ranges, NSUInteger count, uintptr_t address)
+{
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger mid = low + (high - low) / 2;
+        if (ranges[mid].start <= address) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low == 0 ? NSNotFound : low - 1;
+}
+
 @interface SentryCrashReportConverter ()
 
 @property (nonatomic, strong) NSDictionary *report;
 @property (nonatomic, assign) NSInteger crashedThreadIndex;
 @property (nonatomic, strong) NSDictionary *exceptionContext;
 @property (nonatomic, strong) NSArray *binaryImages;
+/**
+ * The ranges of @c binaryImages sorted by start address, so frames can be resolved with a binary
+ * search instead of parsing every image for every frame.
+ */
+@property (nonatomic, strong) NSData *binaryImageRanges;
 @property (nonatomic, strong) NSArray *threads;
 @property (nonatomic, strong) NSDictionary *systemContext;
 @property (nonatomic, strong) NSDictionary *applicationStats;
@@ -75,6 +124,7 @@ static NSString *const SentryCrashReportConverterErrorDomain
         } else {
             self.binaryImages = report[@"binary_images"];
         }
+        [self initBinaryImageRanges];
 
         self.diagnosis = crashContext[@"diagnosis"];
         self.exceptionContext = crashContext[@"error"];
@@ -88,6 +138,40 @@ static NSString *const SentryCrashReportConverterErrorDomain
     return self;
 }
 
+- (void)initBinaryImageRanges
+{
+    if (![self.binaryImages isKindOfClass:[NSArray class]] || self.binaryImages.count == 0) {
+        self.binaryImageRanges = [NSData data];
+        return;
+    }
+
+    NSMutableData *data = [NSMutableData
+        dataWithLength:self.binaryImages.count * sizeof(SentryBinaryImageRange)];
+    SentryBinaryImageRange *ranges = data.mutableBytes;
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < self.binaryImages.count; i++) {
+        NSDictionary *binaryImage = self.binaryImages[i];
+        if (![binaryImage isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        uintptr_t imageStart = (uintptr_t)[binaryImage[@"image_addr"] unsignedLongLongValue];
+        uintptr_t imageSize = (uintptr_t)[binaryImage[@"image_size"] unsignedLongLongValue];
+        ranges[count].start = imageStart;
+        ranges[count].end
+            = imageSize > UINTPTR_MAX - imageStart ? UINTPTR_MAX : imageStart + imageSize;
+        ranges[count].index = i;
+        count++;
+    }
+    qsort(ranges, count, sizeof(SentryBinaryImageRange), compareBinaryImageRanges);
+    uintptr_t maxEnd = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        maxEnd = MAX(maxEnd, ranges[i].end);
+        ranges[i].maxEnd = maxEnd;
+    }
+    data.length = count * sizeof(SentryBinaryImageRange);
+    self.binaryImageRanges = data;
+}
+
 - (void)initThreads:(NSArray<NSDictionary *> *)threads
 {
     if (nil != threads && [threads isKindOfClass:[NSArray class]]) {
@@ -252,17 +336,27 @@ static NSString *const SentryCrashReportConverterErrorDomain
 
 - (NSDictionary *)binaryImageForAddress:(uintptr_t)address
 {
-    NSDictionary *result = nil;
-    for (NSDictionary *binaryImage in self.binaryImages) {
-        uintptr_t imageStart = (uintptr_t)[binaryImage[@"image_addr"] unsignedLongLongValue];
-        uintptr_t imageEnd
-            = imageStart + (uintptr_t)[binaryImage[@"image_size"] unsignedLongLongValue];
-        if (address >= imageStart && address < imageEnd) {
-            result = binaryImage;
-            break;
+    const SentryBinaryImageRange *ranges = self.binaryImageRanges.bytes;
+    NSUInteger count = self.binaryImageRanges.length / sizeof(SentryBinaryImageRange);
+    NSUInteger position = lastBinaryImageRangeStartingAtOrBelow(ranges, count, address);
+    if (position == NSNotFound) {
+        return nil;
+    }
+    // Usually only the closest image starting at or below the address can contain it, but an
+    // image can also be nested in an earlier, larger one. Walk back until no earlier range reaches
+    // the address, and pick the containing image that comes first in the report, like a linear
+    // search would.
+    NSUInteger match = NSNotFound;
+    for (NSUInteger i = position + 1; i-- > 0 && ranges[i].maxEnd > address;) {
+        if (address < ranges[i].end
+            && (match == NSNotFound || ranges[i].index < ranges[match].index)) {
+            match = i;
         }
     }
-    return result;
+    if (match == NSNotFound) {
+        return nil;
+    }
+    return self.binaryImages[ranges[match].index];
 }
 
 /**
@@ -399,14 +493,27 @@ static NSString *const SentryCrashReportConverterErrorDomain
         }
     }
 
-    NSMutableArray<SentryDebugMeta *> *result = [[NSMutableArray alloc] init];
-
-    for (NSDictionary *sourceImage in self.binaryImages) {
-        if ([imageNames containsObject:sentry_formatHexAddress(sourceImage[@"image_addr"])]) {
-            [result addObject:[self debugMetaFromBinaryImageDictionary:sourceImage]];
+    // Frames reference their image by its start address, so look the images up in the ranges by
+    // start instead of formatting the address of every image of the report.
+    const SentryBinaryImageRange *ranges = self.binaryImageRanges.bytes;
+    NSUInteger count = self.binaryImageRanges.length / sizeof(SentryBinaryImageRange);
+    NSMutableIndexSet *imageIndexes = [[NSMutableIndexSet alloc] init];
+    for (NSString *imageName in imageNames) {
+        uintptr_t imageStart = (uintptr_t)strtoull(imageName.UTF8String, NULL, 16);
+        NSUInteger position = lastBinaryImageRangeStartingAtOrBelow(ranges, count, imageStart);
+        // Several images may have the same start address, e.g. when an image was loaded twice.
+        while (position != NSNotFound && ranges[position].start == imageStart) {
+            [imageIndexes addIndex:ranges[position].index];
+            position = position == 0 ? NSNotFound : position - 1;
         }
     }
 
+    NSMutableArray<SentryDebugMeta *> *result =
+        [[NSMutableArray alloc] initWithCapacity:imageIndexes.count];
+    [imageIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        [result addObject:[self debugMetaFromBinaryImageDictionary:self.binaryImages[index]]];
+    }];
+
     return result;
 }
 
@@ -2,13 +2,243 @@
 
 #    import "SentrySwift.h"
 #    import <SentryBreadcrumb.h>
-#    import <SentryCrashJSONCodec.h>
-#    import <SentryCrashJSONCodecObjC.h>
+#    import <SentryCrashDate.h>
 #    import <SentryCrashScopeObserver.h>
 #    import <SentryLogC.h>
-#    import <SentryNSDataUtils.h>
 #    import <SentryScopeSyncC.h>
 #    import <SentryUser.h>
+#    import <math.h>
+
+/** The longest a double formatted with %lg can get, for example -1.79769e+308. */
+static const size_t kMaxFloatingPointJSONLength = 13;
+
+static size_t
+getDecimalLength(int64_t value)
+{
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    size_t length = value < 0 ? 2 : 1;
+    for (; magnitude >= 10; magnitude /= 10) {
+        length++;
+    }
+    return length;
+}
+
+/**
+ * Gets the length of a string as escaped by SentryCrashJSONCodec, without the quotes.
+ *
+ * @return NO if the string contains a character JSON can't encode.
+ */
+static BOOL
+getEscapedLength(const char *bytes, size_t length, size_t *escapedLength)
+{
+    *escapedLength = length;
+    for (size_t i = 0; i < length; i++) {
+        switch (bytes[i]) {
+        case '\\':
+        case '\"':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            (*escapedLength)++;
+            break;
+        default:
+            if ((unsigned char)bytes[i] < ' ') {
+                return NO;
+            }
+        }
+    }
+    return YES;
+}
+
+static void
+appendType(NSMutableData *record, SentryCrashScopeRecordType type)
+{
+    const uint8_t byte = (uint8_t)type;
+    [record appendBytes:&byte length:sizeof(byte)];
+}
+
+static BOOL
+appendElementHeader(NSMutableData *record, SentryCrashScopeRecordType type, const char *name,
+    BOOL isInObject, size_t *jsonLength)
+{
+    appendType(record, type);
+    if (name == NULL) {
+        name = "";
+    }
+    const size_t nameLength = strlen(name);
+    if (isInObject) {
+        size_t escapedLength;
+        if (!getEscapedLength(name, nameLength, &escapedLength)) {
+            SENTRY_LOG_ERROR(@"Invalid character in %s", name);
+            return NO;
+        }
+        // The quotes and the colon.
+        *jsonLength += escapedLength + 3;
+    }
+    [record appendBytes:name length:nameLength + 1];
+    return YES;
+}
+
+static BOOL
+appendStringElement(NSMutableData *record, SentryCrashScopeRecordType type, const void *bytes,
+    size_t length, const char *name, BOOL isInObject, size_t *jsonLength)
+{
+    if (length > UINT32_MAX) {
+        SENTRY_LOG_ERROR(@"String of %zu bytes is too long", length);
+        return NO;
+    }
+    if (!appendElementHeader(record, type, name, isInObject, jsonLength)) {
+        return NO;
+    }
+    const uint32_t length32 = (uint32_t)length;
+    [record appendBytes:&length32 length:sizeof(length32)];
+    [record appendBytes:bytes length:length];
+    return YES;
+}
+
+/**
+ * Appends the elements of a binary scope record that encode the object the same way as
+ * SentryCrashJSONCodec with SentryCrashJSONEncodeOptionSorted, see SentryCrashScopeRecordType.
+ *
+ * @param jsonLength Incremented by the length of the object as JSON, or an upper bound of it.
+ *
+ * @return NO if the object can't be encoded as JSON.
+ */
+static BOOL
+appendRecordElement(
+    NSMutableData *record, id object, const char *name, BOOL isInObject, size_t *jsonLength)
+{
+    if ([object isKindOfClass:[NSString class]]) {
+        NSData *data = [object dataUsingEncoding:NSUTF8StringEncoding];
+        size_t escapedLength;
+        if (!getEscapedLength(data.bytes, data.length, &escapedLength)) {
+            SENTRY_LOG_ERROR(@"Invalid character in %@", object);
+            return NO;
+        }
+        *jsonLength += escapedLength + 2;
+        return appendStringElement(record, SentryCrashScopeRecordString, data.bytes, data.length,
+            name, isInObject, jsonLength);
+    }
+
+    if ([object isKindOfClass:[NSNumber class]]) {
+        switch (CFNumberGetType((__bridge CFNumberRef)object)) {
+        case kCFNumberFloat32Type:
+        case kCFNumberFloat64Type:
+        case kCFNumberFloatType:
+        case kCFNumberCGFloatType:
+        case kCFNumberDoubleType: {
+            const double value = [object doubleValue];
+            if (!appendElementHeader(
+                    record, SentryCrashScopeRecordFloatingPoint, name, isInObject, jsonLength)) {
+                return NO;
+            }
+            [record appendBytes:&value length:sizeof(value)];
+            *jsonLength += isnan(value) ? 4 : kMaxFloatingPointJSONLength;
+            return YES;
+        }
+        case kCFNumberCharType: {
+            const uint8_t value = [object boolValue] ? 1 : 0;
+            if (!appendElementHeader(
+                    record, SentryCrashScopeRecordBoolean, name, isInObject, jsonLength)) {
+                return NO;
+            }
+            [record appendBytes:&value length:sizeof(value)];
+            *jsonLength += value ? 4 : 5;
+            return YES;
+        }
+        default: {
+            const int64_t value = [object longLongValue];
+            if (!appendElementHeader(
+                    record, SentryCrashScopeRecordInteger, name, isInObject, jsonLength)) {
+                return NO;
+            }
+            [record appendBytes:&value length:sizeof(value)];
+            *jsonLength += getDecimalLength(value);
+            return YES;
+        }
+        }
+    }
+
+    if ([object isKindOfClass:[NSArray class]]) {
+        NSArray *array = (NSArray *)object;
+        if (!appendElementHeader(
+                record, SentryCrashScopeRecordBeginArray, name, isInObject, jsonLength)) {
+            return NO;
+        }
+        // The brackets and the commas between the elements.
+        *jsonLength += 2 + (array.count > 0 ? array.count - 1 : 0);
+        for (id element in array) {
+            if (!appendRecordElement(record, element, NULL, NO, jsonLength)) {
+                return NO;
+            }
+        }
+        appendType(record, SentryCrashScopeRecordEndContainer);
+        return YES;
+    }
+
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dict = (NSDictionary *)object;
+        if (!appendElementHeader(
+                record, SentryCrashScopeRecordBeginObject, name, isInObject, jsonLength)) {
+            return NO;
+        }
+        // The braces and the commas between the members.
+        *jsonLength += 2 + (dict.count > 0 ? dict.count - 1 : 0);
+        NSArray *keys = [dict allKeys];
+
+        BOOL allKeysOfSameType = YES;
+        for (NSUInteger i = 1; i < keys.count; i++) {
+            if ([keys[i - 1] class] != [keys[i] class]) {
+                allKeysOfSameType = NO;
+            }
+        }
+
+        // Like SentryCrashJSONCodec, only sort the keys if all of them are of the same type,
+        // because sorting an array with different types can crash.
+        if (allKeysOfSameType) {
+            keys = [keys sortedArrayUsingSelector:@selector(compare:)];
+        }
+
+        for (id key in keys) {
+            // It is not guaranteed that a key is NSString.
+            if (!appendRecordElement(
+                    record, dict[key], [[key description] UTF8String], YES, jsonLength)) {
+                return NO;
+            }
+        }
+        appendType(record, SentryCrashScopeRecordEndContainer);
+        return YES;
+    }
+
+    if ([object isKindOfClass:[NSNull class]]) {
+        *jsonLength += 4;
+        return appendElementHeader(
+            record, SentryCrashScopeRecordNull, name, isInObject, jsonLength);
+    }
+
+    if ([object isKindOfClass:[NSDate class]]) {
+        char string[21];
+        time_t timestamp = (time_t)((NSDate *)object).timeIntervalSince1970;
+        sentrycrashdate_utcStringFromTimestamp(timestamp, string);
+        const size_t length = strnlen(string, 20);
+        *jsonLength += length + 2;
+        return appendStringElement(record, SentryCrashScopeRecordString, string, length, name,
+            isInObject, jsonLength);
+    }
+
+    if ([object isKindOfClass:[NSData class]]) {
+        NSData *data = (NSData *)object;
+        // Data is written as a quoted hex string.
+        *jsonLength += data.length * 2 + 2;
+        return appendStringElement(record, SentryCrashScopeRecordData, data.bytes, data.length,
+            name, isInObject, jsonLength);
+    }
+
+    SENTRY_LOG_ERROR(@"Could not determine type of %@", [object class]);
+    return NO;
+}
 
 @implementation SentryCrashScopeObserver
 
@@ -25,45 +255,59 @@
 {
     [self syncScope:user
         serialize:^{ return [user serialize]; }
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setUser(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setUserRecord(record);
+        }];
 }
 
 - (void)setDist:(nullable NSString *)dist
 {
     [self syncScope:dist
         serialize:^{ return dist; }
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setDist(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setDistRecord(record);
+        }];
 }
 
 - (void)setEnvironment:(nullable NSString *)environment
 {
     [self syncScope:environment
         serialize:^{ return environment; }
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setEnvironment(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setEnvironmentRecord(record);
+        }];
 }
 
 - (void)setContext:(nullable NSDictionary<NSString *, id> *)context
 {
     [self syncScope:context
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setContext(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setContextRecord(record);
+        }];
 }
 
 - (void)setTraceContext:(nullable NSDictionary<NSString *, id> *)traceContext
 {
     [self syncScope:traceContext
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setTraceContext(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setTraceContextRecord(record);
+        }];
 }
 
 - (void)setExtras:(nullable NSDictionary<NSString *, id> *)extras
 {
     [self syncScope:extras
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setExtras(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setExtrasRecord(record);
+        }];
 }
 
 - (void)setTags:(nullable NSDictionary<NSString *, NSString *> *)tags
 {
     [self syncScope:tags
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setTags(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setTagsRecord(record);
+        }];
 }
 
 - (void)setFingerprint:(nullable NSArray<NSString *> *)fingerprint
@@ -76,20 +320,23 @@
             }
             return result;
         }
-        syncToSentryCrash:^(const void *bytes) { sentrycrash_scopesync_setFingerprint(bytes); }];
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setFingerprintRecord(record);
+        }];
 }
 
 - (void)setLevel:(enum SentryLevel)level
 {
     if (level == kSentryLevelNone) {
-        sentrycrash_scopesync_setLevel(NULL);
+        sentrycrash_scopesync_setLevelRecord(NULL);
         return;
     }
 
     NSString *levelAsString = [SentryLevelHelper nameForLevel:level];
-    NSData *json = [self toJSONEncodedCString:levelAsString];
-
-    sentrycrash_scopesync_setLevel([json bytes]);
+    [self syncRecordOf:levelAsString
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_setLevelRecord(record);
+        }];
 }
 
 - (void)setAttributes:(nullable NSDictionary<NSString *, id> *)attributes
@@ -99,12 +346,10 @@
 
 - (void)addSerializedBreadcrumb:(NSDictionary *)crumb
 {
-    NSData *json = [self toJSONEncodedCString:crumb];
-    if (json == nil) {
-        return;
-    }
-
-    sentrycrash_scopesync_addBreadcrumb([json bytes]);
+    [self syncRecordOf:crumb
+        syncToSentryCrash:^(const SentryCrashScopeRecord *record) {
+            sentrycrash_scopesync_addBreadcrumbRecord(record);
+        }];
 }
 
 - (void)clearBreadcrumbs
@@ -117,7 +362,8 @@
     sentrycrash_scopesync_clear();
 }
 
-- (void)syncScope:(NSDictionary *)dict syncToSentryCrash:(void (^)(const void *))syncToSentryCrash
+- (void)syncScope:(NSDictionary *)dict
+    syncToSentryCrash:(void (^)(const SentryCrashScopeRecord *))syncToSentryCrash
 {
     [self syncScope:dict
                 serialize:^{
@@ -132,7 +378,7 @@
 
 - (void)syncScope:(id)object
             serialize:(nullable id (^)(void))serialize
-    syncToSentryCrash:(void (^)(const void *))syncToSentryCrash
+    syncToSentryCrash:(void (^)(const SentryCrashScopeRecord *))syncToSentryCrash
 {
     if (object == nil) {
         syncToSentryCrash(NULL);
@@ -145,30 +391,25 @@
         return;
     }
 
-    NSData *jsonEncodedCString = [self toJSONEncodedCString:serialized];
-    if (jsonEncodedCString == nil) {
-        return;
-    }
-
-    syncToSentryCrash([jsonEncodedCString bytes]);
+    [self syncRecordOf:serialized syncToSentryCrash:syncToSentryCrash];
 }
 
-- (nullable NSData *)toJSONEncodedCString:(id)toSerialize
+/**
+ * Encodes the object as a binary scope record, which the crash handler only writes as JSON when
+ * it writes a report. Leaves the scope as it is if the object can't be encoded as JSON.
+ */
+- (void)syncRecordOf:(id)object
+    syncToSentryCrash:(void (^)(const SentryCrashScopeRecord *))syncToSentryCrash
 {
-    NSError *error = nil;
-    NSData *json = nil;
-    if (toSerialize != nil) {
-        json = [SentryCrashJSONCodec encode:toSerialize
-                                    options:SentryCrashJSONEncodeOptionSorted
-                                      error:&error];
-        if (error != nil) {
-            SENTRY_LOG_ERROR(@"Could not serialize %@", error);
-            return nil;
-        }
+    NSMutableData *bytes = [NSMutableData dataWithCapacity:256];
+    size_t jsonLength = 0;
+    if (!appendRecordElement(bytes, object, NULL, NO, &jsonLength)) {
+        return;
     }
 
-    // C strings need to be null terminated
-    return sentry_nullTerminated(json);
+    SentryCrashScopeRecord record
+        = { .bytes = bytes.bytes, .size = bytes.length, .jsonLength = jsonLength };
+    syncToSentryCrash(&record);
 }
 
 @end
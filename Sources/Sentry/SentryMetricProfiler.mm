@@ -5,22 +5,16 @@
 #    import "SentryEvent+Private.h"
 #    import "SentryFormatter.h"
 #    import "SentryLogC.h"
+#    import "SentryMetricTimeSeries.hpp"
 #    import "SentrySwift.h"
 #    import "SentrySystemWrapper.h"
 #    import "SentryTime.h"
 #    import "SentryTransaction.h"
 
-/**
- * A storage class for metric readings, with one property for the reading value itself, whether it
- * be bytes of memory, % CPU etc, and another for the absolute system time it was recorded at.
- */
-@interface SentryMetricReading : NSObject
-@property (strong, nonatomic) NSNumber *value;
-@property (assign, nonatomic) uint64_t absoluteSystemTimestamp;
-@property (assign, nonatomic) NSTimeInterval absoluteNSDateInterval;
-@end
-@implementation SentryMetricReading
-@end
+#    import <memory>
+#    import <vector>
+
+using namespace sentry::profiling;
 
 NSString *const kSentryMetricProfilerSerializationKeyMemoryFootprint = @"memory_footprint";
 NSString *const kSentryMetricProfilerSerializationKeyCPUUsage = @"cpu_usage";
@@ -36,39 +30,72 @@ NSString *const kSentryMetricProfilerSerializationUnitNanoJoules = @"nanojoule";
 // backtrace profiler's resolution.
 static NSInteger frequencyHz = 10;
 
+/**
+ * The number of readings kept per metric: more than a minute's worth at @c frequencyHz , so that a
+ * continuous profile chunk can still be serialized after the next one started recording.
+ */
+static const std::size_t kMetricReadingsCapacity = 1024;
+
+namespace {
+
+/**
+ * A metric the profiler records, along with the key and unit it is serialized with. The
+ * serialization functions handle every channel the same way, so adding a metric only requires
+ * adding a channel and recording its readings.
+ */
+struct MetricChannel {
+    NSString *key;
+    NSString *unit;
+    /** Whether readings are whole numbers, like byte counts, rather than fractions. */
+    bool isIntegral;
+    std::shared_ptr<MetricTimeSeries> series;
+};
+
+/** The readings a channel had when a snapshot was taken. */
+struct MetricChannelSnapshot {
+    MetricChannel channel;
+    MetricTimeSeries::Range range;
+};
+
+NSNumber *
+numberForReading(const MetricChannel &channel, const MetricReading &reading)
+{
+    if (channel.isIntegral) {
+        return @(static_cast<unsigned long long>(reading.value));
+    }
+    return @(reading.value);
+}
+
 /**
  * @return a dictionary containing all the metric values recorded during the transaction, or @c nil
  * if there were no metrics recorded during the transaction.
  */
 SentrySerializedMetricEntry *_Nullable serializeTraceProfileMetricValuesWithNormalizedTime(
-    NSArray<SentryMetricReading *> *absoluteTimestampValues, NSString *unit,
-    uint64_t startSystemTime, uint64_t endSystemTime)
+    const MetricChannel &channel, uint64_t startSystemTime, uint64_t endSystemTime)
 {
     NSMutableArray<SentrySerializedMetricReading *> *timestampNormalizedValues =
         [NSMutableArray<SentrySerializedMetricReading *> array];
-    [absoluteTimestampValues enumerateObjectsUsingBlock:^(
-        SentryMetricReading *_Nonnull reading, NSUInteger idx, BOOL *_Nonnull stop) {
+    channel.series->forEach(channel.series->readableRange(), [&](const MetricReading &reading) {
         // if the metric reading wasn't recorded until the transaction ended, don't include it
-        if (!orderedChronologically(reading.absoluteSystemTimestamp, endSystemTime)) {
+        if (!orderedChronologically(reading.systemTime, endSystemTime)) {
             return;
         }
 
         // if the metric reading was taken before the transaction started, don't include it
-        if (!orderedChronologically(startSystemTime, reading.absoluteSystemTimestamp)) {
+        if (!orderedChronologically(startSystemTime, reading.systemTime)) {
             return;
         }
 
         NSMutableDictionary *value = [NSMutableDictionary dictionary];
-        uint64_t relativeTimestamp
-            = getDurationNs(startSystemTime, reading.absoluteSystemTimestamp);
+        uint64_t relativeTimestamp = getDurationNs(startSystemTime, reading.systemTime);
         value[@"elapsed_since_start_ns"] = sentry_stringForUInt64(relativeTimestamp);
-        value[@"value"] = reading.value;
+        value[@"value"] = numberForReading(channel, reading);
         [timestampNormalizedValues addObject:value];
-    }];
+    });
     if (timestampNormalizedValues.count == 0) {
         return nil;
     }
-    return @ { @"unit" : unit, @"values" : timestampNormalizedValues };
+    return @ { @"unit" : channel.unit, @"values" : timestampNormalizedValues };
 }
 
 /**
@@ -76,49 +103,39 @@ SentrySerializedMetricEntry *_Nullable serializeTraceProfileMetricValuesWithNorm
  * absolute timestamps, or @c nil if there were no metrics recorded
  */
 SentrySerializedMetricEntry *_Nullable serializeContinuousProfileMetricReadings(
-    NSArray<SentryMetricReading *> *readings, NSString *unit)
+    const MetricChannelSnapshot &snapshot)
 {
-    if (readings.count == 0) {
-        return nil;
-    }
     NSMutableArray<SentrySerializedMetricReading *> *serializedValues =
         [NSMutableArray<SentrySerializedMetricReading *> array];
-    [readings enumerateObjectsUsingBlock:^(
-        SentryMetricReading *_Nonnull reading, NSUInteger idx, BOOL *_Nonnull stop) {
+    const auto &channel = snapshot.channel;
+    channel.series->forEach(snapshot.range, [&](const MetricReading &reading) {
         NSMutableDictionary *value = [NSMutableDictionary dictionary];
-        value[@"timestamp"] = @(reading.absoluteNSDateInterval);
-        value[@"value"] = reading.value;
+        value[@"timestamp"] = @(reading.dateInterval);
+        value[@"value"] = numberForReading(channel, reading);
         [serializedValues addObject:value];
-    }];
-    return @ { @"unit" : unit, @"values" : serializedValues };
+    });
+    if (serializedValues.count == 0) {
+        return nil;
+    }
+    return @ { @"unit" : channel.unit, @"values" : serializedValues };
+}
+
+} // namespace
+
+@implementation SentryMetricProfilerSnapshot {
+@public
+    std::vector<MetricChannelSnapshot> _channels;
 }
+@end
 
 NSDictionary<NSString *, id> *
-serializeContinuousProfileMetrics(NSDictionary *state)
+serializeContinuousProfileMetrics(SentryMetricProfilerSnapshot *snapshot)
 {
     NSMutableDictionary<NSString *, id> *dict = [NSMutableDictionary<NSString *, id> dictionary];
-    NSArray<SentryMetricReading *> *memoryFootprint
-        = state[kSentryMetricProfilerSerializationKeyMemoryFootprint];
-    if (memoryFootprint.count > 0) {
-        dict[kSentryMetricProfilerSerializationKeyMemoryFootprint]
-            = serializeContinuousProfileMetricReadings(
-                memoryFootprint, kSentryMetricProfilerSerializationUnitBytes);
-    }
-    NSArray<SentryMetricReading *> *cpuEnergyUsage
-        = state[kSentryMetricProfilerSerializationKeyCPUEnergyUsage];
-    if (cpuEnergyUsage.count > 0) {
-        dict[kSentryMetricProfilerSerializationKeyCPUEnergyUsage]
-            = serializeContinuousProfileMetricReadings(
-                cpuEnergyUsage, kSentryMetricProfilerSerializationUnitNanoJoules);
+    for (const auto &channelSnapshot : snapshot->_channels) {
+        dict[channelSnapshot.channel.key]
+            = serializeContinuousProfileMetricReadings(channelSnapshot);
     }
-
-    NSArray<SentryMetricReading *> *cpuUsage = state[kSentryMetricProfilerSerializationKeyCPUUsage];
-    if (cpuUsage.count > 0) {
-        dict[kSentryMetricProfilerSerializationKeyCPUUsage]
-            = serializeContinuousProfileMetricReadings(
-                cpuUsage, kSentryMetricProfilerSerializationUnitPercentage);
-    }
-
     return dict;
 }
 
@@ -135,11 +152,13 @@ static SentrySystemWrapper *_systemWrapperOverride = nil;
 @implementation SentryMetricProfiler {
     SentryDispatchSourceWrapper *_dispatchSource;
 
-    NSMutableArray<SentryMetricReading *> *_cpuUsage;
-    NSMutableArray<SentryMetricReading *> *_memoryFootprint;
+    /** Set up once in the initializer; the readings are recorded without taking a lock. */
+    std::vector<MetricChannel> _channels;
+    std::size_t _cpuUsageChannel;
+    std::size_t _memoryFootprintChannel;
+    std::size_t _cpuEnergyUsageChannel;
 
     NSNumber *previousEnergyReading;
-    NSMutableArray<SentryMetricReading *> *_cpuEnergyUsage;
 
     SentryProfilerMode _mode;
 }
@@ -147,8 +166,17 @@ static SentrySystemWrapper *_systemWrapperOverride = nil;
 - (instancetype)initWithMode:(SentryProfilerMode)mode
 {
     if (self = [super init]) {
-        // It doesn't make sense to acquire a lock in the init.
-        [self clearNotThreadSafe];
+        _memoryFootprintChannel =
+            [self addChannelWithKey:kSentryMetricProfilerSerializationKeyMemoryFootprint
+                               unit:kSentryMetricProfilerSerializationUnitBytes
+                         isIntegral:YES];
+        _cpuEnergyUsageChannel =
+            [self addChannelWithKey:kSentryMetricProfilerSerializationKeyCPUEnergyUsage
+                               unit:kSentryMetricProfilerSerializationUnitNanoJoules
+                         isIntegral:YES];
+        _cpuUsageChannel = [self addChannelWithKey:kSentryMetricProfilerSerializationKeyCPUUsage
+                                              unit:kSentryMetricProfilerSerializationUnitPercentage
+                                        isIntegral:NO];
 #    if SENTRY_TEST || SENTRY_TEST_CI
         self.systemWrapper = _systemWrapperOverride
             ? _systemWrapperOverride
@@ -202,63 +230,44 @@ static SentrySystemWrapper *_systemWrapperOverride = nil;
     serializeTraceProfileMetricsBetween:(uint64_t)startSystemTime
                                     and:(uint64_t)endSystemTime;
 {
-    NSArray<SentryMetricReading *> *memoryFootprint;
-    NSArray<SentryMetricReading *> *cpuEnergyUsage;
-    NSArray<SentryMetricReading *> *cpuUsage;
-    @synchronized(self) {
-        cpuEnergyUsage = [NSArray<SentryMetricReading *> arrayWithArray:_cpuEnergyUsage];
-        memoryFootprint = [NSArray<SentryMetricReading *> arrayWithArray:_memoryFootprint];
-        cpuUsage = [NSArray<SentryMetricReading *> arrayWithArray:_cpuUsage];
-    }
-
     NSMutableDictionary<NSString *, id> *dict = [NSMutableDictionary<NSString *, id> dictionary];
-    if (memoryFootprint.count > 0) {
-        dict[kSentryMetricProfilerSerializationKeyMemoryFootprint]
-            = serializeTraceProfileMetricValuesWithNormalizedTime(memoryFootprint,
-                kSentryMetricProfilerSerializationUnitBytes, startSystemTime, endSystemTime);
-    }
-    if (cpuEnergyUsage.count > 0) {
-        dict[kSentryMetricProfilerSerializationKeyCPUEnergyUsage]
-            = serializeTraceProfileMetricValuesWithNormalizedTime(cpuEnergyUsage,
-                kSentryMetricProfilerSerializationUnitNanoJoules, startSystemTime, endSystemTime);
-    }
-
-    if (cpuUsage.count > 0) {
-        dict[kSentryMetricProfilerSerializationKeyCPUUsage]
-            = serializeTraceProfileMetricValuesWithNormalizedTime(cpuUsage,
-                kSentryMetricProfilerSerializationUnitPercentage, startSystemTime, endSystemTime);
+    for (const auto &channel : _channels) {
+        dict[channel.key] = serializeTraceProfileMetricValuesWithNormalizedTime(
+            channel, startSystemTime, endSystemTime);
     }
-
     return dict;
 }
 
-- (NSDictionary<NSString *, NSArray<SentryMetricReading *> *> *)copyMetricProfilerData
+- (SentryMetricProfilerSnapshot *)snapshotMetricProfilerData
 {
-    NSMutableDictionary *copy = [NSMutableDictionary dictionary];
-    @synchronized(self) {
-        copy[kSentryMetricProfilerSerializationKeyMemoryFootprint] = [_memoryFootprint copy];
-        copy[kSentryMetricProfilerSerializationKeyCPUUsage] = [_cpuUsage copy];
-        copy[kSentryMetricProfilerSerializationKeyCPUEnergyUsage] = [_cpuEnergyUsage copy];
+    SentryMetricProfilerSnapshot *snapshot = [[SentryMetricProfilerSnapshot alloc] init];
+    snapshot->_channels.reserve(_channels.size());
+    for (const auto &channel : _channels) {
+        snapshot->_channels.push_back({ channel, channel.series->readableRange() });
     }
-    return copy;
+    return snapshot;
 }
 
 - (void)clear
 {
-    @synchronized(self) {
-        [self clearNotThreadSafe];
+    for (const auto &channel : _channels) {
+        channel.series->clear();
     }
 }
 
-- (void)clearNotThreadSafe
+#    pragma mark - Private
+
+/**
+ * Adds a metric to record and serialize.
+ * @return The index of the channel to record the metric's readings to.
+ */
+- (std::size_t)addChannelWithKey:(NSString *)key unit:(NSString *)unit isIntegral:(BOOL)isIntegral
 {
-    _cpuUsage = [NSMutableArray<SentryMetricReading *> array];
-    _memoryFootprint = [NSMutableArray<SentryMetricReading *> array];
-    _cpuEnergyUsage = [NSMutableArray<SentryMetricReading *> array];
+    _channels.push_back({ key, unit, isIntegral == YES,
+        std::make_shared<MetricTimeSeries>(kMetricReadingsCapacity) });
+    return _channels.size() - 1;
 }
 
-#    pragma mark - Private
-
 - (void)registerSampler
 {
     __weak typeof(self) weakSelf = self;
@@ -283,9 +292,7 @@ static SentrySystemWrapper *_systemWrapperOverride = nil;
         return;
     }
 
-    @synchronized(self) {
-        [_memoryFootprint addObject:[self metricReadingForValue:@(footprintBytes)]];
-    }
+    [self recordValue:static_cast<double>(footprintBytes) toChannel:_memoryFootprintChannel];
 }
 
 - (void)recordCPUsage
@@ -302,9 +309,7 @@ static SentrySystemWrapper *_systemWrapperOverride = nil;
         return;
     }
 
-    @synchronized(self) {
-        [_cpuUsage addObject:[self metricReadingForValue:result]];
-    }
+    [self recordValue:result.doubleValue toChannel:_cpuUsageChannel];
 }
 
 // Only some architectures support reading energy.
@@ -326,21 +331,16 @@ static SentrySystemWrapper *_systemWrapperOverride = nil;
     NSUInteger value = reading.unsignedIntegerValue - previousEnergyReading.unsignedIntegerValue;
     previousEnergyReading = reading;
 
-    @synchronized(self) {
-        [_cpuEnergyUsage addObject:[self metricReadingForValue:@(value)]];
-    }
+    [self recordValue:static_cast<double>(value) toChannel:_cpuEnergyUsageChannel];
 }
 #    endif
 
-- (SentryMetricReading *)metricReadingForValue:(NSNumber *)value
+- (void)recordValue:(double)value toChannel:(std::size_t)channelIndex
 {
-    SentryMetricReading *reading = [[SentryMetricReading alloc] init];
-    reading.value = value;
     id<SentryCurrentDateProvider> dateProvider
         = SentryDependencyContainer.sharedInstance.dateProvider;
-    reading.absoluteSystemTimestamp = dateProvider.systemTime;
-    reading.absoluteNSDateInterval = dateProvider.date.timeIntervalSince1970;
-    return reading;
+    _channels[channelIndex].series->record(
+        dateProvider.systemTime, dateProvider.date.timeIntervalSince1970, value);
 }
 
 @end
@@ -0,0 +1,121 @@
+#include "SentryMetricTimeSeries.hpp"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include <algorithm>
+#    include <cstring>
+
+namespace {
+
+std::size_t
+roundUpToPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+std::uint64_t
+bitsOfDouble(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double
+doubleFromBits(std::uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+namespace sentry {
+namespace profiling {
+
+    MetricTimeSeries::MetricTimeSeries(std::size_t capacity)
+        : slots_(new Slot[roundUpToPowerOfTwo(capacity == 0 ? 1 : capacity)])
+        , mask_(roundUpToPowerOfTwo(capacity == 0 ? 1 : capacity) - 1)
+        , next_(0)
+        , start_(0)
+    {
+        for (std::size_t i = 0; i <= mask_; i++) {
+            slots_[i].sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void
+    MetricTimeSeries::record(std::uint64_t systemTime, double dateInterval, double value) noexcept
+    {
+        const auto index = next_.fetch_add(1, std::memory_order_relaxed);
+        auto &slot = slots_[index & mask_];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        // Readers must see the odd sequence number before any of the new fields.
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.systemTime.store(systemTime, std::memory_order_relaxed);
+        slot.dateIntervalBits.store(bitsOfDouble(dateInterval), std::memory_order_relaxed);
+        slot.valueBits.store(bitsOfDouble(value), std::memory_order_relaxed);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    MetricTimeSeries::Range
+    MetricTimeSeries::readableRange() const noexcept
+    {
+        const auto end = next_.load(std::memory_order_acquire);
+        const auto oldest = end > mask_ ? end - mask_ - 1 : 0;
+        return { std::max(start_.load(std::memory_order_relaxed), oldest), end };
+    }
+
+    std::size_t
+    MetricTimeSeries::forEach(
+        const Range &range, const std::function<void(const MetricReading &)> &f) const
+    {
+        std::size_t numRead = 0;
+        MetricReading reading;
+        for (auto index = range.begin; index < range.end; index++) {
+            if (read(index, &reading)) {
+                f(reading);
+                numRead++;
+            }
+        }
+        return numRead;
+    }
+
+    void
+    MetricTimeSeries::clear() noexcept
+    {
+        start_.store(next_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    std::size_t
+    MetricTimeSeries::capacity() const noexcept
+    {
+        return mask_ + 1;
+    }
+
+    bool
+    MetricTimeSeries::read(std::uint64_t index, MetricReading *reading) const noexcept
+    {
+        const auto &slot = slots_[index & mask_];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2) {
+            return false;
+        }
+        reading->systemTime = slot.systemTime.load(std::memory_order_relaxed);
+        reading->dateInterval
+            = doubleFromBits(slot.dateIntervalBits.load(std::memory_order_relaxed));
+        reading->value = doubleFromBits(slot.valueBits.load(std::memory_order_relaxed));
+        // The fields must be read before checking that the slot wasn't overwritten meanwhile.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == sequence;
+    }
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
@@ -0,0 +1,179 @@
+#include "SentryProfileInterningTables.hpp"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include <utility>
+
+namespace {
+
+constexpr std::size_t kInitialCapacity = 256;
+
+/** The splitmix64 finalizer, which spreads out the nearby values of addresses and indices. */
+inline std::uint64_t
+mix(std::uint64_t key)
+{
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+inline std::uint64_t
+pack(std::uint32_t high, std::uint32_t low)
+{
+    return (static_cast<std::uint64_t>(high) << 32) | low;
+}
+
+} // namespace
+
+namespace sentry {
+namespace profiling {
+
+    constexpr std::uint32_t IntegerIndexMap::kNotFound;
+
+    std::uint32_t
+    IntegerIndexMap::find(std::uint64_t key) const noexcept
+    {
+        if (slots_.empty()) {
+            return kNotFound;
+        }
+        const auto mask = slots_.size() - 1;
+        for (auto i = mix(key) & mask;; i = (i + 1) & mask) {
+            const auto &slot = slots_[i];
+            if (slot.value == kNotFound) {
+                return kNotFound;
+            }
+            if (slot.key == key) {
+                return slot.value;
+            }
+        }
+    }
+
+    std::uint32_t
+    IntegerIndexMap::findOrInsert(std::uint64_t key, std::uint32_t value)
+    {
+        // Keep the load factor below 3/4 so probe sequences stay short.
+        if ((size_ + 1) * 4 > slots_.size() * 3) {
+            grow();
+        }
+        const auto mask = slots_.size() - 1;
+        for (auto i = mix(key) & mask;; i = (i + 1) & mask) {
+            auto &slot = slots_[i];
+            if (slot.value == kNotFound) {
+                slot.key = key;
+                slot.value = value;
+                size_++;
+                return kNotFound;
+            }
+            if (slot.key == key) {
+                return slot.value;
+            }
+        }
+    }
+
+    std::size_t
+    IntegerIndexMap::size() const noexcept
+    {
+        return size_;
+    }
+
+    void
+    IntegerIndexMap::grow()
+    {
+        const auto capacity = slots_.empty() ? kInitialCapacity : slots_.size() * 2;
+        const auto oldSlots = std::move(slots_);
+        slots_.assign(capacity, Slot { 0, kNotFound });
+        const auto mask = slots_.size() - 1;
+        for (const auto &slot : oldSlots) {
+            if (slot.value == kNotFound) {
+                continue;
+            }
+            auto i = mix(slot.key) & mask;
+            while (slots_[i].value != kNotFound) {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = slot;
+        }
+    }
+
+    std::uint32_t
+    FrameTable::intern(std::uintptr_t address)
+    {
+        const auto newIndex = static_cast<std::uint32_t>(addresses_.size());
+        const auto existingIndex = index_.findOrInsert(address, newIndex);
+        if (existingIndex != IntegerIndexMap::kNotFound) {
+            return existingIndex;
+        }
+        addresses_.push_back(address);
+        return newIndex;
+    }
+
+    std::size_t
+    FrameTable::size() const noexcept
+    {
+        return addresses_.size();
+    }
+
+    std::uintptr_t
+    FrameTable::addressAt(std::uint32_t index) const noexcept
+    {
+        return addresses_[index];
+    }
+
+    std::uint32_t
+    StackTable::intern(const std::uint32_t *frameIndices, std::size_t count)
+    {
+        const auto newIndex = static_cast<std::uint32_t>(stackLeaves_.size());
+        if (count == 0) {
+            if (emptyStackIndex_ == IntegerIndexMap::kNotFound) {
+                emptyStackIndex_ = newIndex;
+                stackLeaves_.push_back(IntegerIndexMap::kNotFound);
+            }
+            return emptyStackIndex_;
+        }
+
+        // Walk down the trie from the outermost frame, adding nodes for any suffix of the stack
+        // that hasn't been seen yet.
+        auto node = IntegerIndexMap::kNotFound;
+        for (auto i = count; i > 0; i--) {
+            const auto frameIndex = frameIndices[i - 1];
+            const auto newNode = static_cast<std::uint32_t>(nodes_.size());
+            const auto existingNode = children_.findOrInsert(pack(node, frameIndex), newNode);
+            if (existingNode != IntegerIndexMap::kNotFound) {
+                node = existingNode;
+            } else {
+                nodes_.push_back({ node, frameIndex });
+                node = newNode;
+            }
+        }
+
+        const auto existingIndex = stackIndices_.findOrInsert(node, newIndex);
+        if (existingIndex != IntegerIndexMap::kNotFound) {
+            return existingIndex;
+        }
+        stackLeaves_.push_back(node);
+        return newIndex;
+    }
+
+    std::size_t
+    StackTable::size() const noexcept
+    {
+        return stackLeaves_.size();
+    }
+
+    void
+    StackTable::framesOfStack(std::uint32_t index, std::vector<std::uint32_t> &frameIndices) const
+    {
+        frameIndices.clear();
+        for (auto node = stackLeaves_[index]; node != IntegerIndexMap::kNotFound;
+            node = nodes_[node].parent) {
+            frameIndices.push_back(nodes_[node].frameIndex);
+        }
+    }
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
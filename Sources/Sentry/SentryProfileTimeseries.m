@@ -44,6 +44,29 @@ _sentry_logSlicingFailureWithArray(
         firstSampleRelativeToTransactionStart, lastSampleRelativeToTransactionStart);
 }
 
+/**
+ * Binary search for the index of the first of @c samples , which must be sorted by timestamp, that
+ * was taken after @c systemTime , or at it if @c inclusive is @c YES .
+ * @return The index, or the number of samples if no sample was taken after @c systemTime .
+ */
+NSUInteger
+_sentry_indexOfFirstSampleAfter(
+    NSArray<SentrySample *> *samples, uint64_t systemTime, BOOL inclusive)
+{
+    NSUInteger low = 0;
+    NSUInteger high = samples.count;
+    while (low < high) {
+        const NSUInteger middle = low + (high - low) / 2;
+        const uint64_t timestamp = samples[middle].absoluteTimestamp;
+        if (timestamp < systemTime || (!inclusive && timestamp == systemTime)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
 NSArray<SentrySample *> *_Nullable sentry_slicedProfileSamples(
     NSArray<SentrySample *> *samples, uint64_t startSystemTime, uint64_t endSystemTime)
 {
@@ -53,37 +76,28 @@ NSArray<SentrySample *> *_Nullable sentry_slicedProfileSamples(
 
     SENTRY_LOG_DEBUG(@"Finding relevant samples from %lu total.", (unsigned long)samples.count);
 
-    NSUInteger firstIndex = [samples indexOfObjectPassingTest:^BOOL(
-        SentrySample *_Nonnull sample, NSUInteger idx, BOOL *_Nonnull stop) {
-        *stop = sample.absoluteTimestamp >= startSystemTime;
-        return *stop;
-    }];
-
-    if (firstIndex == NSNotFound) {
+    const NSUInteger firstIndex
+        = _sentry_indexOfFirstSampleAfter(samples, startSystemTime, /*inclusive*/ YES);
+    if (firstIndex == samples.count) {
         _sentry_logSlicingFailureWithArray(samples, startSystemTime, endSystemTime, /*start*/ YES);
         return nil;
     } else {
         SENTRY_LOG_DEBUG(@"Found first slice sample at index %lu", firstIndex);
     }
 
-    NSUInteger lastIndex =
-        [samples indexOfObjectWithOptions:NSEnumerationReverse
-                              passingTest:^BOOL(SentrySample *_Nonnull sample, NSUInteger idx,
-                                  BOOL *_Nonnull stop) {
-                                  *stop = sample.absoluteTimestamp <= endSystemTime;
-                                  return *stop;
-                              }];
-
-    if (lastIndex == NSNotFound) {
+    const NSUInteger endIndex
+        = _sentry_indexOfFirstSampleAfter(samples, endSystemTime, /*inclusive*/ NO);
+    if (endIndex == 0) {
         _sentry_logSlicingFailureWithArray(samples, startSystemTime, endSystemTime, /*start*/ NO);
         return nil;
     } else {
-        SENTRY_LOG_DEBUG(@"Found last slice sample at index %lu", lastIndex);
+        SENTRY_LOG_DEBUG(@"Found last slice sample at index %lu", endIndex - 1);
     }
 
-    NSRange range = NSMakeRange(firstIndex, (lastIndex - firstIndex) + 1);
-    NSIndexSet *indices = [NSIndexSet indexSetWithIndexesInRange:range];
-    return [samples objectsAtIndexes:indices];
+    if (endIndex <= firstIndex) {
+        return @[];
+    }
+    return [samples subarrayWithRange:NSMakeRange(firstIndex, endIndex - firstIndex)];
 }
 
 #    if SENTRY_HAS_UIKIT
@@ -19,6 +19,8 @@
 #    import "SentryTime.h"
 #    import "SentryTracer+Private.h"
 
+#    import <atomic>
+
 #    if SENTRY_HAS_UIKIT
 #        import <UIKit/UIKit.h>
 #    endif // SENTRY_HAS_UIKIT
@@ -35,6 +37,34 @@ namespace {
 
 static const int kSentryProfilerFrequencyHz = 101;
 
+static const int kSentryProfilerMinFrequencyHz = 25;
+
+/**
+ * The share of a CPU core the sampling thread may use before the sampling rate is lowered, which
+ * mostly matters for apps with many threads, since every running thread is suspended and walked on
+ * every tick. @c 0 , the default, always samples at @c kSentryProfilerFrequencyHz .
+ */
+std::atomic<double> sentry_profilerCPUBudget { 0 };
+
+/**
+ * The number of ticks a thread can be idle before it is no longer sampled until it runs again.
+ * @c 0 , the default, samples idle threads on every tick.
+ */
+std::atomic<std::uint32_t> sentry_profilerIdleTicksBeforeSkipping { 0 };
+
+/**
+ * Deep stacks, e.g. from recursive layout passes, are recorded with their innermost frames up to
+ * this depth and a marker for the omitted rest, rather than being dropped from the profile.
+ */
+static const std::size_t kSentryProfilerMaxStackDepth = 128;
+
+/**
+ * The sampled threads' stacks are copied up to this size while they are suspended and walked after
+ * they were resumed, which keeps the time each thread, most importantly the main thread, is frozen
+ * short.
+ */
+static const std::size_t kSentryProfilerMaxStackCopySize = 64 * 1024;
+
 NSObject *
 sentry_profileConfigurationLock()
 {
@@ -62,6 +92,13 @@ sentry_setProfileConfiguration(SentryProfileConfiguration *_Nullable configurati
     }
 }
 
+void
+sentry_setProfilerAdaptiveSampling(double cpuBudget, uint32_t idleTicksBeforeSkipping)
+{
+    sentry_profilerCPUBudget = cpuBudget;
+    sentry_profilerIdleTicksBeforeSkipping = idleTicksBeforeSkipping;
+}
+
 void
 sentry_reevaluateSessionSampleRate()
 {
@@ -87,8 +124,53 @@ sentry_isLaunchProfileCorrelatedToTraces(void)
     return sentry_profileAppStarts(options) && sentry_isTraceLifecycle(options);
 }
 
+namespace {
+
+NSDictionary<NSString *, id> *
+sentry_serializedHistogram(const Histogram::Snapshot &histogram)
+{
+    const auto buckets = [NSMutableArray<NSDictionary<NSString *, NSNumber *> *> array];
+    for (std::size_t i = 0; i < Histogram::kNumBuckets; i++) {
+        if (histogram.buckets[i] == 0) {
+            continue;
+        }
+        [buckets addObject:@{
+            @"upper_bound" : @(Histogram::bucketUpperBound(i)),
+            @"count" : @(histogram.buckets[i]),
+        }];
+    }
+    return @{
+        @"count" : @(histogram.count),
+        @"sum" : @(histogram.sum),
+        @"max" : @(histogram.max),
+        @"buckets" : buckets,
+    };
+}
+
+NSDictionary<NSString *, id> *
+sentry_serializedSamplingTelemetry(
+    const SamplingTelemetry::Snapshot &telemetry, std::uint64_t droppedSamples)
+{
+    return @{
+        @"tick_duration_ns" : sentry_serializedHistogram(telemetry.tickDurationNs),
+        @"suspend_duration_ns" : sentry_serializedHistogram(telemetry.suspendDurationNs),
+        @"stack_depth" : sentry_serializedHistogram(telemetry.stackDepth),
+        @"sampled_threads_per_tick" : sentry_serializedHistogram(telemetry.sampledThreadsPerTick),
+        @"skipped_threads_per_tick" : sentry_serializedHistogram(telemetry.skippedThreadsPerTick),
+        @"failed_threads_per_tick" : sentry_serializedHistogram(telemetry.failedThreadsPerTick),
+        @"suspend_failures" : @(telemetry.suspendFailures),
+        @"unwind_failures" : @(telemetry.unwindFailures),
+        @"truncated_stacks" : @(telemetry.truncatedStacks),
+        @"dropped_samples" : @(droppedSamples),
+    };
+}
+
+} // namespace
+
 @implementation SentryProfiler {
     std::unique_ptr<SamplingProfiler> _samplingProfiler;
+    SamplingTelemetry::Snapshot _lastChunkTelemetry;
+    std::uint64_t _lastChunkDroppedSamples;
 }
 
 + (void)load
@@ -211,18 +293,58 @@ sentry_isLaunchProfileCorrelatedToTraces(void)
 
     SentryProfilerState *const state = [[SentryProfilerState alloc] init];
     self.state = state;
+    SamplingPolicyOptions policyOptions;
+    policyOptions.cpuBudget = sentry_profilerCPUBudget.load();
+    policyOptions.minSamplingRateHz = kSentryProfilerMinFrequencyHz;
+    policyOptions.idleTicksBeforeSkipping = sentry_profilerIdleTicksBeforeSkipping.load();
+    policyOptions.maxStackDepth = kSentryProfilerMaxStackDepth;
+    policyOptions.keepTruncatedStacks = true;
+    policyOptions.maxStackCopySize = kSentryProfilerMaxStackCopySize;
     _samplingProfiler = std::make_unique<SamplingProfiler>(
         [state](auto &backtrace) {
-            Backtrace backtraceCopy = backtrace;
-            backtraceCopy.absoluteTimestamp = sentry_getSystemTime();
             @autoreleasepool {
-                [state appendBacktrace:backtraceCopy];
+                [state appendBacktrace:backtrace];
             }
         },
-        kSentryProfilerFrequencyHz);
+        kSentryProfilerFrequencyHz, sentry_getSystemTime, std::move(policyOptions));
     _samplingProfiler->startSampling();
 }
 
+- (void)drainPendingSamples
+{
+    if (_samplingProfiler != nullptr) {
+        _samplingProfiler->drainPendingSamples();
+    }
+}
+
+- (nullable NSDictionary<NSString *, id> *)serializedSamplingTelemetry
+{
+    if (_samplingProfiler == nullptr) {
+        return nil;
+    }
+    NSMutableDictionary<NSString *, id> *const telemetry =
+        [sentry_serializedSamplingTelemetry(
+            _samplingProfiler->telemetry(), _samplingProfiler->numDroppedSamples()) mutableCopy];
+    telemetry[@"sampling_rate_hz"] = @(_samplingProfiler->samplingRateHz());
+    return telemetry;
+}
+
+- (nullable NSDictionary<NSString *, id> *)serializedSamplingTelemetrySinceLastChunk
+{
+    if (_samplingProfiler == nullptr) {
+        return nil;
+    }
+    const auto telemetry = _samplingProfiler->telemetry();
+    const auto droppedSamples = _samplingProfiler->numDroppedSamples();
+    NSMutableDictionary<NSString *, id> *const serialized =
+        [sentry_serializedSamplingTelemetry(telemetry.since(_lastChunkTelemetry),
+            droppedSamples - _lastChunkDroppedSamples) mutableCopy];
+    serialized[@"sampling_rate_hz"] = @(_samplingProfiler->samplingRateHz());
+    _lastChunkTelemetry = telemetry;
+    _lastChunkDroppedSamples = droppedSamples;
+    return serialized;
+}
+
 - (BOOL)isRunning
 {
     if (_samplingProfiler == nullptr) {
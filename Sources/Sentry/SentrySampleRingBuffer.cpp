@@ -0,0 +1,98 @@
+#include "SentrySampleRingBuffer.hpp"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+namespace {
+
+std::size_t
+roundUpToPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+namespace sentry {
+namespace profiling {
+
+    SampleRingBuffer::SampleRingBuffer(std::size_t capacity, std::size_t maxDepth)
+        : records_(new SampleRecord[roundUpToPowerOfTwo(capacity == 0 ? 1 : capacity)])
+        , mask_(roundUpToPowerOfTwo(capacity == 0 ? 1 : capacity) - 1)
+        , maxDepth_(maxDepth == 0 ? 1 : maxDepth)
+        , head_(0)
+        , tail_(0)
+        , numDropped_(0)
+    {
+        // Allocate the addresses of all records at once, rather than one array per record.
+        addresses_.reset(new std::uintptr_t[(mask_ + 1) * maxDepth_]);
+        for (std::size_t i = 0; i <= mask_; i++) {
+            records_[i].addresses = &addresses_[i * maxDepth_];
+        }
+    }
+
+    SampleRecord *
+    SampleRingBuffer::reserve() noexcept
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        if (head - tail > mask_) {
+            numDropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &records_[head & mask_];
+    }
+
+    void
+    SampleRingBuffer::commit() noexcept
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void
+    SampleRingBuffer::addDropped(std::uint64_t count) noexcept
+    {
+        numDropped_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    const SampleRecord *
+    SampleRingBuffer::peek() const noexcept
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &records_[tail & mask_];
+    }
+
+    void
+    SampleRingBuffer::pop() noexcept
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    std::size_t
+    SampleRingBuffer::capacity() const noexcept
+    {
+        return mask_ + 1;
+    }
+
+    std::size_t
+    SampleRingBuffer::maxDepth() const noexcept
+    {
+        return maxDepth_;
+    }
+
+    std::uint64_t
+    SampleRingBuffer::numDropped() const noexcept
+    {
+        return numDropped_.load(std::memory_order_relaxed);
+    }
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
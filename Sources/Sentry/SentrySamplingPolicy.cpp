@@ -0,0 +1,145 @@
+#include "SentrySamplingPolicy.hpp"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include <algorithm>
+#    include <utility>
+
+namespace {
+
+/**
+ * The number of ticks to wait after changing the sampling rate before changing it again, so that
+ * the average tick cost reflects the new rate and a single slow tick can't cause oscillation.
+ */
+constexpr std::uint64_t kTicksBetweenRateChanges = 16;
+
+/** Weight of the latest tick in the moving average of the tick cost. */
+constexpr double kTickCostSmoothing = 0.125;
+
+std::uint64_t
+intervalNsForRate(std::uint32_t samplingRateHz)
+{
+    return 1000000000ULL / std::max<std::uint32_t>(samplingRateHz, 1);
+}
+
+} // namespace
+
+namespace sentry {
+namespace profiling {
+
+    SamplingPolicy::SamplingPolicy(std::uint32_t samplingRateHz, SamplingPolicyOptions options)
+        : initialSamplingRateHz_(std::max<std::uint32_t>(samplingRateHz, 1))
+        , options_(std::move(options))
+        , samplingRateHz_(initialSamplingRateHz_)
+        , intervalNs_(intervalNsForRate(initialSamplingRateHz_))
+        , averageTickCostNs_(0)
+        , tick_(0)
+        , lastRateChangeTick_(0)
+    {
+    }
+
+    void
+    SamplingPolicy::reset() noexcept
+    {
+        setSamplingRateHz(initialSamplingRateHz_);
+        averageTickCostNs_ = 0;
+        tick_ = 0;
+        lastRateChangeTick_ = 0;
+        idleThreads_.clear();
+    }
+
+    void
+    SamplingPolicy::beginTick() noexcept
+    {
+        tick_++;
+    }
+
+    bool
+    SamplingPolicy::shouldSampleThread(const ThreadHandle &thread, bool isIdle)
+    {
+        if (options_.idleTicksBeforeSkipping == 0) {
+            return true;
+        }
+        auto &state = idleThreads_[thread.nativeHandle()];
+        state.lastSeenTick = tick_;
+        if (!isIdle) {
+            state.idleTicks = 0;
+            return true;
+        }
+        if (state.idleTicks < options_.idleTicksBeforeSkipping) {
+            state.idleTicks++;
+            return true;
+        }
+        return false;
+    }
+
+    bool
+    SamplingPolicy::endTick(std::uint64_t tickCostNs) noexcept
+    {
+        // Drop the idle state of threads that have exited so that the map doesn't keep growing in
+        // apps that churn through threads.
+        for (auto it = idleThreads_.begin(); it != idleThreads_.end();) {
+            if (it->second.lastSeenTick != tick_) {
+                it = idleThreads_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (options_.cpuBudget <= 0) {
+            return false;
+        }
+        averageTickCostNs_ = averageTickCostNs_ == 0
+            ? tickCostNs
+            : averageTickCostNs_ + kTickCostSmoothing * (tickCostNs - averageTickCostNs_);
+        if (tick_ - lastRateChangeTick_ < kTicksBetweenRateChanges) {
+            return false;
+        }
+
+        const auto load = averageTickCostNs_ / intervalNs_;
+        const auto rate = samplingRateHz_.load(std::memory_order_relaxed);
+        auto newRate = rate;
+        if (load > options_.cpuBudget) {
+            newRate = std::max(rate / 2, std::min(options_.minSamplingRateHz, rate));
+        } else if (load < options_.cpuBudget / 4) {
+            // Doubling the rate doubles the load, so only speed up again when that still leaves
+            // plenty of headroom.
+            newRate = std::min(rate * 2, initialSamplingRateHz_);
+        }
+        if (newRate == rate) {
+            return false;
+        }
+        setSamplingRateHz(newRate);
+        lastRateChangeTick_ = tick_;
+        return true;
+    }
+
+    std::uint64_t
+    SamplingPolicy::intervalNs() const noexcept
+    {
+        return intervalNs_;
+    }
+
+    std::uint32_t
+    SamplingPolicy::samplingRateHz() const noexcept
+    {
+        return samplingRateHz_.load(std::memory_order_relaxed);
+    }
+
+    bool
+    SamplingPolicy::keepsTruncatedStacks() const noexcept
+    {
+        return options_.keepTruncatedStacks;
+    }
+
+    void
+    SamplingPolicy::setSamplingRateHz(std::uint32_t samplingRateHz) noexcept
+    {
+        samplingRateHz_.store(samplingRateHz, std::memory_order_relaxed);
+        intervalNs_ = intervalNsForRate(samplingRateHz);
+    }
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
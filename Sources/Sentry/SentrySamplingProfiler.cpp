@@ -5,28 +5,88 @@
 #    include "SentryAsyncSafeLog.h"
 #    include "SentryBacktrace.hpp"
 #    include "SentryMachLogging.hpp"
+#    include "SentrySampleRingBuffer.hpp"
+#    include "SentrySamplingTelemetry.hpp"
+#    include "SentryThreadHandle.hpp"
 #    include "SentryThreadMetadataCache.hpp"
 
-#    include <chrono>
+#    include <algorithm>
+#    include <dispatch/dispatch.h>
 #    include <mach/clock.h>
 #    include <mach/clock_reply.h>
 #    include <mach/clock_types.h>
 #    include <malloc/_malloc.h>
 #    include <pthread.h>
+#    include <time.h>
 
 namespace sentry {
 namespace profiling {
     namespace {
+        /**
+         * How long the drain queue can be kept from running before samples are dropped. The sample
+         * buffer is sized to hold every thread's samples for this long.
+         */
+        constexpr std::uint64_t kSampleBufferLatencyMs = 250;
+
+        /** Bounds for the sample buffer, each record of which takes about 1 KB. */
+        constexpr std::size_t kMinSampleBufferCapacity = 512;
+        constexpr std::size_t kMaxSampleBufferCapacity = 4096;
+
+        /** Enough thread handles for most apps, so that the first ticks don't have to allocate. */
+        constexpr std::size_t kThreadSnapshotCapacity = 64;
+
         struct SamplingThreadParams {
             mach_port_t port;
             clock_serv_t clock;
             mach_timespec_t delaySpec;
             ThreadMetadataCache *cache;
-            std::function<void(const Backtrace &)> callback;
+            SampleRingBuffer *buffer;
+            SamplingPolicy *policy;
+            SamplingTelemetry *telemetry;
+            StackCopy *stackCopy;
+            ThreadSnapshot *threads;
+            dispatch_source_t drainSource;
+            std::uint64_t (*getTimestamp)(void);
             std::atomic_uint64_t &numSamples;
             std::function<void()> onThreadStart;
         };
 
+        /** @return The number of threads of the current task, or 0 if it couldn't be read. */
+        std::size_t
+        currentThreadCount(void)
+        {
+            thread_act_array_t threads;
+            mach_msg_type_number_t count = 0;
+            if (SENTRY_ASYNC_SAFE_LOG_KERN_RETURN(task_threads(mach_task_self(), &threads, &count))
+                != KERN_SUCCESS) {
+                return 0;
+            }
+            for (mach_msg_type_number_t i = 0; i < count; i++) {
+                mach_port_deallocate(mach_task_self(), threads[i]);
+            }
+            vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(threads),
+                sizeof(*threads) * count);
+            return count;
+        }
+
+        std::uint64_t
+        getUptimeTimestamp(void)
+        {
+            return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+        }
+
+        mach_timespec_t
+        delaySpecForInterval(std::uint64_t intervalNs)
+        {
+            return { .tv_sec = static_cast<unsigned int>(intervalNs / 1000000000ULL),
+                .tv_nsec = static_cast<clock_res_t>(intervalNs % 1000000000ULL) };
+        }
+
+        void
+        noop(__unused void *context)
+        {
+        }
+
         void
         freeReplyBuf(void *reply)
         {
@@ -65,7 +125,23 @@ namespace profiling {
                 }
 
                 params->numSamples.fetch_add(1, std::memory_order_relaxed);
-                enumerateBacktracesForAllThreads(params->callback, params->cache);
+                params->policy->beginTick();
+                const auto tickStart = clock_gettime_nsec_np(CLOCK_THREAD_CPUTIME_ID);
+                const auto tickStartUptime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+                if (enumerateBacktracesForAllThreads(*params->buffer, params->cache,
+                        params->getTimestamp, params->policy, params->telemetry,
+                        params->stackCopy, params->threads)
+                    > 0) {
+                    dispatch_source_merge_data(params->drainSource, 1);
+                }
+                params->telemetry->tickDurationNs.record(
+                    clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - tickStartUptime);
+                // The alarm for the next tick is already set, so a new interval takes effect on
+                // the one after it.
+                if (params->policy->endTick(
+                        clock_gettime_nsec_np(CLOCK_THREAD_CPUTIME_ID) - tickStart)) {
+                    params->delaySpec = delaySpecForInterval(params->policy->intervalNs());
+                }
             }
             pthread_cleanup_pop(1);
             pthread_cleanup_pop(1);
@@ -74,10 +150,57 @@ namespace profiling {
 
     } // namespace
 
-    SamplingProfiler::SamplingProfiler(
-        std::function<void(const Backtrace &)> callback, std::uint32_t samplingRateHz)
-        : callback_(std::move(callback))
-        , cache_(std::make_unique<ThreadMetadataCache>())
+    struct SamplingProfiler::DrainContext {
+        std::function<void(const Backtrace &)> callback;
+        SampleRingBuffer *buffer;
+        dispatch_queue_t queue;
+        dispatch_source_t source;
+        /** Reused for every record so its address storage only grows, instead of reallocating. */
+        Backtrace backtrace;
+    };
+
+    void
+    SamplingProfiler::drainSamples(void *context)
+    {
+        const auto drainContext = reinterpret_cast<DrainContext *>(context);
+        auto &backtrace = drainContext->backtrace;
+        while (const auto record = drainContext->buffer->peek()) {
+            backtrace.threadMetadata.threadID = record->threadID;
+            backtrace.threadMetadata.priority = record->priority;
+            backtrace.threadMetadata.name.assign(record->threadName);
+            backtrace.absoluteTimestamp = record->absoluteTimestamp;
+            backtrace.addresses.assign(record->addresses, record->addresses + record->depth);
+            backtrace.isTruncated = record->isTruncated;
+            drainContext->buffer->pop();
+            drainContext->callback(backtrace);
+        }
+    }
+
+    std::size_t
+    SamplingProfiler::sampleBufferCapacity(
+        std::size_t threadCount, std::uint32_t samplingRateHz) noexcept
+    {
+        const auto ticks = std::max<std::size_t>(1,
+            static_cast<std::size_t>(samplingRateHz * kSampleBufferLatencyMs / 1000));
+        const auto capacity = std::max(threadCount, kThreadSnapshotCapacity) * ticks;
+        return std::min(std::max(capacity, kMinSampleBufferCapacity), kMaxSampleBufferCapacity);
+    }
+
+    SamplingProfiler::SamplingProfiler(std::function<void(const Backtrace &)> callback,
+        std::uint32_t samplingRateHz, std::uint64_t (*getTimestamp)(void),
+        SamplingPolicyOptions policyOptions)
+        : cache_(std::make_unique<ThreadMetadataCache>())
+        , buffer_(std::make_unique<SampleRingBuffer>(
+              sampleBufferCapacity(currentThreadCount(), samplingRateHz),
+              policyOptions.maxStackDepth))
+        , stackCopy_(policyOptions.maxStackCopySize > 0
+                  ? std::make_unique<StackCopy>(policyOptions.maxStackCopySize)
+                  : nullptr)
+        , threads_(std::make_unique<ThreadSnapshot>(kThreadSnapshotCapacity))
+        , policy_(std::make_unique<SamplingPolicy>(samplingRateHz, std::move(policyOptions)))
+        , telemetry_(std::make_unique<SamplingTelemetry>())
+        , drainContext_(std::make_unique<DrainContext>())
+        , getTimestamp_(getTimestamp != nullptr ? getTimestamp : getUptimeTimestamp)
         , isInitialized_(false)
         , isSampling_(false)
         , port_(0)
@@ -93,11 +216,24 @@ namespace profiling {
             != KERN_SUCCESS) {
             return;
         }
-        const auto intervalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::duration<float>(1) / samplingRateHz)
-                                    .count();
-        delaySpec_ = { .tv_sec = static_cast<unsigned int>(intervalNs / 1000000000ULL),
-            .tv_nsec = static_cast<clock_res_t>(intervalNs % 1000000000ULL) };
+        delaySpec_ = delaySpecForInterval(policy_->intervalNs());
+
+        drainContext_->callback = std::move(callback);
+        drainContext_->buffer = buffer_.get();
+        // The drain must keep up while the app is busy, which is when profiles matter most, so it
+        // can't run at a lower QoS than the app's own work. Each drain only converts the records
+        // written since the previous one.
+        drainContext_->queue = dispatch_queue_create("io.sentry.SamplingProfiler.drain",
+            dispatch_queue_attr_make_with_qos_class(
+                DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0));
+        // The sampling thread signals this source after each tick; signals that arrive while a
+        // drain is already pending are coalesced into a single handler invocation.
+        drainContext_->source
+            = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_ADD, 0, 0, drainContext_->queue);
+        dispatch_set_context(drainContext_->source, drainContext_.get());
+        dispatch_source_set_event_handler_f(drainContext_->source, drainSamples);
+        dispatch_resume(drainContext_->source);
+
         isInitialized_ = true;
     }
 
@@ -107,6 +243,11 @@ namespace profiling {
             return;
         }
         stopSampling();
+        dispatch_source_cancel(drainContext_->source);
+        // Cancellation doesn't interrupt a handler that is already running, so wait for it.
+        dispatch_sync_f(drainContext_->queue, nullptr, noop);
+        dispatch_release(drainContext_->source);
+        dispatch_release(drainContext_->queue);
         SENTRY_ASYNC_SAFE_LOG_KERN_RETURN(
             mach_port_mod_refs(mach_task_self(), port_, MACH_PORT_RIGHT_RECEIVE, -1));
     }
@@ -125,6 +266,7 @@ namespace profiling {
         }
         isSampling_ = true;
         numSamples_ = 0;
+        policy_->reset();
         pthread_attr_t attr;
         if (SENTRY_ASYNC_SAFE_LOG_ERRNO_RETURN(pthread_attr_init(&attr)) != 0) {
             return;
@@ -140,7 +282,9 @@ namespace profiling {
         }
 
         const auto params = new SamplingThreadParams { port_, clock_, delaySpec_, cache_.get(),
-            callback_, std::ref(numSamples_), std::move(onThreadStart) };
+            buffer_.get(), policy_.get(), telemetry_.get(), stackCopy_.get(), threads_.get(),
+            drainContext_->source, getTimestamp_, std::ref(numSamples_),
+            std::move(onThreadStart) };
         if (SENTRY_ASYNC_SAFE_LOG_ERRNO_RETURN(
                 pthread_create(&thread_, &attr, samplingThreadMain, params))
             != 0) {
@@ -157,13 +301,28 @@ namespace profiling {
         if (!isInitialized_) {
             return;
         }
-        std::lock_guard<std::mutex> l(isSamplingLock_);
-        if (!isSampling_) {
+        {
+            std::lock_guard<std::mutex> l(isSamplingLock_);
+            if (!isSampling_) {
+                return;
+            }
+            SENTRY_ASYNC_SAFE_LOG_ERRNO_RETURN(pthread_cancel(thread_));
+            SENTRY_ASYNC_SAFE_LOG_ERRNO_RETURN(pthread_join(thread_, NULL));
+            isSampling_ = false;
+        }
+
+        // Deliver whatever the sampling thread wrote after the last drain was scheduled. This is
+        // done outside of the lock in case the callback queries the profiler.
+        dispatch_sync_f(drainContext_->queue, drainContext_.get(), drainSamples);
+    }
+
+    void
+    SamplingProfiler::drainPendingSamples()
+    {
+        if (!isInitialized_) {
             return;
         }
-        SENTRY_ASYNC_SAFE_LOG_ERRNO_RETURN(pthread_cancel(thread_));
-        SENTRY_ASYNC_SAFE_LOG_ERRNO_RETURN(pthread_join(thread_, NULL));
-        isSampling_ = false;
+        dispatch_sync_f(drainContext_->queue, drainContext_.get(), drainSamples);
     }
 
     bool
@@ -179,6 +338,24 @@ namespace profiling {
         return numSamples_.load();
     }
 
+    std::uint64_t
+    SamplingProfiler::numDroppedSamples()
+    {
+        return buffer_->numDropped();
+    }
+
+    std::uint32_t
+    SamplingProfiler::samplingRateHz()
+    {
+        return policy_->samplingRateHz();
+    }
+
+    SamplingTelemetry::Snapshot
+    SamplingProfiler::telemetry()
+    {
+        return telemetry_->snapshot();
+    }
+
 } // namespace profiling
 } // namespace sentry
 
@@ -0,0 +1,110 @@
+#include "SentrySamplingTelemetry.hpp"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include <algorithm>
+
+namespace {
+
+std::size_t
+bucketIndex(std::uint64_t value)
+{
+    if (value == 0) {
+        return 0;
+    }
+    const auto index = static_cast<std::size_t>(64 - __builtin_clzll(value));
+    return std::min(index, sentry::profiling::Histogram::kNumBuckets - 1);
+}
+
+} // namespace
+
+namespace sentry {
+namespace profiling {
+
+    constexpr std::size_t Histogram::kNumBuckets;
+
+    Histogram::Histogram() noexcept
+        : count_(0)
+        , sum_(0)
+        , max_(0)
+    {
+        for (auto &bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void
+    Histogram::record(std::uint64_t value) noexcept
+    {
+        buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        // There is only one writer, so this can't race with another update of the maximum.
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    Histogram::Snapshot
+    Histogram::snapshot() const noexcept
+    {
+        Snapshot snapshot;
+        for (std::size_t i = 0; i < kNumBuckets; i++) {
+            snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count = count_.load(std::memory_order_relaxed);
+        snapshot.sum = sum_.load(std::memory_order_relaxed);
+        snapshot.max = max_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    std::uint64_t
+    Histogram::bucketUpperBound(std::size_t index) noexcept
+    {
+        // the last bucket also counts all values that are too large for it
+        if (index >= kNumBuckets - 1) {
+            return UINT64_MAX;
+        }
+        return 1ULL << index;
+    }
+
+    Histogram::Snapshot
+    Histogram::Snapshot::since(const Snapshot &earlier) const noexcept
+    {
+        Snapshot delta;
+        for (std::size_t i = 0; i < kNumBuckets; i++) {
+            delta.buckets[i] = buckets[i] - earlier.buckets[i];
+        }
+        delta.count = count - earlier.count;
+        delta.sum = sum - earlier.sum;
+        delta.max = max;
+        return delta;
+    }
+
+    SamplingTelemetry::Snapshot
+    SamplingTelemetry::Snapshot::since(const Snapshot &earlier) const noexcept
+    {
+        return { tickDurationNs.since(earlier.tickDurationNs),
+            suspendDurationNs.since(earlier.suspendDurationNs),
+            stackDepth.since(earlier.stackDepth),
+            sampledThreadsPerTick.since(earlier.sampledThreadsPerTick),
+            skippedThreadsPerTick.since(earlier.skippedThreadsPerTick),
+            failedThreadsPerTick.since(earlier.failedThreadsPerTick),
+            suspendFailures - earlier.suspendFailures, unwindFailures - earlier.unwindFailures,
+            truncatedStacks - earlier.truncatedStacks };
+    }
+
+    SamplingTelemetry::Snapshot
+    SamplingTelemetry::snapshot() const noexcept
+    {
+        return { tickDurationNs.snapshot(), suspendDurationNs.snapshot(), stackDepth.snapshot(),
+            sampledThreadsPerTick.snapshot(), skippedThreadsPerTick.snapshot(),
+            failedThreadsPerTick.snapshot(), suspendFailures.load(std::memory_order_relaxed),
+            unwindFailures.load(std::memory_order_relaxed),
+            truncatedStacks.load(std::memory_order_relaxed) };
+    }
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
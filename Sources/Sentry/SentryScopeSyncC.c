@@ -1,11 +1,19 @@
 #include "SentryScopeSyncC.h"
 #include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define NUMBER_OF_FIELDS 9
 
+/** Stored in front of every field, so the crash handler doesn't need to scan it. */
+typedef struct {
+    uint32_t size;
+    uint32_t jsonLength;
+    bool isRecord;
+} FieldHeader;
+
 static SentryCrashScope scope = { 0 };
 
 SentryCrashScope *
@@ -14,17 +22,85 @@ sentrycrash_scopesync_getScope(void)
     return &scope;
 }
 
+static FieldHeader
+getHeader(const char *const field)
+{
+    FieldHeader header;
+    memcpy(&header, field - sizeof(header), sizeof(header));
+    return header;
+}
+
+size_t
+sentrycrash_scopesync_getLength(const char *const field)
+{
+    return field == NULL ? 0 : getHeader(field).jsonLength;
+}
+
+bool
+sentrycrash_scopesync_isRecord(const char *const field)
+{
+    return field != NULL && getHeader(field).isRecord;
+}
+
+size_t
+sentrycrash_scopesync_getSize(const char *const field)
+{
+    return field == NULL ? 0 : getHeader(field).size;
+}
+
+/**
+ * Copies the bytes into a new allocation of the form @c [FieldHeader][bytes][NUL], so the crash
+ * handler can get their size and length as JSON without scanning them.
+ *
+ * @return A pointer to the bytes of the copy, or NULL if it couldn't be allocated.
+ */
+static char *
+copyWithHeader(
+    const void *const bytes, const size_t size, const size_t jsonLength, const bool isRecord)
+{
+    if (size > UINT32_MAX || jsonLength > UINT32_MAX) {
+        return NULL;
+    }
+    char *copy = malloc(sizeof(FieldHeader) + size + 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+    const FieldHeader header
+        = { .size = (uint32_t)size, .jsonLength = (uint32_t)jsonLength, .isRecord = isRecord };
+    memcpy(copy, &header, sizeof(header));
+    memcpy(copy + sizeof(header), bytes, size);
+    copy[sizeof(header) + size] = '\0';
+    return copy + sizeof(header);
+}
+
 static void
-setField(const char *const newJSONCodedCString, char **field)
+clearField(char **field)
 {
     char *localField = *field;
     *field = NULL;
     if (localField != NULL) {
-        free((void *)localField);
+        free((void *)(localField - sizeof(FieldHeader)));
     }
+}
+
+static void
+setField(const char *const newJSONCodedCString, char **field)
+{
+    clearField(field);
 
     if (newJSONCodedCString != NULL) {
-        *field = strdup(newJSONCodedCString);
+        const size_t length = strlen(newJSONCodedCString);
+        *field = copyWithHeader(newJSONCodedCString, length, length, false);
+    }
+}
+
+static void
+setFieldRecord(const SentryCrashScopeRecord *const record, char **field)
+{
+    clearField(field);
+
+    if (record != NULL) {
+        *field = copyWithHeader(record->bytes, record->size, record->jsonLength, true);
     }
 }
 
@@ -94,6 +170,72 @@ sentrycrash_scopesync_addBreadcrumb(const char *const jsonEncodedCString)
     scope.currentCrumb = (scope.currentCrumb + 1) % scope.maxCrumbs;
 }
 
+void
+sentrycrash_scopesync_setUserRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.user);
+}
+
+void
+sentrycrash_scopesync_setDistRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.dist);
+}
+
+void
+sentrycrash_scopesync_setContextRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.context);
+}
+
+void
+sentrycrash_scopesync_setTraceContextRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.traceContext);
+}
+
+void
+sentrycrash_scopesync_setEnvironmentRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.environment);
+}
+
+void
+sentrycrash_scopesync_setTagsRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.tags);
+}
+
+void
+sentrycrash_scopesync_setExtrasRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.extras);
+}
+
+void
+sentrycrash_scopesync_setFingerprintRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.fingerprint);
+}
+
+void
+sentrycrash_scopesync_setLevelRecord(const SentryCrashScopeRecord *const record)
+{
+    setFieldRecord(record, &scope.level);
+}
+
+void
+sentrycrash_scopesync_addBreadcrumbRecord(const SentryCrashScopeRecord *const record)
+{
+    if (!scope.breadcrumbs || scope.maxCrumbs < 1) {
+        return;
+    }
+
+    setFieldRecord(record, &scope.breadcrumbs[scope.currentCrumb]);
+    // Ring buffer
+    scope.currentCrumb = (scope.currentCrumb + 1) % scope.maxCrumbs;
+}
+
 void
 sentrycrash_scopesync_clearBreadcrumbs(void)
 {
@@ -85,6 +85,29 @@ namespace profiling {
         return std::make_pair(std::move(threads), std::move(current));
     }
 
+    void
+    ThreadHandle::allExcludingCurrent(ThreadSnapshot *snapshot) noexcept
+    {
+        snapshot->clear();
+        snapshot->current_.reset(pthread_mach_thread_np(pthread_self()), false /* isOwnedPort */);
+        mach_msg_type_number_t count = 0;
+        thread_act_array_t list = nullptr;
+        if (SENTRY_ASYNC_SAFE_LOG_KERN_RETURN(task_threads(mach_task_self(), &list, &count))
+            == KERN_SUCCESS) {
+            for (decltype(count) i = 0; i < count; i++) {
+                const auto thread = list[i];
+                if (thread != snapshot->current_.nativeHandle()) {
+                    snapshot->append(thread);
+                } else {
+                    SENTRY_ASYNC_SAFE_LOG_KERN_RETURN(
+                        mach_port_deallocate(mach_task_self(), thread));
+                }
+            }
+            SENTRY_ASYNC_SAFE_LOG_KERN_RETURN(vm_deallocate(
+                mach_task_self(), reinterpret_cast<vm_address_t>(list), sizeof(*list) * count));
+        }
+    }
+
     thread::TIDType
     ThreadHandle::tidFromNativeHandle(NativeHandle handle)
     {
@@ -103,6 +126,24 @@ namespace profiling {
         return tidFromNativeHandle(handle_);
     }
 
+    std::uint64_t
+    ThreadHandle::systemThreadID() const noexcept
+    {
+        if (handle_ == THREAD_NULL) {
+            return 0;
+        }
+        mach_msg_type_number_t count = THREAD_IDENTIFIER_INFO_COUNT;
+        thread_identifier_info_data_t data;
+        const auto rv = thread_info(
+            handle_, THREAD_IDENTIFIER_INFO, reinterpret_cast<thread_info_t>(&data), &count);
+        // MACH_SEND_INVALID_DEST is returned when the thread no longer exists
+        if ((rv != MACH_SEND_INVALID_DEST)
+            && (SENTRY_ASYNC_SAFE_LOG_KERN_RETURN(rv) == KERN_SUCCESS)) {
+            return data.thread_id;
+        }
+        return 0;
+    }
+
     std::string
     ThreadHandle::name() const noexcept
     {
@@ -160,7 +201,7 @@ namespace profiling {
         if (handle_ == THREAD_NULL) {
             return { };
         }
-        ThreadCPUInfo cpuInfo;
+        ThreadCPUInfo cpuInfo = { };
         mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
         thread_basic_info_data_t data;
         const auto rv = thread_info(
@@ -234,6 +275,17 @@ namespace profiling {
         return handle_ == other.handle_;
     }
 
+    void
+    ThreadHandle::reset(NativeHandle handle, bool isOwnedPort) noexcept
+    {
+        if (isOwnedPort_) {
+            SENTRY_ASYNC_SAFE_LOG_KERN_RETURN(mach_port_deallocate(mach_task_self(), handle_));
+        }
+        handle_ = handle;
+        isOwnedPort_ = isOwnedPort;
+        pthreadHandle_ = nullptr;
+    }
+
     pthread_t
     ThreadHandle::pthreadHandle() const noexcept
     {
@@ -252,6 +304,74 @@ namespace profiling {
         return pthreadHandle_;
     }
 
+    ThreadSnapshot::ThreadSnapshot(std::size_t capacity)
+        : size_(0)
+        , current_(THREAD_NULL)
+    {
+        handles_.reserve(capacity);
+        for (std::size_t i = 0; i < capacity; i++) {
+            handles_.push_back(std::unique_ptr<ThreadHandle>(
+                new ThreadHandle(THREAD_NULL, false /* isOwnedPort */)));
+        }
+    }
+
+    const ThreadHandle &
+    ThreadSnapshot::current() const noexcept
+    {
+        return current_;
+    }
+
+    ThreadSnapshot::const_iterator
+    ThreadSnapshot::begin() const noexcept
+    {
+        return handles_.cbegin();
+    }
+
+    ThreadSnapshot::const_iterator
+    ThreadSnapshot::end() const noexcept
+    {
+        return handles_.cbegin() + size_;
+    }
+
+    std::size_t
+    ThreadSnapshot::size() const noexcept
+    {
+        return size_;
+    }
+
+    bool
+    ThreadSnapshot::empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    std::size_t
+    ThreadSnapshot::capacity() const noexcept
+    {
+        return handles_.size();
+    }
+
+    void
+    ThreadSnapshot::clear() noexcept
+    {
+        for (std::size_t i = 0; i < size_; i++) {
+            handles_[i]->reset(THREAD_NULL, false /* isOwnedPort */);
+        }
+        size_ = 0;
+    }
+
+    void
+    ThreadSnapshot::append(ThreadHandle::NativeHandle handle)
+    {
+        if (size_ < handles_.size()) {
+            handles_[size_]->reset(handle, true /* isOwnedPort */);
+        } else {
+            handles_.push_back(
+                std::unique_ptr<ThreadHandle>(new ThreadHandle(handle, true /* isOwnedPort */)));
+        }
+        size_++;
+    }
+
 } // namespace profiling
 } // namespace sentry
 
@@ -5,65 +5,135 @@
 #    include "SentryStackBounds.hpp"
 #    include "SentryThreadHandle.hpp"
 
-#    include <algorithm>
 #    include <string>
-#    include <vector>
+#    include <utility>
 
 namespace {
 
+/**
+ * The number of generations a cached thread name is trusted for before it's compared to the
+ * thread's current name, to pick up threads that were renamed, e.g. by a queue that reuses its
+ * worker threads.
+ */
+constexpr std::uint64_t kGenerationsBetweenNameChecks = 100;
+
 bool
 isSentryOwnedThreadName(const std::string &name)
 {
     return name.rfind("io.sentry", 0) == 0;
 }
 
-// Apple's `libpthread` has a hard limit of 64 characters for thread names.
-// See
-// https://github.com/apple-oss-distributions/libpthread/blob/42d026df5b07825070f60134b980a1ec2552dfee/src/pthread.c#L1178
-constexpr std::size_t kMaxThreadNameLength = 64;
+std::string
+truncatedThreadName(const sentry::profiling::ThreadHandle &thread)
+{
+    auto threadName = thread.name();
+    if (threadName.size() > sentry::profiling::kMaxThreadNameLength) {
+        threadName.resize(sentry::profiling::kMaxThreadNameLength);
+    }
+    return threadName;
+}
 
 } // namespace
 
 namespace sentry {
 namespace profiling {
 
-    ThreadMetadata
+    bool
+    ThreadMetadataCache::queryMetadata(const ThreadHandle &thread, ThreadMetadata *metadata)
+    {
+        metadata->threadID = thread.tid();
+        metadata->priority = thread.priority();
+
+        // If getting the priority fails (via pthread_getschedparam()), that
+        // means the rest of this is probably going to fail too. We also don't
+        // want to cache this result.
+        if (metadata->priority == -1) {
+            return false;
+        }
+
+        metadata->name = truncatedThreadName(thread);
+        if (isSentryOwnedThreadName(metadata->name)) {
+            // Don't collect backtraces for Sentry-owned threads.
+            metadata->priority = 0;
+            metadata->threadID = 0;
+        }
+        return true;
+    }
+
+    const ThreadMetadata &
     ThreadMetadataCache::metadataForThread(const ThreadHandle &thread)
     {
         const auto handle = thread.nativeHandle();
-        const auto it = std::find_if(threadMetadataCache_.cbegin(), threadMetadataCache_.cend(),
-            [handle](const ThreadHandleMetadataPair &pair) { return pair.handle == handle; });
-        if (it == threadMetadataCache_.cend()) {
-            ThreadMetadata metadata;
-            metadata.threadID = ThreadHandle::tidFromNativeHandle(handle);
-            metadata.priority = thread.priority();
-
-            // If getting the priority fails (via pthread_getschedparam()), that
-            // means the rest of this is probably going to fail too. We also don't
-            // want to cache this result.
-            if (metadata.priority == -1) {
-                return metadata;
+        const auto systemThreadID = thread.systemThreadID();
+        const auto it = entries_.find(handle);
+        if (it != entries_.end() && it->second.systemThreadID == systemThreadID) {
+            auto &entry = it->second;
+            entry.generation = generation_;
+            if (generation_ - entry.nameGeneration >= kGenerationsBetweenNameChecks) {
+                entry.nameGeneration = generation_;
+                if (truncatedThreadName(thread) != entry.metadata.name) {
+                    ThreadMetadata metadata;
+                    if (queryMetadata(thread, &metadata)) {
+                        entry.metadata = std::move(metadata);
+                    }
+                }
             }
+            return entry.metadata;
+        }
 
-            auto threadName = thread.name();
-            if (isSentryOwnedThreadName(threadName)) {
-                // Don't collect backtraces for Sentry-owned threads.
-                metadata.priority = 0;
-                metadata.threadID = 0;
-                threadMetadataCache_.push_back({ handle, metadata });
-                return metadata;
-            }
-            if (threadName.size() > kMaxThreadNameLength) {
-                threadName.resize(kMaxThreadNameLength);
+        // Either the thread is new, or its port name was reused after the cached thread exited.
+        ThreadMetadata metadata;
+        if (!queryMetadata(thread, &metadata)) {
+            if (it != entries_.end()) {
+                entries_.erase(it);
             }
+            uncachedMetadata_ = std::move(metadata);
+            return uncachedMetadata_;
+        }
+        auto &entry = entries_[handle];
+        entry.metadata = std::move(metadata);
+        entry.systemThreadID = systemThreadID;
+        entry.generation = generation_;
+        entry.nameGeneration = generation_;
+        return entry.metadata;
+    }
+
+    void
+    ThreadMetadataCache::beginGeneration() noexcept
+    {
+        generation_++;
+    }
+
+    void
+    ThreadMetadataCache::markThreadAlive(const ThreadHandle &thread) noexcept
+    {
+        const auto it = entries_.find(thread.nativeHandle());
+        if (it != entries_.end()) {
+            it->second.generation = generation_;
+        }
+    }
 
-            metadata.name = threadName;
-            threadMetadataCache_.push_back({ handle, metadata });
-            return metadata;
-        } else {
-            return (*it).metadata;
+    std::size_t
+    ThreadMetadataCache::evictStaleThreads()
+    {
+        std::size_t numEvicted = 0;
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->second.generation != generation_) {
+                it = entries_.erase(it);
+                numEvicted++;
+            } else {
+                ++it;
+            }
         }
+        return numEvicted;
     }
+
+    std::size_t
+    ThreadMetadataCache::size() const noexcept
+    {
+        return entries_.size();
+    }
+
 } // namespace profiling
 } // namespace sentry
 
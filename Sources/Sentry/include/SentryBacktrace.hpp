@@ -18,11 +18,28 @@ namespace sentry {
 namespace profiling {
 
     struct StackBounds;
+    class SampleRingBuffer;
+    class SamplingPolicy;
+    struct SamplingTelemetry;
+
+    /** The default maximum number of addresses collected for a single thread's backtrace. */
+    constexpr std::size_t kMaxBacktraceDepth = 128;
+
+    /**
+     * Stands in for the outermost frames of a truncated backtrace, after its last address. It can't
+     * be a real instruction address since it isn't aligned.
+     */
+    constexpr std::uintptr_t kTruncatedStackMarkerAddress = UINTPTR_MAX;
 
     struct Backtrace {
         ThreadMetadata threadMetadata;
-        std::uint64_t absoluteTimestamp;
+        std::uint64_t absoluteTimestamp = 0;
         std::vector<std::uintptr_t> addresses;
+        /**
+         * Whether the stack was deeper than the maximum depth, in which case @c addresses only
+         * holds its innermost frames.
+         */
+        bool isTruncated = false;
     };
 
     /**
@@ -39,13 +56,72 @@ namespace profiling {
      * @param maxDepth The maximum number of addresses to collect, this should
      * be less than or equal to the size of the buffer.
      * @param skip An optional number of stack frames to skip at the beginning.
+     * @param readableBounds The part of the stack that is known to be readable, see
+     * @c readableStackBounds . Frames within it are read without first checking that they are
+     * readable, which takes a syscall per frame. If null, every frame is checked.
      *
      * @return The actual number of addresses collected. Returns 0 if a backtrace
      * could not be collected.
      */
     NOT_TAIL_CALLED NEVER_INLINE std::size_t backtrace(const ThreadHandle &targetThread,
         const ThreadHandle &callingThread, std::uintptr_t *addresses, const StackBounds &bounds,
-        bool *reachedEndOfStackPtr, std::size_t maxDepth, std::size_t skip = 0) noexcept;
+        bool *reachedEndOfStackPtr, std::size_t maxDepth, std::size_t skip = 0,
+        const StackBounds *readableBounds = nullptr) noexcept;
+
+    /**
+     * Finds the part of a stack that can be read, from the start of the stack down to the first
+     * address that isn't mapped readable, e.g. the guard page. A thread's stack mapping doesn't
+     * change while it runs, so this can be called before the thread is suspended.
+     *
+     * @return The readable part of @c bounds , which is not valid if none of it is readable.
+     */
+    StackBounds readableStackBounds(const StackBounds &bounds) noexcept;
+
+    /**
+     * The registers of a suspended thread and a copy of its stack memory, from its stack pointer up
+     * to the start of its stack or to @c capacity bytes, whichever is closer. This lets the frame
+     * pointers be walked after the thread was resumed, so that it is only suspended for as long as
+     * copying its stack takes.
+     */
+    struct StackCopy {
+        /** @param capacity The number of bytes of stack memory to preallocate room for. */
+        explicit StackCopy(std::size_t capacity);
+
+        std::uintptr_t programCounter = 0;
+        std::uintptr_t linkRegister = 0;
+        std::uintptr_t framePointer = 0;
+        /** The stack address that the first copied byte was read from, i.e. the stack pointer. */
+        std::uintptr_t base = 0;
+        /** The number of bytes that were copied. */
+        std::size_t size = 0;
+        /** The number of bytes that can be copied. */
+        const std::size_t capacity;
+        /** The copied stack memory; pointer-sized elements keep the frames in it aligned. */
+        const std::unique_ptr<std::uintptr_t[]> memory;
+    };
+
+    /**
+     * Copies the registers and stack memory of @c targetThread into @c copy . The thread must be
+     * suspended, and must not be the calling thread. This function is async-signal-safe.
+     *
+     * @return Whether the thread's state could be read and its stack copied.
+     */
+    bool copyStack(const ThreadHandle &targetThread, const StackBounds &bounds,
+        StackCopy *copy) noexcept;
+
+    /**
+     * Collects a backtrace by walking the frame pointers in a copy of a thread's stack, without
+     * accessing the thread's memory. The parameters are the same as for the other overload, with
+     * the addition of:
+     *
+     * @param copy The copy made by @c copyStack .
+     * @param reachedEndOfCopyPtr Pointer to a bool to be set indicating whether the stack traversal
+     * stopped because the next frame was beyond the copied memory, i.e. the stack was deeper than
+     * the copy's capacity.
+     */
+    std::size_t backtrace(const StackCopy &copy, std::uintptr_t *addresses,
+        const StackBounds &bounds, bool *reachedEndOfStackPtr, bool *reachedEndOfCopyPtr,
+        std::size_t maxDepth) noexcept;
 
     /**
      * Attempts to collect backtraces for every thread in the process, except the
@@ -60,6 +136,33 @@ namespace profiling {
     void enumerateBacktracesForAllThreads(
         const std::function<void(const Backtrace &)> &f, ThreadMetadataCache *cache);
 
+    /**
+     * Attempts to collect backtraces for every thread in the process, except the
+     * thread that this function is being called on, writing one record per thread into
+     * preallocated slots of @c buffer instead of invoking a callback. At most
+     * @c buffer.maxDepth() addresses are collected per thread. Unlike the callback based
+     * variant, this does not allocate any memory for the collected backtraces, which makes it
+     * suitable for the sampling thread.
+     *
+     * @param buffer The ring buffer to write sample records into. If it is full, samples are
+     * dropped.
+     * @param cache The cache used to look up thread metadata.
+     * @param getTimestamp Returns the absolute timestamp recorded for each sample.
+     * @param policy If not null, decides which threads are sampled and whether stacks deeper than
+     * the buffer's maximum depth are kept. If null, such stacks are discarded.
+     * @param telemetry If not null, receives the cost of sampling each thread and the number of
+     * threads that were skipped or couldn't be sampled.
+     * @param stackCopy If not null, each thread's stack is copied into it while the thread is
+     * suspended and walked after it was resumed, instead of being walked while it is suspended.
+     * @param threads If not null, the process's threads are enumerated into it, reusing the
+     * handles it holds from previous calls. If null, a new snapshot is allocated for this call.
+     * @return The number of records written into the buffer.
+     */
+    std::size_t enumerateBacktracesForAllThreads(SampleRingBuffer &buffer,
+        ThreadMetadataCache *cache, std::uint64_t (*getTimestamp)(void),
+        SamplingPolicy *policy = nullptr, SamplingTelemetry *telemetry = nullptr,
+        StackCopy *stackCopy = nullptr, ThreadSnapshot *threads = nullptr);
+
 } // namespace profiling
 } // namespace sentry
 
@@ -25,6 +25,12 @@ FOUNDATION_EXPORT NSString *const kSentryNotificationContinuousProfileStarted;
 
 + (nullable SentryId *)currentProfilerID;
 
+/**
+ * The cost of sampling for the current continuous profiler since it started, or @c nil if none is
+ * running.
+ */
++ (nullable NSDictionary<NSString *, id> *)samplingTelemetry;
+
 @end
 
 NS_ASSUME_NONNULL_END
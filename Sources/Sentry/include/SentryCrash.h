@@ -130,6 +130,27 @@ SENTRY_NO_INIT
  */
 @property (nonatomic, readwrite, assign) int maxReportCount;
 
+/** The maximum total size in bytes of the reports on disk, or 0 for no limit.
+ * When exceeded, the oldest reports are deleted, but the newest one is always
+ * kept.
+ *
+ * Default: 0
+ */
+@property (nonatomic, readwrite, assign) int64_t maxReportStoreSize;
+
+/** The size in bytes a crash report should not exceed, or 0 for no limit.
+ * When a report would exceed it, the error, the crashed thread and the binary
+ * images it references are kept, and less important sections are left out:
+ * first memory introspection, then the other threads, the binary images not
+ * referenced by the crashed thread, the breadcrumbs and finally the scope.
+ * Room for the scope and breadcrumbs is kept while the sections before them
+ * are written. The console log is only written into the room left over.
+ * What was left out is recorded in the report.
+ *
+ * Default: 0
+ */
+@property (nonatomic, readwrite, assign) int64_t maxReportSize;
+
 /** The report sink where reports get sent.
  * This MUST be set or else the reporter will not send reports (although it will
  * still record them).
@@ -2,6 +2,8 @@
 #define SentryCrashBinaryImageCache_h
 
 #include "SentryCrashDynamicLinker.h"
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #ifdef __cplusplus
@@ -14,6 +16,19 @@ typedef void (*sentrycrashbic_cacheChangeCallback)(const SentryCrashBinaryImage
 
 void sentrycrashbic_iterateOverImages(sentrycrashbic_imageIteratorCallback index, void *context);
 
+/**
+ * Finds the loaded binary image containing the given address with a binary search over the images
+ * sorted by address. This doesn't take any lock and is async-signal-safe.
+ *
+ * This index is only used from C. Symbolication in the SDK still goes through the Swift
+ * SentryBinaryImageCache, which keeps its own sorted copy of the images.
+ *
+ * @param address The address to look up.
+ * @param image Receives a copy of the image containing the address, if any.
+ * @return true if an image contains the address.
+ */
+bool sentrycrashbic_imageForAddress(uint64_t address, SentryCrashBinaryImage *image);
+
 /**
  * Starts the cache that monitors binary images being loaded or removed.
  * The expensive dyld bootstrap is scheduled only once for the lifetime of the process.
@@ -39,6 +39,7 @@ extern "C" {
 #include "SentryCrashReportWriter.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /** Install the crash reporter. The reporter will record the next crash and then
  * terminate the program.
@@ -121,6 +122,20 @@ void sentrycrash_setCrashNotifyCallback(const SentryCrashReportWriteCallback onC
  */
 void sentrycrash_setMaxReportCount(int maxReportCount);
 
+/** Set the maximum total size in bytes of the reports on disk before old ones
+ * get deleted.
+ *
+ * @param maxReportStoreSize The maximum total size of the reports, or 0 for no
+ * limit.
+ */
+void sentrycrash_setMaxReportStoreSize(int64_t maxReportStoreSize);
+
+/** Set the size in bytes a crash report should not exceed.
+ *
+ * @param maxReportSize The maximum size of a report, or 0 for no limit.
+ */
+void sentrycrash_setMaxReportSize(int64_t maxReportSize);
+
 /**
  * @typedef SaveAttachmentCallback
  *
@@ -29,16 +29,36 @@
 #include "SentryCrashMonitor.h"
 #include "SentryCrashStackCursor.h"
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Counters of the exceptions thrown while the monitor is enabled, for diagnostics.
+ */
+typedef struct {
+    /** All intercepted throws and rethrows. */
+    uint64_t throwCount;
+
+    /** Throws of NSExceptions, which are left to the NSException monitor. */
+    uint64_t nsExceptionThrowCount;
+
+    /** Throws the return addresses were recorded for. */
+    uint64_t capturedStackTraceCount;
+} SentryCrashCPPExceptionThrowStatistics;
+
 /** Access the Monitor API.
  */
 SentryCrashMonitorAPI *sentrycrashcm_cppexception_getAPI(void);
 
 void sentrycrashcm_cppexception_enable_swap_cxa_throw(void);
 
+/** Get the throw counters since the monitor was last enabled.
+ * Divide by the elapsed time to get the throw rate.
+ */
+SentryCrashCPPExceptionThrowStatistics sentrycrashcm_cppexception_getThrowStatistics(void);
+
 /** For testing.
  */
 void sentrycrashcm_cppexception_callOriginalTerminationHandler(void);
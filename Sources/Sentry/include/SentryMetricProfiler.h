@@ -10,6 +10,14 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ * The range of readings a @c SentryMetricProfiler had recorded for each metric when the snapshot
+ * was taken. The readings aren't copied; they're read from the profiler's buffers when the
+ * snapshot is serialized, which is safe even after the profiler is cleared or deallocated.
+ */
+@interface SentryMetricProfilerSnapshot : NSObject
+@end
+
 /**
  * Return a serialized dictionary of the collected metrics.
  * @discussion The dictionary will have the following structure:
@@ -26,11 +34,14 @@ NS_ASSUME_NONNULL_BEGIN
  * }
  * @endcode
  */
-SENTRY_EXTERN NSDictionary<NSString *, id> *serializeContinuousProfileMetrics(NSDictionary *state);
+SENTRY_EXTERN NSDictionary<NSString *, id> *serializeContinuousProfileMetrics(
+    SentryMetricProfilerSnapshot *snapshot);
 
 /**
  * A profiler that gathers various time-series and event-based metrics on the app process, such as
  * CPU and memory usage timeseries and thermal and memory pressure warning notifications.
+ * @note Each metric is recorded into a fixed-capacity ring buffer without taking a lock, so only
+ * the most recent readings of long sessions are kept until they're cleared.
  */
 @interface SentryMetricProfiler : NSObject
 
@@ -64,10 +75,10 @@ SENTRY_NO_INIT
                                     and:(uint64_t)endSystemTime;
 
 /**
- * Copy the data structures in a thread safe way so they can be used later to serialize into a
- * payload for transmission.
+ * Capture the readings recorded so far in a thread safe way so they can be used later to
+ * serialize into a payload for transmission.
  */
-- (NSDictionary *)copyMetricProfilerData;
+- (SentryMetricProfilerSnapshot *)snapshotMetricProfilerData;
 
 #    if SENTRY_TEST || SENTRY_TEST_CI
 + (void)setSystemWrapperOverride:(SentrySystemWrapper *)value;
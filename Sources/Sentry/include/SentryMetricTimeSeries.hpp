@@ -0,0 +1,97 @@
+#pragma once
+
+#include "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include <atomic>
+#    include <cstddef>
+#    include <cstdint>
+#    include <functional>
+#    include <memory>
+
+namespace sentry {
+namespace profiling {
+
+    /** A single reading of a metric, such as CPU usage or memory footprint. */
+    struct MetricReading {
+        /** The absolute system time the reading was taken at, in nanoseconds. */
+        std::uint64_t systemTime;
+        /** The wall clock time the reading was taken at, in seconds since 1970. */
+        double dateInterval;
+        double value;
+    };
+
+    /**
+     * A fixed-capacity ring of metric readings. Readings can be recorded from any number of threads
+     * without taking a lock; once the ring is full, each new reading overwrites the oldest one.
+     *
+     * Readings are addressed by a monotonically increasing index, so a range of indices can be
+     * captured and read later without copying the readings. Each slot carries a sequence number,
+     * so a reader can tell if the reading it read was overwritten or still being written, in which
+     * case it is skipped.
+     */
+    class MetricTimeSeries {
+    public:
+        /** A half-open range of reading indices. */
+        struct Range {
+            std::uint64_t begin;
+            std::uint64_t end;
+        };
+
+        /**
+         * @param capacity The number of readings to keep; rounded up to the next power of two.
+         */
+        explicit MetricTimeSeries(std::size_t capacity);
+
+        void record(std::uint64_t systemTime, double dateInterval, double value) noexcept;
+
+        /**
+         * @return The indices of the readings recorded since the last call to @c clear() that
+         * haven't been overwritten yet.
+         */
+        Range readableRange() const noexcept;
+
+        /**
+         * Calls @c f with every reading of @c range that is still available, oldest first.
+         * @return The number of readings @c f was called with.
+         */
+        std::size_t forEach(
+            const Range &range, const std::function<void(const MetricReading &)> &f) const;
+
+        /** Discards all readings recorded so far. */
+        void clear() noexcept;
+
+        /** @return The number of readings the series keeps. */
+        std::size_t capacity() const noexcept;
+
+        MetricTimeSeries(const MetricTimeSeries &) = delete;
+        MetricTimeSeries &operator=(const MetricTimeSeries &) = delete;
+
+    private:
+        struct Slot {
+            /**
+             * @c 2i+1 while reading @c i is being written to the slot, and @c 2i+2 once it was
+             * written.
+             */
+            std::atomic<std::uint64_t> sequence;
+            std::atomic<std::uint64_t> systemTime;
+            std::atomic<std::uint64_t> dateIntervalBits;
+            std::atomic<std::uint64_t> valueBits;
+        };
+
+        /** Reads the reading with the specified index, if it is still available. */
+        bool read(std::uint64_t index, MetricReading *reading) const noexcept;
+
+        std::unique_ptr<Slot[]> slots_;
+        std::size_t mask_;
+        /** Index of the next reading to record. */
+        alignas(64) std::atomic<std::uint64_t> next_;
+        /** Index of the first reading that wasn't cleared. */
+        std::atomic<std::uint64_t> start_;
+    };
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include <cstddef>
+#    include <cstdint>
+#    include <vector>
+
+namespace sentry {
+namespace profiling {
+
+    /**
+     * An open-addressing hash map from 64-bit integer keys to dense 32-bit indices, used to
+     * deduplicate profile frames and stacks without formatting or boxing any values.
+     *
+     * @note This class is not thread-safe.
+     */
+    class IntegerIndexMap {
+    public:
+        static constexpr std::uint32_t kNotFound = UINT32_MAX;
+
+        /** @return The value for @c key, or @c kNotFound if it isn't in the map. */
+        std::uint32_t find(std::uint64_t key) const noexcept;
+
+        /**
+         * @return The existing value for @c key, or @c kNotFound after inserting @c value for it,
+         * so that callers can tell whether the key was new.
+         */
+        std::uint32_t findOrInsert(std::uint64_t key, std::uint32_t value);
+
+        std::size_t size() const noexcept;
+
+    private:
+        struct Slot {
+            std::uint64_t key;
+            /** @c kNotFound marks an empty slot. */
+            std::uint32_t value;
+        };
+
+        std::vector<Slot> slots_;
+        std::size_t size_ = 0;
+
+        void grow();
+    };
+
+    /**
+     * Deduplicates instruction addresses into a table of unique frames.
+     */
+    class FrameTable {
+    public:
+        /** @return The index of the frame for @c address, adding a new frame if needed. */
+        std::uint32_t intern(std::uintptr_t address);
+
+        /** @return The number of unique frames. */
+        std::size_t size() const noexcept;
+
+        /** @return The instruction address of the frame at @c index. */
+        std::uintptr_t addressAt(std::uint32_t index) const noexcept;
+
+    private:
+        IntegerIndexMap index_;
+        std::vector<std::uintptr_t> addresses_;
+    };
+
+    /**
+     * Deduplicates stacks of frame indices using a prefix trie, where each node is a
+     * (parent node, frame index) pair, so that stacks sharing their outermost frames share nodes
+     * and looking up a stack never requires hashing the whole stack.
+     */
+    class StackTable {
+    public:
+        /**
+         * @param frameIndices Frame indices ordered from the innermost frame to the outermost one,
+         * which is the order backtraces are collected in.
+         * @param count The number of frame indices.
+         * @return The index of the stack, adding a new stack if needed.
+         */
+        std::uint32_t intern(const std::uint32_t *frameIndices, std::size_t count);
+
+        /** @return The number of unique stacks. */
+        std::size_t size() const noexcept;
+
+        /**
+         * Replaces the contents of @c frameIndices with the frames of the stack at @c index,
+         * ordered from the innermost frame to the outermost one.
+         */
+        void framesOfStack(std::uint32_t index, std::vector<std::uint32_t> &frameIndices) const;
+
+    private:
+        struct Node {
+            std::uint32_t parent;
+            std::uint32_t frameIndex;
+        };
+
+        IntegerIndexMap children_;
+        std::vector<Node> nodes_;
+        /** The leaf node for each stack, or @c kNotFound for the empty stack. */
+        std::vector<std::uint32_t> stackLeaves_;
+        /** Maps a leaf node to its stack index. */
+        IntegerIndexMap stackIndices_;
+        std::uint32_t emptyStackIndex_ = IntegerIndexMap::kNotFound;
+    };
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
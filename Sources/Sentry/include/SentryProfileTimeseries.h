@@ -20,6 +20,12 @@ extern "C" {
 
 typedef NSArray<NSDictionary<NSString *, NSNumber *> *> SentryFrameInfoTimeSeries;
 
+/**
+ * @return The samples taken between @c startSystemTime and @c endSystemTime , inclusive, or @c nil
+ * if there are no samples or none were taken after the start or before the end.
+ * @note The samples must be sorted by timestamp, which they are as long as they're recorded in the
+ * order they were taken; they're found by binary search.
+ */
 NSArray<SentrySample *> *_Nullable sentry_slicedProfileSamples(
     NSArray<SentrySample *> *samples, uint64_t startSystemTime, uint64_t endSystemTime);
 
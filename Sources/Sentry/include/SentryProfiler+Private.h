@@ -46,6 +46,16 @@ SENTRY_EXTERN BOOL sentry_isLaunchProfileCorrelatedToTraces(void);
 
 SENTRY_EXTERN void sentry_reevaluateSessionSampleRate(void);
 
+/**
+ * Opts into lowering the sampling rate of profilers started from now on while sampling costs more
+ * than @c cpuBudget of a CPU core, e.g. @c 0.1 for 10%, and into skipping threads that were idle
+ * for more than @c idleTicksBeforeSkipping ticks. Both are off by default, as they lower the
+ * resolution of profiles; pass @c 0 to turn them off again. The rate that was sampled at is
+ * recorded in the sampling telemetry of the profiles.
+ */
+SENTRY_EXTERN void sentry_setProfilerAdaptiveSampling(
+    double cpuBudget, uint32_t idleTicksBeforeSkipping);
+
 SENTRY_EXTERN void sentry_configureContinuousProfiling(SentryOptions *options);
 
 /**
@@ -85,6 +95,25 @@ SENTRY_NO_INIT
  * can query for its profile data. */
 - (BOOL)isRunning;
 
+/**
+ * Adds the samples that were taken but not yet added to @c state , so that copying the profiling
+ * data includes every sample up to now. Blocks until they are added.
+ */
+- (void)drainPendingSamples;
+
+/**
+ * Histograms and counters describing how much the sampling thread has cost since the profiler
+ * started, e.g. how long threads were suspended for and how many couldn't be sampled, or @c nil
+ * if the profiler never started sampling.
+ */
+- (nullable NSDictionary<NSString *, id> *)serializedSamplingTelemetry;
+
+/**
+ * The same as @c -serializedSamplingTelemetry , but only covering the time since the previous call
+ * to this method, for attaching to continuous profile chunks.
+ */
+- (nullable NSDictionary<NSString *, id> *)serializedSamplingTelemetrySinceLastChunk;
+
 @end
 
 NS_ASSUME_NONNULL_END
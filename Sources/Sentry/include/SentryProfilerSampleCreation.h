@@ -8,14 +8,14 @@
 NS_ASSUME_NONNULL_BEGIN
 
 /**
- * Creates a profiler sample from a stack of frame indices and appends the stack to state if new.
+ * Creates a profiler sample referencing a stack that was already interned in the profiler state.
  * Used so that SentrySample (Swift) is only referenced from Objective-C, not from Objective-C++.
  */
 #    if defined(__cplusplus)
 extern "C" {
 #    endif
-SentrySample *sentry_profilerSampleWithStack(NSArray<NSNumber *> *stack, uint64_t absoluteTimestamp,
-    NSTimeInterval absoluteNSDateInterval, uint64_t threadID, SentryProfilerMutableState *state);
+SentrySample *sentry_profilerSampleWithStackIndex(uint32_t stackIndex, uint64_t absoluteTimestamp,
+    NSTimeInterval absoluteNSDateInterval, uint64_t threadID);
 #    if defined(__cplusplus)
 }
 #    endif
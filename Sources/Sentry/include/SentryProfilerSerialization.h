@@ -11,6 +11,7 @@
 @class SentryScreenFrames;
 @class SentryTransaction;
 @class SentryProfiler;
+@class SentryProfilerMutableState;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -22,8 +23,9 @@ SENTRY_EXTERN SentryEnvelopeItem *_Nullable sentry_traceProfileEnvelopeItem(Sent
     SentryProfiler *profiler, NSDictionary<NSString *, id> *profilingData,
     SentryTransaction *transaction, NSDate *startTimestamp);
 
-SentryEnvelope *_Nullable sentry_continuousProfileChunkEnvelope(
-    SentryId *profileID, NSDictionary *profileState, NSDictionary *metricProfilerState
+SentryEnvelope *_Nullable sentry_continuousProfileChunkEnvelope(SentryId *profileID,
+    SentryProfilerMutableState *profileState, NSDictionary *metricProfilerState,
+    NSDictionary *_Nullable samplingTelemetry
 #    if SENTRY_HAS_UIKIT
     ,
     SentryScreenFrames *gpuData
@@ -5,15 +5,43 @@
 #    import "SentryBacktrace.hpp"
 #    import "SentryProfilerState.h"
 
+#    import <cstdint>
+#    import <vector>
+
 /*
  * This extension defines C++ interface on SentryProfilerState that is not able to be imported into
  * a bridging header via SentryProfilerState.h due to C++/Swift interop limitations.
  */
 
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SentryProfilerMutableState ()
+
+/**
+ * Deduplicates the frames and the stack of a backtrace.
+ * @param addresses The backtrace's instruction addresses, innermost frame first.
+ * @param isTruncated Whether the backtrace's outermost frames are missing, in which case the stack
+ * ends with a marker frame and the truncation is counted.
+ * @param isNewStack Set to whether the stack hadn't been recorded before.
+ * @return The index of the stack.
+ */
+- (std::uint32_t)internStackWithAddresses:(const std::vector<std::uintptr_t> &)addresses
+                              isTruncated:(BOOL)isTruncated
+                               isNewStack:(nullable BOOL *)isNewStack;
+
+- (void)appendSampleWithStackIndex:(std::uint32_t)stackIndex
+                 absoluteTimestamp:(std::uint64_t)absoluteTimestamp
+            absoluteNSDateInterval:(NSTimeInterval)absoluteNSDateInterval
+                          threadID:(std::uint64_t)threadID;
+
+@end
+
 @interface SentryProfilerState ()
 
 - (void)appendBacktrace:(const sentry::profiling::Backtrace &)backtrace;
 
 @end
 
+NS_ASSUME_NONNULL_END
+
 #endif // SENTRY_TARGET_PROFILING_SUPPORTED
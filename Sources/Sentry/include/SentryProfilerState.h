@@ -26,9 +26,21 @@ NSString *parseBacktraceSymbolsFunctionName(const char *symbol);
 @class SentrySample;
 
 @interface SentryProfilerMutableState : NSObject
-@property (nonatomic, strong, readonly) NSMutableArray<SentrySample *> *samples;
-@property (nonatomic, strong, readonly) NSMutableArray<NSArray<NSNumber *> *> *stacks;
-@property (nonatomic, strong, readonly) NSMutableArray<NSDictionary<NSString *, id> *> *frames;
+
+/**
+ * Samples are recorded in native columns of timestamps, stack indices and thread IDs. This array
+ * of sample objects is only built from those columns when it's read, e.g. to slice a trace
+ * profile.
+ */
+@property (nonatomic, strong, readonly) NSArray<SentrySample *> *samples;
+
+/**
+ * @return The range of @c samples taken between @c startSystemTime and @c endSystemTime ,
+ * inclusive. Samples are recorded in the order they were taken, so the range is found by binary
+ * search over their timestamps.
+ */
+- (NSRange)rangeOfSamplesFromSystemTime:(uint64_t)startSystemTime
+                           toSystemTime:(uint64_t)endSystemTime;
 @property (nonatomic, strong, readonly)
     NSMutableDictionary<NSString *, NSMutableDictionary *> *threadMetadata;
 
@@ -65,18 +77,54 @@ NSString *parseBacktraceSymbolsFunctionName(const char *symbol);
  *   { stack_id: 1, ... },
  *   { stack_id: 1, ... }
  * ]
+ *
+ * The deduplication itself happens on raw addresses and frame indices in native tables (see
+ * SentryProfileInterningTables.hpp). These arrays are only built from those tables when they're
+ * read, so each unique frame is formatted once, when the profile is serialized.
  */
-@property (nonatomic, strong, readonly)
-    NSMutableDictionary<NSString *, NSNumber *> *frameIndexLookup;
-@property (nonatomic, strong, readonly)
-    NSMutableDictionary<NSString *, NSNumber *> *stackIndexLookup;
+@property (nonatomic, strong, readonly) NSArray<NSDictionary<NSString *, id> *> *frames;
+@property (nonatomic, strong, readonly) NSArray<NSArray<NSNumber *> *> *stacks;
+
+/**
+ * The instruction addresses of the unique frames, read directly from the frame table, to look up
+ * the images the profile references.
+ */
+@property (nonatomic, strong, readonly) NSArray<NSNumber *> *frameInstructionAddresses;
+
+/**
+ * The number of samples whose stack was too deep to be collected in full. Their stacks end with a
+ * frame whose function is @c <truncated> in place of the outermost frames.
+ */
+@property (nonatomic, assign, readonly) uint64_t numTruncatedSamples;
+
+/**
+ * Writes the @c profile object of a continuous profile chunk, with its samples, stacks, frames,
+ * thread metadata and, if any, the number of truncated samples, as JSON directly from the native
+ * tables, without building the intermediate @c samples , @c stacks and @c frames arrays.
+ */
+- (void)appendContinuousProfileChunkJSONToData:(NSMutableData *)data;
 @end
 
 @interface SentryProfilerState : NSObject
 // All functions are safe to call from multiple threads concurrently
 - (void)mutate:(void (^)(SentryProfilerMutableState *))block;
 - (NSDictionary<NSString *, id> *)copyProfilingData;
+
+/**
+ * Like @c -copyProfilingData , but only copies the samples taken between @c startSystemTime and
+ * @c endSystemTime , inclusive, so that each finishing transaction only pays for its own samples
+ * instead of copying and scanning all of them.
+ */
+- (NSDictionary<NSString *, id> *)copyProfilingDataFromSystemTime:(uint64_t)startSystemTime
+                                                     toSystemTime:(uint64_t)endSystemTime;
 - (void)clear;
+
+/**
+ * Replaces the current mutable state with an empty one, like @c -clear , and returns the previous
+ * state. The returned state is no longer reachable by the sampler, so it can be serialized without
+ * copying it first.
+ */
+- (SentryProfilerMutableState *)detachMutableState;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include "SentryBacktrace.hpp"
+#    include "SentryThreadHandle.hpp"
+#    include "SentryThreadMetadataCache.hpp"
+
+#    include <atomic>
+#    include <cstddef>
+#    include <cstdint>
+#    include <memory>
+
+namespace sentry {
+namespace profiling {
+
+    /**
+     * A fixed-size record of a single backtrace sample. Records are preallocated by
+     * @c SampleRingBuffer so that the sampling thread can fill them in without performing any
+     * heap allocations.
+     */
+    struct SampleRecord {
+        std::uint64_t absoluteTimestamp;
+        thread::TIDType threadID;
+        int priority;
+        /** Null-terminated thread name, truncated to @c kMaxThreadNameLength characters. */
+        char threadName[kMaxThreadNameLength + 1];
+        std::uint32_t depth;
+        /** Whether the stack had more than @c depth frames and only the innermost were kept. */
+        bool isTruncated;
+        /** Room for @c SampleRingBuffer::maxDepth() addresses, innermost frame first. */
+        std::uintptr_t *addresses;
+    };
+
+    /**
+     * A lock-free, single-producer/single-consumer ring of preallocated @c SampleRecord slots.
+     * The sampling thread is the only producer and the drain queue is the only consumer.
+     *
+     * @note Neither producer nor consumer operations allocate, take locks or make syscalls, so the
+     * producer side is safe to use while other threads are suspended.
+     */
+    class SampleRingBuffer {
+    public:
+        /**
+         * @param capacity The number of records to preallocate; rounded up to the next power of
+         * two.
+         * @param maxDepth The number of addresses to preallocate for each record.
+         */
+        explicit SampleRingBuffer(std::size_t capacity, std::size_t maxDepth = kMaxBacktraceDepth);
+
+        /**
+         * Producer: returns the next free slot to write a sample into, or @c nullptr if the
+         * consumer has fallen behind and the buffer is full, in which case the sample is counted
+         * as dropped. The slot is not visible to the consumer until @c commit() is called; if the
+         * slot ends up unused, simply don't commit it and it will be handed out again.
+         */
+        SampleRecord *reserve() noexcept;
+
+        /** Producer: publishes the slot most recently returned from @c reserve(). */
+        void commit() noexcept;
+
+        /** Consumer: returns the oldest committed record, or @c nullptr if the buffer is empty. */
+        const SampleRecord *peek() const noexcept;
+
+        /** Consumer: releases the record most recently returned from @c peek(). */
+        void pop() noexcept;
+
+        /** @return The number of records that could be preallocated. */
+        std::size_t capacity() const noexcept;
+
+        /** @return The number of addresses each record has room for. */
+        std::size_t maxDepth() const noexcept;
+
+        /**
+         * Producer: counts samples that were dropped without calling @c reserve() , because an
+         * earlier reservation of the same tick already failed.
+         */
+        void addDropped(std::uint64_t count) noexcept;
+
+        /** @return The number of samples dropped because the buffer was full. */
+        std::uint64_t numDropped() const noexcept;
+
+        SampleRingBuffer(const SampleRingBuffer &) = delete;
+        SampleRingBuffer &operator=(const SampleRingBuffer &) = delete;
+
+    private:
+        std::unique_ptr<SampleRecord[]> records_;
+        /** The address storage of all records, @c maxDepth_ entries per record. */
+        std::unique_ptr<std::uintptr_t[]> addresses_;
+        std::size_t mask_;
+        std::size_t maxDepth_;
+        /** Index of the next slot to write; only modified by the producer. */
+        alignas(64) std::atomic<std::size_t> head_;
+        /** Index of the next slot to read; only modified by the consumer. */
+        alignas(64) std::atomic<std::size_t> tail_;
+        std::atomic_uint64_t numDropped_;
+    };
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include "SentryBacktrace.hpp"
+#    include "SentryThreadHandle.hpp"
+
+#    include <atomic>
+#    include <cstddef>
+#    include <cstdint>
+#    include <unordered_map>
+
+namespace sentry {
+namespace profiling {
+    struct SamplingPolicyOptions {
+        /**
+         * The fraction of a CPU core the sampling thread may spend collecting backtraces, e.g.
+         * @c 0.05 for 5%. When the average cost of a tick exceeds this share of the sampling
+         * interval, the sampling rate is halved, and it is raised again once the cost drops well
+         * below the budget. @c 0 disables adapting the rate.
+         */
+        double cpuBudget = 0;
+
+        /** The lowest rate the sampling rate is lowered to when adapting to the CPU budget. */
+        std::uint32_t minSamplingRateHz = 1;
+
+        /**
+         * The number of consecutive ticks a thread can be idle before its (empty) samples are no
+         * longer recorded, until it runs again. @c 0 records idle threads on every tick.
+         */
+        std::uint32_t idleTicksBeforeSkipping = 0;
+
+        /** The maximum number of frames collected for each sampled thread. */
+        std::size_t maxStackDepth = kMaxBacktraceDepth;
+
+        /**
+         * Whether to record the innermost @c maxStackDepth frames of deeper stacks, marked as
+         * truncated, instead of discarding their samples.
+         */
+        bool keepTruncatedStacks = false;
+
+        /**
+         * The maximum number of bytes of each sampled thread's stack to copy while the thread is
+         * suspended, so that its frames are walked after it was resumed. Stacks that extend
+         * beyond the copy are treated like stacks deeper than @c maxStackDepth . @c 0 walks the
+         * frames while the thread is suspended instead.
+         */
+        std::size_t maxStackCopySize = 0;
+    };
+
+    /**
+     * Decides which threads are sampled on each tick of the sampling profiler, and how long to
+     * wait until the next tick based on how expensive the previous ones were.
+     *
+     * @note This class is not thread-safe, apart from @c samplingRateHz . It is only meant to be
+     * used from the sampling thread while it is running.
+     */
+    class SamplingPolicy {
+    public:
+        SamplingPolicy(std::uint32_t samplingRateHz, SamplingPolicyOptions options);
+
+        /** Restores the initial sampling rate and forgets about any idle threads. */
+        void reset() noexcept;
+
+        /** Marks the start of a tick. */
+        void beginTick() noexcept;
+
+        /**
+         * @param thread The thread that is about to be sampled.
+         * @param isIdle Whether the thread is currently idle.
+         * @return Whether a sample should be recorded for @c thread on this tick.
+         */
+        bool shouldSampleThread(const ThreadHandle &thread, bool isIdle);
+
+        /**
+         * Marks the end of a tick, adapting the sampling rate to its cost.
+         * @param tickCostNs The CPU time the sampling thread spent on the tick.
+         * @return Whether the sampling interval changed.
+         */
+        bool endTick(std::uint64_t tickCostNs) noexcept;
+
+        /** @return The interval to wait until the next tick, in nanoseconds. */
+        std::uint64_t intervalNs() const noexcept;
+
+        /** @return The current sampling rate; safe to call from any thread. */
+        std::uint32_t samplingRateHz() const noexcept;
+
+        /** @return Whether samples of stacks deeper than the maximum depth are kept. */
+        bool keepsTruncatedStacks() const noexcept;
+
+    private:
+        struct IdleThreadState {
+            std::uint32_t idleTicks;
+            std::uint64_t lastSeenTick;
+        };
+
+        void setSamplingRateHz(std::uint32_t samplingRateHz) noexcept;
+
+        const std::uint32_t initialSamplingRateHz_;
+        const SamplingPolicyOptions options_;
+        std::atomic<std::uint32_t> samplingRateHz_;
+        std::uint64_t intervalNs_;
+        /** Exponential moving average of the tick cost, in nanoseconds. */
+        double averageTickCostNs_;
+        std::uint64_t tick_;
+        std::uint64_t lastRateChangeTick_;
+        std::unordered_map<ThreadHandle::NativeHandle, IdleThreadState> idleThreads_;
+    };
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
@@ -4,6 +4,9 @@
 
 #if SENTRY_TARGET_PROFILING_SUPPORTED
 
+#    include "SentrySamplingPolicy.hpp"
+#    include "SentrySamplingTelemetry.hpp"
+
 #    include <atomic>
 #    include <cstdint>
 #    include <functional>
@@ -15,11 +18,17 @@
 namespace sentry {
 namespace profiling {
     class ThreadMetadataCache;
+    class SampleRingBuffer;
     struct Backtrace;
+    struct StackCopy;
+    class ThreadSnapshot;
 
     /**
      * Samples the stacks on all threads at a specified interval, using the mach clock
      * alarm API for scheduling.
+     *
+     * The sampling thread only writes raw sample records into a preallocated ring buffer; the
+     * records are then drained on a background queue, which is where the callback is invoked.
      */
     class SamplingProfiler {
     public:
@@ -27,11 +36,19 @@ namespace profiling {
          * Creates a new sampling profiler that samples at the specified rate.
          * @param callback The callback that is called with each trace entry containing the
          * backtrace for a particular thread. The timestamp of the entry will be set to the
-         * timestamp that the sample was collected at.
+         * timestamp that the sample was collected at. The callback is invoked serially on a
+         * background queue, not on the sampling thread.
          * @param samplingRateHz The sampling rate, in Hz, to sample at.
+         * @param getTimestamp Returns the timestamp to record for each sample. Called on the
+         * sampling thread after the sampled thread was resumed, so it should be cheap. Defaults to
+         * the uptime clock.
+         * @param policyOptions Options for lowering the sampling rate to stay within a CPU budget,
+         * for skipping threads and for limiting the stack depth. The defaults sample every thread
+         * at @c samplingRateHz and discard stacks deeper than @c kMaxBacktraceDepth .
          */
-        SamplingProfiler(
-            std::function<void(const Backtrace &)> callback, std::uint32_t samplingRateHz);
+        SamplingProfiler(std::function<void(const Backtrace &)> callback,
+            std::uint32_t samplingRateHz, std::uint64_t (*getTimestamp)(void) = nullptr,
+            SamplingPolicyOptions policyOptions = { });
 
         ~SamplingProfiler();
 
@@ -41,9 +58,18 @@ namespace profiling {
          */
         void startSampling(std::function<void()> onThreadStart = nullptr);
 
-        /** Stops the sampling profiler. */
+        /**
+         * Stops the sampling profiler. Any samples that were collected but not yet passed to the
+         * callback are drained before this returns.
+         */
         void stopSampling();
 
+        /**
+         * Passes the samples that were collected but not yet passed to the callback, without
+         * stopping the profiler. Must not be called from the callback.
+         */
+        void drainPendingSamples();
+
         /** Returns whether the profiler is currently sampling. */
         bool isSampling();
 
@@ -53,10 +79,49 @@ namespace profiling {
          */
         std::uint64_t numSamples();
 
+        /**
+         * Returns the number of thread samples that were dropped since this profiler was created
+         * because the callback could not keep up with the sampling thread.
+         */
+        std::uint64_t numDroppedSamples();
+
+        /**
+         * Returns the rate currently being sampled at, which may be lower than the requested rate
+         * if it was adapted to the CPU budget.
+         */
+        std::uint32_t samplingRateHz();
+
+        /**
+         * Returns the measurements of the sampling thread's own cost, accumulated since this
+         * profiler was created.
+         */
+        SamplingTelemetry::Snapshot telemetry();
+
+        /**
+         * @return The number of sample records to preallocate for sampling @c threadCount threads
+         * at @c samplingRateHz , so that the drain queue can fall behind for a while before
+         * samples are dropped.
+         */
+        static std::size_t sampleBufferCapacity(
+            std::size_t threadCount, std::uint32_t samplingRateHz) noexcept;
+
     private:
+        struct DrainContext;
+
+        /** Passes all pending sample records to the callback; runs on the drain queue. */
+        static void drainSamples(void *context);
+
         mach_timespec_t delaySpec_;
-        std::function<void(const Backtrace &)> callback_;
         std::unique_ptr<ThreadMetadataCache> cache_;
+        std::unique_ptr<SampleRingBuffer> buffer_;
+        /** Null unless the stacks are copied before being walked. */
+        std::unique_ptr<StackCopy> stackCopy_;
+        /** Reused by every tick to enumerate the threads to sample. */
+        std::unique_ptr<ThreadSnapshot> threads_;
+        std::unique_ptr<SamplingPolicy> policy_;
+        std::unique_ptr<SamplingTelemetry> telemetry_;
+        std::unique_ptr<DrainContext> drainContext_;
+        std::uint64_t (*getTimestamp_)(void);
         bool isInitialized_;
         std::mutex isSamplingLock_;
         bool isSampling_;
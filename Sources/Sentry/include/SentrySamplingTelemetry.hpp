@@ -0,0 +1,98 @@
+#pragma once
+
+#include "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    include <atomic>
+#    include <cstddef>
+#    include <cstdint>
+
+namespace sentry {
+namespace profiling {
+
+    /**
+     * A histogram with power-of-two buckets, so that recording a value never allocates and only
+     * takes a few atomic increments. Bucket @c 0 counts zeroes and bucket @c i counts values in
+     * @c [2^(i-1),2^i) .
+     *
+     * @note Values may be recorded from a single thread while snapshots are taken from any thread.
+     */
+    class Histogram {
+    public:
+        static constexpr std::size_t kNumBuckets = 48;
+
+        struct Snapshot {
+            std::uint64_t buckets[kNumBuckets];
+            std::uint64_t count;
+            std::uint64_t sum;
+            std::uint64_t max;
+
+            /**
+             * @return The values recorded since @c earlier was taken. The maximum is that of all
+             * values, since it can't be subtracted.
+             */
+            Snapshot since(const Snapshot &earlier) const noexcept;
+        };
+
+        Histogram() noexcept;
+
+        void record(std::uint64_t value) noexcept;
+
+        Snapshot snapshot() const noexcept;
+
+        /** @return The exclusive upper bound of the values counted in bucket @c index . */
+        static std::uint64_t bucketUpperBound(std::size_t index) noexcept;
+
+    private:
+        std::atomic<std::uint64_t> buckets_[kNumBuckets];
+        std::atomic<std::uint64_t> count_;
+        std::atomic<std::uint64_t> sum_;
+        std::atomic<std::uint64_t> max_;
+    };
+
+    /**
+     * Measures how much the sampling thread costs, recorded by the sampling thread on every tick.
+     */
+    struct SamplingTelemetry {
+        struct Snapshot {
+            Histogram::Snapshot tickDurationNs;
+            Histogram::Snapshot suspendDurationNs;
+            Histogram::Snapshot stackDepth;
+            Histogram::Snapshot sampledThreadsPerTick;
+            Histogram::Snapshot skippedThreadsPerTick;
+            Histogram::Snapshot failedThreadsPerTick;
+            std::uint64_t suspendFailures;
+            std::uint64_t unwindFailures;
+            std::uint64_t truncatedStacks;
+
+            Snapshot since(const Snapshot &earlier) const noexcept;
+        };
+
+        /** The wall time of a whole tick. */
+        Histogram tickDurationNs;
+        /** How long each sampled thread was suspended for. */
+        Histogram suspendDurationNs;
+        /** The number of frames walked for each sampled thread. */
+        Histogram stackDepth;
+        /** The number of threads a sample was recorded for on each tick. */
+        Histogram sampledThreadsPerTick;
+        /** The number of threads that were deliberately not sampled on each tick. */
+        Histogram skippedThreadsPerTick;
+        /** The number of threads whose sample was discarded on each tick. */
+        Histogram failedThreadsPerTick;
+
+        /** Threads that couldn't be suspended. */
+        std::atomic<std::uint64_t> suspendFailures { 0 };
+        /** Threads whose thread state couldn't be read or whose frame pointer was invalid. */
+        std::atomic<std::uint64_t> unwindFailures { 0 };
+        /** Threads whose stack was deeper than the maximum backtrace depth. */
+        std::atomic<std::uint64_t> truncatedStacks { 0 };
+
+        Snapshot snapshot() const noexcept;
+    };
+
+} // namespace profiling
+} // namespace sentry
+
+#endif
@@ -1,6 +1,14 @@
 #ifndef SentryScopeSyncC_h
 #define SentryScopeSyncC_h
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The scope for the crash handler. Every field is either a JSON string or a binary record, see
+ * sentrycrash_scopesync_isRecord.
+ */
 typedef struct {
     char *_Nullable user;
     char *_Nullable dist;
@@ -17,8 +25,68 @@ typedef struct {
 
 } SentryCrashScope;
 
+/**
+ * The types of the elements of a binary scope record.
+ *
+ * A record is a sequence of elements that encode a value the same way as the calls to
+ * SentryCrashJSONCodec that would write it as JSON, so the crash handler can write it as JSON
+ * without allocating. Every element starts with its type as one byte. All elements but
+ * @c SentryCrashScopeRecordEndContainer continue with their NUL-terminated name, which is empty for
+ * the top-level element and in arrays. Then follows the value: one byte for booleans, 8 bytes for
+ * numbers, and a @c uint32_t length and the bytes for strings and data, all in native byte order.
+ * Objects and arrays have no value, but end with a @c SentryCrashScopeRecordEndContainer element.
+ */
+typedef enum {
+    SentryCrashScopeRecordNull = 1,
+    SentryCrashScopeRecordBoolean,
+    SentryCrashScopeRecordInteger,
+    SentryCrashScopeRecordFloatingPoint,
+    SentryCrashScopeRecordString,
+    SentryCrashScopeRecordData,
+    SentryCrashScopeRecordBeginObject,
+    SentryCrashScopeRecordBeginArray,
+    SentryCrashScopeRecordEndContainer,
+} SentryCrashScopeRecordType;
+
+/**
+ * A binary scope record to store in a field of the scope.
+ */
+typedef struct {
+    const void *_Nonnull bytes;
+    size_t size;
+
+    /** The length of the value as JSON, or an upper bound of it. */
+    size_t jsonLength;
+} SentryCrashScopeRecord;
+
 SentryCrashScope *_Nonnull sentrycrash_scopesync_getScope(void);
 
+/**
+ * Returns the length of a field of the scope as JSON without scanning it, as the scope stores the
+ * length in front of every field. For binary records, this is an upper bound. Only pass fields of
+ * the scope returned by @c sentrycrash_scopesync_getScope.
+ * Async-safe.
+ *
+ * @return The length of the field as JSON, or 0 if it is NULL.
+ */
+size_t sentrycrash_scopesync_getLength(const char *_Nullable const field);
+
+/**
+ * Returns whether a field of the scope is a binary record instead of a JSON string. Only pass
+ * fields of the scope returned by @c sentrycrash_scopesync_getScope.
+ * Async-safe.
+ */
+bool sentrycrash_scopesync_isRecord(const char *_Nullable const field);
+
+/**
+ * Returns the size of a field of the scope in bytes, without the terminating NUL. Only pass fields
+ * of the scope returned by @c sentrycrash_scopesync_getScope.
+ * Async-safe.
+ *
+ * @return The size of the field, or 0 if it is NULL.
+ */
+size_t sentrycrash_scopesync_getSize(const char *_Nullable const field);
+
 /**
  * Needs to be called before adding or clearing breadcrumbs to initialize the storage of the
  * breadcrumbs. Calling this method clears all breadcrumbs.
@@ -45,6 +113,29 @@ void sentrycrash_scopesync_setLevel(const char *_Nullable const jsonEncodedCStri
 
 void sentrycrash_scopesync_addBreadcrumb(const char *_Nullable const jsonEncodedCString);
 
+void sentrycrash_scopesync_setUserRecord(const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setDistRecord(const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setContextRecord(const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setTraceContextRecord(
+    const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setEnvironmentRecord(
+    const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setTagsRecord(const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setExtrasRecord(const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setFingerprintRecord(
+    const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_setLevelRecord(const SentryCrashScopeRecord *_Nullable const record);
+
+void sentrycrash_scopesync_addBreadcrumbRecord(const SentryCrashScopeRecord *_Nonnull const record);
+
 void sentrycrash_scopesync_clearBreadcrumbs(void);
 
 void sentrycrash_scopesync_clear(void);
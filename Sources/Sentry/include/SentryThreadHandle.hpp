@@ -7,6 +7,7 @@
 #    include "SentryStackBounds.hpp"
 
 #    include <chrono>
+#    include <cstddef>
 #    include <cstdint>
 #    include <mach/mach.h>
 #    include <memory>
@@ -40,6 +41,8 @@ namespace profiling {
         bool idle;
     };
 
+    class ThreadSnapshot;
+
     class ThreadHandle {
     public:
         using NativeHandle = thread_t;
@@ -73,6 +76,15 @@ namespace profiling {
         static std::pair<std::vector<std::unique_ptr<ThreadHandle>>, std::unique_ptr<ThreadHandle>>
         allExcludingCurrent() noexcept;
 
+        /**
+         * Fills @c snapshot with handles for all of the threads in the current process, excluding
+         * the current thread, like @c allExcludingCurrent() , but reuses the handles the snapshot
+         * already holds instead of allocating new ones, so that repeatedly taking a snapshot
+         * doesn't allocate once it has grown to the number of threads in the process.
+         * @param snapshot The snapshot to fill; its previous contents are released.
+         */
+        static void allExcludingCurrent(ThreadSnapshot *snapshot) noexcept;
+
         /**
          * @param handle The native handle to get the TID from.
          * @return The TID of the thread that the native handle represents.
@@ -89,6 +101,12 @@ namespace profiling {
          */
         thread::TIDType tid() const noexcept;
 
+        /**
+         * @return The system-wide ID of the thread, which, unlike its port name, is never reused
+         * for another thread, or 0 if it couldn't be determined.
+         */
+        std::uint64_t systemThreadID() const noexcept;
+
         /**
          * @return The name of the thread, or an empty string if the thread doesn't
          * have a name, or if there was failure in acquiring the name.
@@ -141,12 +159,63 @@ namespace profiling {
         ThreadHandle &operator=(const ThreadHandle &) = delete;
 
     private:
+        friend class ThreadSnapshot;
+
         NativeHandle handle_;
         bool isOwnedPort_;
         mutable pthread_t pthreadHandle_;
 
         ThreadHandle(NativeHandle handle, bool isOwnedPort) noexcept;
         pthread_t pthreadHandle() const noexcept;
+
+        /** Makes this handle represent another thread, releasing the port it owned, if any. */
+        void reset(NativeHandle handle, bool isOwnedPort) noexcept;
+    };
+
+    /**
+     * A reusable list of thread handles, filled by @c ThreadHandle::allExcludingCurrent() . The
+     * handles are kept when the snapshot is cleared or refilled, so that its storage only grows
+     * when the process has more threads than ever before.
+     *
+     * @note This class is not thread-safe.
+     */
+    class ThreadSnapshot {
+    public:
+        using const_iterator = std::vector<std::unique_ptr<ThreadHandle>>::const_iterator;
+
+        /**
+         * @param capacity The number of handles to allocate up front.
+         */
+        explicit ThreadSnapshot(std::size_t capacity = 0);
+
+        /**
+         * @return A handle to the thread that took the snapshot.
+         */
+        const ThreadHandle &current() const noexcept;
+
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+        std::size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        /** @return The number of threads the snapshot can hold without allocating. */
+        std::size_t capacity() const noexcept;
+
+        /** Releases the ports of all threads in the snapshot, but keeps their handles. */
+        void clear() noexcept;
+
+        ThreadSnapshot(const ThreadSnapshot &) = delete;
+        ThreadSnapshot &operator=(const ThreadSnapshot &) = delete;
+
+    private:
+        friend class ThreadHandle;
+
+        /** Appends a thread whose port the snapshot takes ownership of. */
+        void append(ThreadHandle::NativeHandle handle);
+
+        std::vector<std::unique_ptr<ThreadHandle>> handles_;
+        std::size_t size_;
+        ThreadHandle current_;
     };
 
 } // namespace profiling
@@ -6,12 +6,19 @@
 
 #    include "SentryThreadHandle.hpp"
 
+#    include <cstddef>
 #    include <cstdint>
 #    include <memory>
 #    include <string>
+#    include <unordered_map>
 
 namespace sentry {
 namespace profiling {
+    // Apple's `libpthread` has a hard limit of 64 characters for thread names.
+    // See
+    // https://github.com/apple-oss-distributions/libpthread/blob/42d026df5b07825070f60134b980a1ec2552dfee/src/pthread.c#L1178
+    constexpr std::size_t kMaxThreadNameLength = 64;
+
     struct ThreadMetadata {
         thread::TIDType threadID;
         std::string name;
@@ -22,29 +29,66 @@ namespace profiling {
      * Caches thread and queue metadata (name, priority, etc.) for reuse while profiling,
      * since querying that metadata every time can be expensive.
      *
+     * Entries are evicted in generations: a caller that enumerates the process's threads starts a
+     * new generation with @c beginGeneration() , marks every thread it found with
+     * @c markThreadAlive() or looks up its metadata, and then calls @c evictStaleThreads() to
+     * drop the threads that have exited in the meantime. A cached thread's name is periodically
+     * compared to its current name, and its metadata is only queried again if it was renamed.
+     * Entries are keyed by port name, which the kernel reuses for new threads, so each lookup also
+     * checks that the port still names the thread the entry was cached for.
+     *
      * @note This class is not thread-safe.
      */
     class ThreadMetadataCache {
     public:
         /**
-         * Returns the metadata for the thread represented by the specified handle.
+         * Returns the metadata for the thread represented by the specified handle, and marks it
+         * as alive in the current generation.
          * @param thread The thread handle to retrieve metadata from.
          * @return @c ThreadMetadata with a non-zero threadID upon success, or a zero
          * threadID upon failure, which means that metadata cannot be collected
-         * for this thread.
+         * for this thread. The returned reference is only valid until the next call to this
+         * function.
+         */
+        const ThreadMetadata &metadataForThread(const ThreadHandle &thread);
+
+        /** Starts a new generation of threads. */
+        void beginGeneration() noexcept;
+
+        /** Marks a thread as alive in the current generation without looking up its metadata. */
+        void markThreadAlive(const ThreadHandle &thread) noexcept;
+
+        /**
+         * Evicts the metadata of the threads that weren't marked as alive in the current
+         * generation.
+         * @return The number of evicted threads.
          */
-        ThreadMetadata metadataForThread(const ThreadHandle &thread);
+        std::size_t evictStaleThreads();
+
+        /** @return The number of threads whose metadata is cached. */
+        std::size_t size() const noexcept;
 
         ThreadMetadataCache() = default;
         ThreadMetadataCache(const ThreadMetadataCache &) = delete;
         ThreadMetadataCache &operator=(const ThreadMetadataCache &) = delete;
 
     private:
-        struct ThreadHandleMetadataPair {
-            ThreadHandle::NativeHandle handle;
+        struct Entry {
             ThreadMetadata metadata;
+            /** The system-wide ID of the thread the metadata belongs to. */
+            std::uint64_t systemThreadID;
+            /** The last generation the thread was alive in. */
+            std::uint64_t generation;
+            /** The generation the thread's name was last queried in. */
+            std::uint64_t nameGeneration;
         };
-        std::vector<ThreadHandleMetadataPair> threadMetadataCache_;
+
+        /** Queries the thread's metadata; returns false if it shouldn't be cached. */
+        static bool queryMetadata(const ThreadHandle &thread, ThreadMetadata *metadata);
+
+        std::unordered_map<ThreadHandle::NativeHandle, Entry> entries_;
+        std::uint64_t generation_ = 0;
+        ThreadMetadata uncachedMetadata_;
     };
 
 } // namespace profiling
@@ -133,6 +133,26 @@ namespace profiling {
 #    endif
         }
 
+        /**
+         * Returns the contents of the stack pointer from the specified machine context.
+         *
+         * @param context Machine context to get the stack pointer value from.
+         * @return Contents of the stack pointer.
+         */
+        ALWAYS_INLINE std::uintptr_t
+        getStackPointer(const MachineContext *context) noexcept
+        {
+#    if CPU(ARM64) || CPU(ARM)
+            return arm_thread_state64_get_sp(context->__ss);
+#    elif CPU(X86_64)
+            return context->__ss.__rsp;
+#    elif CPU(X86)
+        return context->__ss.__esp;
+#    else
+#        error Unsupported architecture!
+#    endif
+        }
+
         /**
          * Returns the address of the instruction that comes before `address`.
          *
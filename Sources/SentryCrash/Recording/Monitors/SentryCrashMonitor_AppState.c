@@ -235,7 +235,7 @@ loadState(const char *const path)
         return false;
     }
 
-    SentryCrashJSONDecodeCallbacks callbacks;
+    SentryCrashJSONDecodeCallbacks callbacks = { 0 };
     callbacks.onBeginArray = onBeginArray;
     callbacks.onBeginObject = onBeginObject;
     callbacks.onBooleanElement = onBooleanElement;
@@ -31,11 +31,13 @@
 #    include "SentryCrashID.h"
 #    include "SentryCrashMachineContext.h"
 #    include "SentryCrashMonitorContext.h"
+#    include "SentryCrashStackCursor_Backtrace.h"
 #    include "SentryCrashStackCursor_SelfThread.h"
 #    include "SentryCrashThread.h"
 
 #    include "SentryAsyncSafeLog.h"
 
+#    include <atomic>
 #    include <cxxabi.h>
 #    include <dlfcn.h>
 #    include <exception>
@@ -49,6 +51,10 @@
 #    define STACKTRACE_BUFFER_LENGTH 30
 #    define DESCRIPTION_BUFFER_LENGTH 1000
 
+/** Must be a power of two. */
+#    define CLASSIFICATION_CACHE_SIZE 64
+#    define CLASSIFICATION_CACHE_MAX_PROBES 8
+
 // Compiler hints for "if" statements
 #    define likely_if(x) if (__builtin_expect(x, 1))
 #    define unlikely_if(x) if (__builtin_expect(x, 0))
@@ -73,6 +79,22 @@ static SentryCrash_MonitorContext g_monitorContext;
 // Find some other way to do thread local. Maybe storage with lookup by tid?
 static SentryCrashStackCursor g_stackCursor;
 
+/** The return addresses recorded at the last throw. They are only turned into a stack cursor when
+ * the exception terminates the app, which keeps the work done for every throw to a minimum.
+ */
+static uintptr_t g_throwBacktrace[SentryCrashSC_CONTEXT_SIZE];
+static int g_throwBacktraceLength = 0;
+static int g_throwBacktraceSkippedEntries = 0;
+
+/** Classes of thrown Objective-C objects, tagged with whether they are NSExceptions. Entries are
+ * only ever added, so a lookup is a single atomic load in the common case.
+ */
+static std::atomic<uintptr_t> g_classificationCache[CLASSIFICATION_CACHE_SIZE];
+
+static std::atomic<uint64_t> g_throwCount;
+static std::atomic<uint64_t> g_nsExceptionThrowCount;
+static std::atomic<uint64_t> g_capturedStackTraceCount;
+
 // ============================================================================
 #    pragma mark - Helpers -
 // ============================================================================
@@ -136,9 +158,9 @@ objcExceptionClass(const std::type_info *tinfo)
 }
 
 static bool
-isNSException(const std::type_info *tinfo)
+isNSExceptionClass(Class cls)
 {
-    for (Class currentClass = objcExceptionClass(tinfo); currentClass != Nil;
+    for (Class currentClass = cls; currentClass != Nil;
         currentClass = class_getSuperclass(currentClass)) {
         const char *className = class_getName(currentClass);
         if (className != NULL && strcmp(className, "NSException") == 0) {
@@ -148,6 +170,75 @@ isNSException(const std::type_info *tinfo)
     return false;
 }
 
+// Classes are at least pointer aligned, so the low bits of a cache entry hold the classification.
+static const uintptr_t kClassificationCached = 1;
+static const uintptr_t kClassificationNSException = 2;
+static const uintptr_t kClassificationMask = kClassificationCached | kClassificationNSException;
+
+/** Check if a class is NSException or one of its subclasses, using the classification cache.
+ * The ObjC runtime creates a new type_info for every throw, so the cache is keyed by the class of
+ * the thrown object instead. When the cache is full, the superclass chain is walked every time.
+ *
+ * @param cls The class of the thrown Objective-C object.
+ * @return true if cls is NSException or one of its subclasses.
+ */
+static bool
+isCachedNSExceptionClass(Class cls)
+{
+    const uintptr_t key = (uintptr_t)cls;
+    const uintptr_t hash = key >> 4;
+    for (uintptr_t probe = 0; probe < CLASSIFICATION_CACHE_MAX_PROBES; probe++) {
+        std::atomic<uintptr_t> &slot
+            = g_classificationCache[(hash + probe) & (CLASSIFICATION_CACHE_SIZE - 1)];
+        uintptr_t entry = slot.load(std::memory_order_acquire);
+        if (entry == 0) {
+            const bool isNSException = isNSExceptionClass(cls);
+            const uintptr_t newEntry
+                = key | kClassificationCached | (isNSException ? kClassificationNSException : 0);
+            // If another thread took the slot meanwhile, it either cached the same class or the
+            // probing goes on with the next slot.
+            if (slot.compare_exchange_strong(entry, newEntry, std::memory_order_release,
+                    std::memory_order_acquire)
+                || (entry & ~kClassificationMask) == key) {
+                return isNSException;
+            }
+            continue;
+        }
+        if ((entry & ~kClassificationMask) == key) {
+            return (entry & kClassificationNSException) != 0;
+        }
+    }
+    return isNSExceptionClass(cls);
+}
+
+static bool
+isNSException(const std::type_info *tinfo)
+{
+    Class cls = objcExceptionClass(tinfo);
+    return cls != Nil && isCachedNSExceptionClass(cls);
+}
+
+/** Record the return addresses of the current thread for the stack cursor of a later crash.
+ * Always inlined, so that the caller's frame is the first one after the recording itself.
+ *
+ * @param skipEntries The number of entries to skip, not counting the recording itself.
+ */
+static ALWAYS_INLINE void
+recordThrowBacktrace(int skipEntries)
+{
+    g_throwBacktraceLength
+        = sentrycrashsc_backtraceSelfThread(g_throwBacktrace, SentryCrashSC_CONTEXT_SIZE);
+    g_throwBacktraceSkippedEntries = skipEntries + 1;
+    g_capturedStackTraceCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void
+initStackCursorFromThrowBacktrace(SentryCrashStackCursor *cursor)
+{
+    sentrycrashsc_initWithBacktrace(
+        cursor, g_throwBacktrace, g_throwBacktraceLength, g_throwBacktraceSkippedEntries);
+}
+
 // ============================================================================
 #    pragma mark - Callbacks -
 // ============================================================================
@@ -156,14 +247,16 @@ static NEVER_INLINE void
 captureStackTrace(void *, std::type_info *tinfo, void (*)(void *)) KEEP_FUNCTION_IN_STACKTRACE
 {
     SENTRY_ASYNC_SAFE_LOG_TRACE("Entering captureStackTrace");
+    g_throwCount.fetch_add(1, std::memory_order_relaxed);
 
     // We handle NSException and subclasses in SentryCrashMonitor_NSException.
     if (isNSException(tinfo)) {
+        g_nsExceptionThrowCount.fetch_add(1, std::memory_order_relaxed);
         return;
     }
 
     if (g_captureNextStackTrace) {
-        sentrycrashsc_initSelfThread(&g_stackCursor, 2);
+        recordThrowBacktrace(2);
     }
     THWART_TAIL_CALL_OPTIMISATION
 }
@@ -206,9 +299,10 @@ void
 __sentry_cxa_rethrow()
 {
     SENTRY_ASYNC_SAFE_LOG_DEBUG("Entering __sentry_cxa_rethrow");
+    g_throwCount.fetch_add(1, std::memory_order_relaxed);
 
     if (g_captureNextStackTrace) {
-        sentrycrashsc_initSelfThread(&g_stackCursor, 1);
+        recordThrowBacktrace(1);
     }
 
     static cxa_rethrow_type orig_cxa_rethrow = NULL;
@@ -321,6 +415,10 @@ CPPExceptionTerminate(void)
             g_captureNextStackTrace = g_isEnabled;
         }
 
+        if (currException != NULL) {
+            initStackCursorFromThrowBacktrace(&g_stackCursor);
+        }
+
         // TODO: Should this be done here? Maybe better in the exception
         // handler?
         SentryCrashMC_NEW_CONTEXT(machineContext);
@@ -368,6 +466,10 @@ setEnabled(bool isEnabled)
         if (isEnabled) {
             initialize();
 
+            g_throwCount.store(0, std::memory_order_relaxed);
+            g_nsExceptionThrowCount.store(0, std::memory_order_relaxed);
+            g_capturedStackTraceCount.store(0, std::memory_order_relaxed);
+
             sentrycrashid_generate(g_eventID);
             g_originalTerminateHandler = std::set_terminate(CPPExceptionTerminate);
         } else {
@@ -379,6 +481,7 @@ setEnabled(bool isEnabled)
 
             // Reset the stack cursor to the default state
             sentrycrashsc_initCursor(&g_stackCursor, NULL, NULL);
+            g_throwBacktraceLength = 0;
         }
         g_captureNextStackTrace = isEnabled;
     }
@@ -390,10 +493,22 @@ sentrycrashcm_cppexception_enable_swap_cxa_throw(void)
     sentrycrashct_swap_cxa_throw(captureStackTrace);
 }
 
+SentryCrashCPPExceptionThrowStatistics
+sentrycrashcm_cppexception_getThrowStatistics(void)
+{
+    SentryCrashCPPExceptionThrowStatistics statistics;
+    statistics.throwCount = g_throwCount.load(std::memory_order_relaxed);
+    statistics.nsExceptionThrowCount = g_nsExceptionThrowCount.load(std::memory_order_relaxed);
+    statistics.capturedStackTraceCount = g_capturedStackTraceCount.load(std::memory_order_relaxed);
+    return statistics;
+}
+
 SentryCrashStackCursor
 sentrycrashcm_cppexception_getStackCursor(void)
 {
-    return g_stackCursor;
+    SentryCrashStackCursor stackCursor;
+    initStackCursorFromThrowBacktrace(&stackCursor);
+    return stackCursor;
 }
 
 static bool
@@ -84,6 +84,8 @@
 @synthesize doNotIntrospectClasses = _doNotIntrospectClasses;
 @synthesize demangleLanguages = _demangleLanguages;
 @synthesize maxReportCount = _maxReportCount;
+@synthesize maxReportSize = _maxReportSize;
+@synthesize maxReportStoreSize = _maxReportStoreSize;
 @synthesize uncaughtExceptionHandler = _uncaughtExceptionHandler;
 
 // ============================================================================
@@ -178,6 +180,18 @@
     sentrycrash_setMaxReportCount(maxReportCount);
 }
 
+- (void)setMaxReportSize:(int64_t)maxReportSize
+{
+    _maxReportSize = maxReportSize;
+    sentrycrash_setMaxReportSize(maxReportSize);
+}
+
+- (void)setMaxReportStoreSize:(int64_t)maxReportStoreSize
+{
+    _maxReportStoreSize = maxReportStoreSize;
+    sentrycrash_setMaxReportStoreSize(maxReportStoreSize);
+}
+
 - (NSDictionary *)systemInfo
 {
     SentryCrash_MonitorContext fakeEvent = { 0 };
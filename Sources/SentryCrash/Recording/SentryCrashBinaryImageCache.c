@@ -78,6 +78,49 @@ logImageLimitReached(SentryCrashBinaryImageCacheState *cache)
     }
 }
 
+/**
+ * Publishes a new sorted index of the ready images, inserting the image in @c addedSlot unless it's
+ * UINT32_MAX. Images that were removed meanwhile are dropped from the index.
+ *
+ * Writers are serialized with a spin lock, which is fine because they only run in dyld callbacks.
+ * Readers never take the lock.
+ */
+static void
+publishIndex(SentryCrashBinaryImageCacheState *cache, uint32_t addedSlot)
+{
+    while (atomic_flag_test_and_set_explicit(&cache->indexWriterLock, memory_order_acquire)) { }
+
+    uint32_t active = atomic_load_explicit(&cache->activeIndex, memory_order_seq_cst);
+    uint32_t next = active ^ 1;
+    // Wait for readers that picked the inactive index before the last swap.
+    while (atomic_load_explicit(&cache->indexReaders[next], memory_order_seq_cst) != 0) { }
+
+    const SentryCrashBinaryImageIndex *source = &cache->indexes[active];
+    SentryCrashBinaryImageIndex *destination = &cache->indexes[next];
+    uint64_t addedAddress = addedSlot == UINT32_MAX ? 0 : cache->images[addedSlot].image.address;
+    bool added = addedSlot == UINT32_MAX;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < source->count; i++) {
+        uint16_t slot = source->slots[i];
+        PublishedBinaryImage *entry = &cache->images[slot];
+        if (atomic_load_explicit(&entry->state, memory_order_acquire) != IMAGE_READY) {
+            continue;
+        }
+        if (!added && addedAddress < entry->image.address) {
+            destination->slots[count++] = (uint16_t)addedSlot;
+            added = true;
+        }
+        destination->slots[count++] = slot;
+    }
+    if (!added) {
+        destination->slots[count++] = (uint16_t)addedSlot;
+    }
+    destination->count = count;
+
+    atomic_store_explicit(&cache->activeIndex, next, memory_order_seq_cst);
+    atomic_flag_clear_explicit(&cache->indexWriterLock, memory_order_release);
+}
+
 static void
 addImage(const struct mach_header *header)
 {
@@ -110,6 +153,7 @@ addImage(const struct mach_header *header)
         = atomic_load_explicit(&cache->addedCallback, memory_order_acquire);
 
     atomic_store_explicit(&entry->state, IMAGE_READY, memory_order_release);
+    publishIndex(cache, nextIndex);
 
     if (callback != NULL) {
         callback(&entry->image);
@@ -138,6 +182,7 @@ dyldRemoveImageCallback(const struct mach_header *mh, intptr_t slide)
         }
         if (src->image.address == (uintptr_t)mh) {
             atomic_store_explicit(&src->state, IMAGE_REMOVED, memory_order_release);
+            publishIndex(cache, UINT32_MAX);
             if (callback != NULL) {
                 callback(&src->image);
             }
@@ -169,6 +214,49 @@ sentrycrashbic_iterateOverImages(sentrycrashbic_imageIteratorCallback callback,
     }
 }
 
+bool
+sentrycrashbic_imageForAddress(uint64_t address, SentryCrashBinaryImage *image)
+{
+    SentryCrashBinaryImageCacheState *cache = currentCache();
+
+    // Announce the read before using the index, and retry if the writer swapped the index in
+    // between, because it may already be preparing the next index in it.
+    uint32_t active;
+    for (;;) {
+        active = atomic_load_explicit(&cache->activeIndex, memory_order_seq_cst);
+        atomic_fetch_add_explicit(&cache->indexReaders[active], 1, memory_order_seq_cst);
+        if (atomic_load_explicit(&cache->activeIndex, memory_order_seq_cst) == active) {
+            break;
+        }
+        atomic_fetch_sub_explicit(&cache->indexReaders[active], 1, memory_order_release);
+    }
+
+    const SentryCrashBinaryImageIndex *index = &cache->indexes[active];
+    uint32_t low = 0;
+    uint32_t high = index->count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (cache->images[index->slots[mid]].image.address <= address) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    bool found = false;
+    if (low > 0) {
+        PublishedBinaryImage *entry = &cache->images[index->slots[low - 1]];
+        if (atomic_load_explicit(&entry->state, memory_order_acquire) == IMAGE_READY
+            && address - entry->image.address < entry->image.size) {
+            *image = entry->image;
+            found = true;
+        }
+    }
+
+    atomic_fetch_sub_explicit(&cache->indexReaders[active], 1, memory_order_release);
+    return found;
+}
+
 /** Check if dyld should be added to the binary image cache.
  *
  * Since Apple no longer includes dyld in the images listed by _dyld_image_count and related
@@ -209,6 +297,7 @@ addDyldImage(void)
     }
 
     atomic_store_explicit(&entry->state, IMAGE_READY, memory_order_release);
+    publishIndex(cache, idx);
 
     sentrycrashbic_cacheChangeCallback callback
         = atomic_load_explicit(&cache->addedCallback, memory_order_acquire);
@@ -17,9 +17,26 @@ typedef struct {
     SentryCrashBinaryImage image;
 } PublishedBinaryImage;
 
+/**
+ * The published images sorted by address, as indices into the images of the cache. This is an
+ * additional index for lookups from C, not a replacement for the copy kept by the Swift
+ * SentryBinaryImageCache. The cache holds two of them, 16 KB in total.
+ */
+typedef struct {
+    uint32_t count;
+    uint16_t slots[SENTRYCRASHBIC_MAX_DYLD_IMAGES];
+} SentryCrashBinaryImageIndex;
+
 typedef struct SentryCrashBinaryImageCacheState {
     PublishedBinaryImage images[SENTRYCRASHBIC_MAX_DYLD_IMAGES];
     _Atomic(uint32_t) nextIndex;
+    // Readers use indexes[activeIndex] while the writer prepares the other one, and only swaps it
+    // in once it's complete. indexReaders counts the readers of each index, so the writer doesn't
+    // overwrite an index that is still being read.
+    SentryCrashBinaryImageIndex indexes[2];
+    _Atomic(uint32_t) activeIndex;
+    _Atomic(uint32_t) indexReaders[2];
+    atomic_flag indexWriterLock;
     _Atomic(sentrycrashbic_cacheChangeCallback) addedCallback;
     _Atomic(sentrycrashbic_cacheChangeCallback) removedCallback;
     _Atomic(bool) trackingStarted;
@@ -220,6 +220,18 @@ sentrycrash_setMaxReportCount(int maxReportCount)
     sentrycrashcrs_setMaxReportCount(maxReportCount);
 }
 
+void
+sentrycrash_setMaxReportStoreSize(int64_t maxReportStoreSize)
+{
+    sentrycrashcrs_setMaxReportStoreSize(maxReportStoreSize);
+}
+
+void
+sentrycrash_setMaxReportSize(int64_t maxReportSize)
+{
+    sentrycrashreport_setMaxReportSize(maxReportSize);
+}
+
 void
 sentrycrash_setSaveScreenshots(void (*callback)(const char *))
 {
@@ -282,18 +294,20 @@ sentrycrash_readReport(int64_t reportID)
         return NULL;
     }
 
-    char *rawReport = sentrycrashcrs_readReport(reportID);
-    if (rawReport == NULL) {
+    // The raw report is only decoded once, so map it rather than copying it into memory.
+    const char *rawReport;
+    int rawReportLength;
+    if (!sentrycrashcrs_mapReport(reportID, &rawReport, &rawReportLength)) {
         SENTRY_ASYNC_SAFE_LOG_ERROR("Failed to load report ID %" PRIx64, reportID);
         return NULL;
     }
 
-    char *fixedReport = sentrycrashcrf_fixupCrashReport(rawReport);
+    char *fixedReport = sentrycrashcrf_fixupCrashReportWithLength(rawReport, rawReportLength);
     if (fixedReport == NULL) {
         SENTRY_ASYNC_SAFE_LOG_ERROR("Failed to fixup report ID %" PRIx64, reportID);
     }
 
-    free(rawReport);
+    sentrycrashfu_unmapFile(rawReport, rawReportLength);
     return fixedReport;
 }
 
@@ -38,15 +38,41 @@
 #    include <string.h>
 #    include <unistd.h>
 
+/** The maximum length of a thread name including the terminator, see MAXTHREADNAMESIZE. */
+#    define MAX_THREAD_NAME_LENGTH 64
+
+/** Every this many updates, the names of all threads are queried again to pick up threads that
+ *  were renamed. Other updates only query the threads that weren't in the previous cache or had
+ *  no name in it.
+ */
+#    define FULL_REFRESH_INTERVAL 5
+
 // MARK: - Types
 
+/** A snapshot of the threads and their names. The arrays and the names are stored in the same
+ *  allocation as the struct itself.
+ */
 typedef struct {
     SentryCrashThread *machThreads;
     SentryCrashThread *pthreads;
     const char **threadNames;
     int count;
+    /** The active or frozen cache holds one reference, and the background thread one to the
+     *  cache it built last, so it can build the next one from it.
+     */
+    atomic_int referenceCount;
 } SentryCrashThreadCacheData;
 
+/** Per-thread working memory for building a cache, reused across updates to avoid allocating
+ *  on every update. Only used by the thread updating the cache.
+ */
+typedef struct {
+    SentryCrashThread *pthreads;
+    const char **threadNames;
+    char *nameBuffers;
+    mach_msg_type_number_t capacity;
+} SentryCrashThreadCacheScratch;
+
 // MARK: - Globals
 
 static atomic_int g_pollingIntervalInSeconds;
@@ -74,85 +100,155 @@ static _Atomic(SentryCrashThreadCacheData *) g_activeCache;
  */
 static _Atomic(SentryCrashThreadCacheData *) g_frozenCache;
 
+/** The cache built by the last update, which the next update copies unchanged threads from.
+ *  Only accessed by the thread updating the cache.
+ */
+static SentryCrashThreadCacheData *g_lastBuiltCache;
+static int g_updatesSinceFullRefresh;
+static SentryCrashThreadCacheScratch g_scratch;
+
 // MARK: - Private Helpers
 
 static void
-freeCache(SentryCrashThreadCacheData *cache)
+releaseCache(SentryCrashThreadCacheData *cache)
 {
-    if (cache == NULL) {
-        return;
+    if (cache != NULL && atomic_fetch_sub(&cache->referenceCount, 1) == 1) {
+        free(cache);
     }
+}
 
-    if (cache->threadNames != NULL) {
-        for (int i = 0; i < cache->count; i++) {
-            if (cache->threadNames[i] != NULL) {
-                free((void *)cache->threadNames[i]);
-            }
-        }
-        free(cache->threadNames);
-    }
+static void
+freeScratch(void)
+{
+    free(g_scratch.pthreads);
+    free(g_scratch.threadNames);
+    free(g_scratch.nameBuffers);
+    memset(&g_scratch, 0, sizeof(g_scratch));
+}
 
-    if (cache->machThreads != NULL) {
-        free(cache->machThreads);
+static bool
+ensureScratchCapacity(mach_msg_type_number_t capacity)
+{
+    if (g_scratch.capacity >= capacity) {
+        return true;
     }
-
-    if (cache->pthreads != NULL) {
-        free(cache->pthreads);
+    freeScratch();
+    g_scratch.pthreads = malloc(sizeof(*g_scratch.pthreads) * capacity);
+    g_scratch.threadNames = malloc(sizeof(*g_scratch.threadNames) * capacity);
+    g_scratch.nameBuffers = malloc((size_t)MAX_THREAD_NAME_LENGTH * capacity);
+    if (g_scratch.pthreads == NULL || g_scratch.threadNames == NULL
+        || g_scratch.nameBuffers == NULL) {
+        freeScratch();
+        return false;
     }
+    g_scratch.capacity = capacity;
+    return true;
+}
 
-    free(cache);
+/** Find a thread in a cache. task_threads returns threads in a stable order, so the search
+ *  starts right after the previous match and usually succeeds on the first comparison.
+ *
+ * @param cache The cache to search.
+ * @param thread The thread to find.
+ * @param hint Where to start searching; updated to right after the match.
+ * @return The index of the thread in the cache, or -1 if it isn't in the cache.
+ */
+static int
+findThread(const SentryCrashThreadCacheData *cache, SentryCrashThread thread, int *hint)
+{
+    for (int i = 0; i < cache->count; i++) {
+        int index = (*hint + i) % cache->count;
+        if (cache->machThreads[index] == thread) {
+            *hint = index + 1;
+            return index;
+        }
+    }
+    return -1;
 }
 
+/** Create a snapshot of the current threads.
+ *
+ * @param previous A previous snapshot to copy the threads from that are still running, instead
+ *                 of querying them again, or NULL to query all threads.
+ * @return The new snapshot, with a reference count of 1, or NULL if it couldn't be created.
+ */
 static SentryCrashThreadCacheData *
-createCache(void)
+createCache(const SentryCrashThreadCacheData *previous)
 {
     const task_t thisTask = mach_task_self();
     mach_msg_type_number_t threadCount;
     thread_act_array_t threads;
     kern_return_t kr;
+    SentryCrashThreadCacheData *cache = NULL;
 
     if ((kr = task_threads(thisTask, &threads, &threadCount)) != KERN_SUCCESS) {
         SENTRY_ASYNC_SAFE_LOG_ERROR("task_threads: %s", mach_error_string(kr));
         return NULL;
     }
 
+    if (!ensureScratchCapacity(threadCount)) {
+        SENTRY_ASYNC_SAFE_LOG_ERROR("Failed to allocate thread cache scratch memory");
+        goto cleanup_threads;
+    }
+
+    size_t namesLength = 0;
+    int hint = 0;
+    for (mach_msg_type_number_t i = 0; i < threadCount; i++) {
+        const SentryCrashThread thread = (SentryCrashThread)threads[i];
+        const int previousIndex = previous != NULL ? findThread(previous, thread, &hint) : -1;
+        // Threads without a name are queried again, as they often name themselves only after
+        // they started running.
+        if (previousIndex >= 0 && previous->threadNames[previousIndex] != NULL) {
+            g_scratch.pthreads[i] = previous->pthreads[previousIndex];
+            g_scratch.threadNames[i] = previous->threadNames[previousIndex];
+        } else {
+            char *buffer = &g_scratch.nameBuffers[(size_t)i * MAX_THREAD_NAME_LENGTH];
+            pthread_t pthread = pthread_from_mach_thread_np(threads[i]);
+            g_scratch.pthreads[i] = (SentryCrashThread)pthread;
+            g_scratch.threadNames[i] = NULL;
+            if (pthread != 0 && pthread_getname_np(pthread, buffer, MAX_THREAD_NAME_LENGTH) == 0
+                && buffer[0] != 0) {
+                g_scratch.threadNames[i] = buffer;
+            }
+        }
+        if (g_scratch.threadNames[i] != NULL) {
+            namesLength += strlen(g_scratch.threadNames[i]) + 1;
+        }
+    }
+
+    // The calloc below cannot overflow: threadCount is a mach_msg_type_number_t (uint32_t)
+    // returned by task_threads(), each thread takes 24 bytes in the arrays, and a name at most
+    // MAX_THREAD_NAME_LENGTH bytes. The total fits in size_t on every supported (64-bit) Apple
+    // platform.
+    const size_t threadsSize = sizeof(SentryCrashThread) * threadCount;
+    const size_t namesOffset = sizeof(*cache) + 2 * threadsSize + sizeof(char *) * threadCount;
     // calloc here is intentional and must not be replaced with malloc: every field of
     // SentryCrashThreadCacheData (counts, pointers, name strings) is later read on the crash
     // path before being explicitly populated, so leaving uninitialized memory would surface as
     // a use-of-uninitialized-value during a crash report.
-    SentryCrashThreadCacheData *cache = calloc(1, sizeof(*cache));
-    if (cache == NULL) {
+    uint8_t *block = calloc(1, namesOffset + namesLength);
+    if (block == NULL) {
         SENTRY_ASYNC_SAFE_LOG_ERROR("Failed to allocate thread cache");
         goto cleanup_threads;
     }
 
+    cache = (SentryCrashThreadCacheData *)block;
     cache->count = (int)threadCount;
-    // The calloc(threadCount, sizeof(...)) calls below cannot overflow: threadCount is a
-    // mach_msg_type_number_t (uint32_t, max 2^32-1) returned by task_threads(), and the largest
-    // element type here is sizeof(pthread_t) = 8 bytes. The product fits in size_t on every
-    // supported (64-bit) Apple platform.
-    cache->machThreads = calloc(threadCount, sizeof(*cache->machThreads));
-    cache->pthreads = calloc(threadCount, sizeof(*cache->pthreads));
-    cache->threadNames = calloc(threadCount, sizeof(*cache->threadNames));
-
-    if (cache->machThreads == NULL || cache->pthreads == NULL || cache->threadNames == NULL) {
-        SENTRY_ASYNC_SAFE_LOG_ERROR("Failed to allocate thread cache arrays");
-        freeCache(cache);
-        cache = NULL;
-        goto cleanup_threads;
-    }
+    cache->machThreads = (SentryCrashThread *)(block + sizeof(*cache));
+    cache->pthreads = (SentryCrashThread *)(block + sizeof(*cache) + threadsSize);
+    cache->threadNames = (const char **)(block + sizeof(*cache) + 2 * threadsSize);
+    atomic_init(&cache->referenceCount, 1);
 
+    char *names = (char *)(block + namesOffset);
     for (mach_msg_type_number_t i = 0; i < threadCount; i++) {
-        char buffer[1000];
-        thread_t thread = threads[i];
-        pthread_t pthread = pthread_from_mach_thread_np(thread);
-
-        cache->machThreads[i] = (SentryCrashThread)thread;
-        cache->pthreads[i] = (SentryCrashThread)pthread;
-
-        if (pthread != 0 && pthread_getname_np(pthread, buffer, sizeof(buffer)) == 0
-            && buffer[0] != 0) {
-            cache->threadNames[i] = strdup(buffer);
+        cache->machThreads[i] = (SentryCrashThread)threads[i];
+        cache->pthreads[i] = g_scratch.pthreads[i];
+        const char *name = g_scratch.threadNames[i];
+        if (name != NULL) {
+            const size_t length = strlen(name) + 1;
+            memcpy(names, name, length);
+            cache->threadNames[i] = names;
+            names += length;
         }
     }
 
@@ -165,6 +261,30 @@ cleanup_threads:
     return cache;
 }
 
+/** Create the next snapshot from the last one the background thread built, and keep a reference
+ *  to it for the next update.
+ *
+ * @return The new snapshot, with a reference for the caller, or NULL if it couldn't be created.
+ */
+static SentryCrashThreadCacheData *
+createNextCache(void)
+{
+    bool isFullRefresh = g_lastBuiltCache == NULL || atomic_load(&g_quickPollCount) > 0
+        || ++g_updatesSinceFullRefresh >= FULL_REFRESH_INTERVAL;
+    SentryCrashThreadCacheData *cache = createCache(isFullRefresh ? NULL : g_lastBuiltCache);
+    if (cache == NULL) {
+        return NULL;
+    }
+    if (isFullRefresh) {
+        g_updatesSinceFullRefresh = 0;
+    }
+
+    atomic_fetch_add(&cache->referenceCount, 1);
+    releaseCache(g_lastBuiltCache);
+    g_lastBuiltCache = cache;
+    return cache;
+}
+
 /** Atomically replace the active cache with a freshly created snapshot.
  *  If the cache is currently frozen (acquired by the crash handler), this
  *  update is skipped entirely — the crash handler owns the pointer and we
@@ -176,7 +296,7 @@ updateCache(void)
     // Build new cache first so g_activeCache keeps the old (valid) pointer
     // during construction. If a crash occurs mid-build, freeze() will
     // still find usable data instead of NULL.
-    SentryCrashThreadCacheData *newCache = createCache();
+    SentryCrashThreadCacheData *newCache = createNextCache();
     if (newCache == NULL) {
         // Creation failed; keep the old cache so readers still work.
         return;
@@ -188,7 +308,7 @@ updateCache(void)
         // Disambiguate NULL g_activeCache using g_cacheEverCreated.
         if (atomic_load(&g_cacheEverCreated)) {
             // Case 1: Frozen by crash handler, skip this update cycle.
-            freeCache(newCache);
+            releaseCache(newCache);
             return;
         }
         // Case 2: No cache exists yet. Try to install the new one.
@@ -197,7 +317,7 @@ updateCache(void)
             atomic_store(&g_cacheEverCreated, true);
         } else {
             // Case 2b: Another thread installed a cache concurrently. Discard ours.
-            freeCache(newCache);
+            releaseCache(newCache);
         }
         return;
     }
@@ -205,10 +325,10 @@ updateCache(void)
     if (atomic_compare_exchange_strong(&g_activeCache, &expected, newCache)) {
         // Case A: Successfully swapped old cache for new one.
         atomic_store(&g_cacheEverCreated, true);
-        freeCache(expected);
+        releaseCache(expected);
     } else {
         // Case B: Cache was acquired by freeze() between our load and CAS.
-        freeCache(newCache);
+        releaseCache(newCache);
     }
 }
 
@@ -248,7 +368,7 @@ sentrycrashccd_init(int pollingIntervalInSeconds)
     atomic_store(&g_quickPollCount, 4);
 
     // Create initial cache
-    SentryCrashThreadCacheData *initialCache = createCache();
+    SentryCrashThreadCacheData *initialCache = createNextCache();
     atomic_store(&g_activeCache, initialCache);
     if (initialCache != NULL) {
         atomic_store(&g_cacheEverCreated, true);
@@ -265,7 +385,10 @@ sentrycrashccd_init(int pollingIntervalInSeconds)
 
         // Cleanup on thread creation failure.
         SentryCrashThreadCacheData *leakedCache = atomic_exchange(&g_activeCache, NULL);
-        freeCache(leakedCache);
+        releaseCache(leakedCache);
+        releaseCache(g_lastBuiltCache);
+        g_lastBuiltCache = NULL;
+        freeScratch();
         atomic_store(&g_cacheEverCreated, false);
         atomic_store(&g_hasThreadStarted, false);
     }
@@ -295,7 +418,7 @@ sentrycrashccd_unfreeze(void)
         SentryCrashThreadCacheData *expected = NULL;
         if (!atomic_compare_exchange_strong(&g_activeCache, &expected, cache)) {
             // updateCache() already installed a fresh cache; discard the stale one.
-            freeCache(cache);
+            releaseCache(cache);
         }
     }
 }
@@ -338,10 +461,14 @@ sentrycrashccd_close(void)
         // Free both caches. freeze() atomically moves the pointer from
         // g_activeCache to g_frozenCache, so they never alias each other.
         SentryCrashThreadCacheData *active = atomic_exchange(&g_activeCache, NULL);
-        freeCache(active);
+        releaseCache(active);
 
         SentryCrashThreadCacheData *frozen = atomic_exchange(&g_frozenCache, NULL);
-        freeCache(frozen);
+        releaseCache(frozen);
+
+        releaseCache(g_lastBuiltCache);
+        g_lastBuiltCache = NULL;
+        freeScratch();
 
         atomic_store(&g_cacheEverCreated, false);
     }
@@ -361,7 +488,7 @@ void
 sentrycrashccd_test_clearActiveCache(void)
 {
     SentryCrashThreadCacheData *cache = atomic_exchange(&g_activeCache, NULL);
-    freeCache(cache);
+    releaseCache(cache);
     // Reset so updateCache() sees "never created" instead of "frozen".
     atomic_store(&g_cacheEverCreated, false);
 }
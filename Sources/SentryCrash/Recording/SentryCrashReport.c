@@ -37,6 +37,7 @@
 #    include "SentryCrashJSONCodec.h"
 #    include "SentryCrashMach.h"
 #    include "SentryCrashMemory.h"
+#    include "SentryCrashMonitor_CPPException.h"
 #    include "SentryCrashObjC.h"
 #    include "SentryCrashReportFields.h"
 #    include "SentryCrashReportVersion.h"
@@ -54,7 +55,9 @@
 
 #    include <errno.h>
 #    include <fcntl.h>
+#    include <limits.h>
 #    include <pthread.h>
+#    include <stdatomic.h>
 #    include <stdio.h>
 #    include <stdlib.h>
 #    include <string.h>
@@ -81,6 +84,28 @@
 /** The minimum length for a valid string. */
 #    define kMinStringLength 4
 
+/** The size of the buffer reports are written through. Large enough to write most sections of a
+ * report with a single system call. */
+#    define kReportWriteBufferSize (64 * 1024)
+
+/** The size of the buffer used when the report write buffer is already in use. */
+#    define kFallbackWriteBufferSize 1024
+
+/** Rough size of a binary image in the report, used to reserve room for the images referenced by
+ * the crashed thread while less important sections are written. */
+#    define kEstimatedBinaryImageSize 384
+
+/** Rough size of a thread in the report, used to reserve room for the other threads while the
+ * memory introspection of the crashed thread is written. */
+#    define kEstimatedThreadSize 2048
+
+/** Room kept for the report writer stats, the truncation object and the closing brackets, which
+ * are written after all sections that can be left out. */
+#    define kReportTrailerSize 1024
+
+/** How many images referenced by the crashed thread are kept when the report size is limited. */
+#    define kMaxReferencedImages 128
+
 // ============================================================================
 #    pragma mark - JSON Encoding -
 // ============================================================================
@@ -111,6 +136,36 @@ typedef struct {
 static const char *g_userInfoJSON;
 static SentryCrash_IntrospectionRules g_introspectionRules;
 
+/** The size a standard report should not exceed, or 0 for no limit. */
+static int64_t g_maxReportSize;
+
+/** Tracks the size of a standard report against its limit, and what was left out to stay below it.
+ */
+typedef struct {
+    int64_t maxSize;
+    const SentryCrashBufferedWriter *bufferedWriter;
+
+    /** Start addresses of the images referenced by the backtrace of the crashed thread. */
+    uint64_t referencedImages[kMaxReferencedImages];
+    int referencedImageCount;
+    int referencedImagesWritten;
+
+    /** Size of the scope and user info, without the breadcrumbs. */
+    int64_t scopeSize;
+    int64_t breadcrumbsSize;
+
+    bool omittedNotableAddresses;
+    int omittedThreads;
+    bool omittedBreadcrumbs;
+    bool omittedScope;
+    int omittedBinaryImages;
+    bool omittedConsoleLog;
+} SentryCrashReportBudget;
+
+/** Preallocated, because memory can't be allocated safely while handling a crash. */
+static char g_reportWriteBuffer[kReportWriteBufferSize];
+static atomic_flag g_reportWriteBufferInUse = ATOMIC_FLAG_INIT;
+
 #    pragma mark Callbacks
 
 static void
@@ -317,6 +372,35 @@ addJSONData(const char *restrict const data, const int length, void *restrict us
     return success ? SentryCrashJSON_OK : SentryCrashJSON_ERROR_CANNOT_ADD_DATA;
 }
 
+/** Get the buffer to write a report through. A report can be written while another one is
+ * still being written, for example when crashing while writing a report, in which case the
+ * fallback buffer is used.
+ *
+ * @param fallbackBuffer The buffer to use if the report write buffer is in use.
+ *
+ * @param length Place to store the length of the returned buffer.
+ *
+ * @return The buffer, which must be released with releaseWriteBuffer().
+ */
+static char *
+acquireWriteBuffer(char *fallbackBuffer, int *length)
+{
+    if (atomic_flag_test_and_set_explicit(&g_reportWriteBufferInUse, memory_order_acquire)) {
+        *length = kFallbackWriteBufferSize;
+        return fallbackBuffer;
+    }
+    *length = kReportWriteBufferSize;
+    return g_reportWriteBuffer;
+}
+
+static void
+releaseWriteBuffer(const char *buffer)
+{
+    if (buffer == g_reportWriteBuffer) {
+        atomic_flag_clear_explicit(&g_reportWriteBufferInUse, memory_order_release);
+    }
+}
+
 // ============================================================================
 #    pragma mark - Utility -
 // ============================================================================
@@ -375,6 +459,109 @@ getStackCursor(const SentryCrash_MonitorContext *const crash,
     return true;
 }
 
+// ============================================================================
+#    pragma mark - Size Budget -
+// ============================================================================
+
+/** Check if a section fits in the size budget of the report.
+ *
+ * @param budget The budget of the report.
+ *
+ * @param reserved The number of bytes to keep free for more important sections written later.
+ *
+ * @return True if the report has no size limit, or is still below it with the reserved bytes.
+ */
+static bool
+fitsInBudget(const SentryCrashReportBudget *const budget, const int64_t reserved)
+{
+    if (budget->maxSize <= 0) {
+        return true;
+    }
+    const SentryCrashBufferedWriter *const bufferedWriter = budget->bufferedWriter;
+    return bufferedWriter->bytesWritten + bufferedWriter->position + reserved + kReportTrailerSize
+        < budget->maxSize;
+}
+
+static bool
+isReferencedImage(const SentryCrashReportBudget *const budget, const uint64_t imageAddress)
+{
+    for (int i = 0; i < budget->referencedImageCount; i++) {
+        if (budget->referencedImages[i] == imageAddress) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @return The number of bytes to reserve for the referenced images not written yet. */
+static int64_t
+referencedImagesReserve(const SentryCrashReportBudget *const budget)
+{
+    return (int64_t)(budget->referencedImageCount - budget->referencedImagesWritten)
+        * kEstimatedBinaryImageSize;
+}
+
+static int64_t
+lengthOfString(const char *const string)
+{
+    return string == NULL ? 0 : (int64_t)strlen(string);
+}
+
+/** Prepare the size budget of a standard report.
+ *
+ * Finds the images referenced by the backtrace of the crashed thread, which are the most important
+ * ones to symbolicate the crash, and measures the scope, so that room can be reserved for them
+ * while the sections written before them are.
+ *
+ * @param budget The budget to prepare.
+ *
+ * @param crash The crash handler context.
+ *
+ * @param bufferedWriter The buffered writer the report is written with.
+ */
+static void
+prepareBudget(SentryCrashReportBudget *const budget, const SentryCrash_MonitorContext *const crash,
+    const SentryCrashBufferedWriter *const bufferedWriter)
+{
+    memset(budget, 0, sizeof(*budget));
+    budget->maxSize = g_maxReportSize;
+    budget->bufferedWriter = bufferedWriter;
+    if (budget->maxSize <= 0) {
+        return;
+    }
+
+    SentryCrashStackCursor stackCursor;
+    SentryCrashBinaryImage image;
+    if (crash->offendingMachineContext != NULL
+        && getStackCursor(crash, crash->offendingMachineContext, &stackCursor)) {
+        while (budget->referencedImageCount < kMaxReferencedImages
+            && stackCursor.advanceCursor(&stackCursor)) {
+            if (sentrycrashbic_imageForAddress(stackCursor.stackEntry.address, &image)
+                && !isReferencedImage(budget, image.address)) {
+                budget->referencedImages[budget->referencedImageCount++] = image.address;
+            }
+        }
+    }
+
+    SentryCrashScope *scope = sentrycrash_scopesync_getScope();
+    budget->scopeSize = (int64_t)(sentrycrash_scopesync_getLength(scope->user)
+                            + sentrycrash_scopesync_getLength(scope->dist)
+                            + sentrycrash_scopesync_getLength(scope->context)
+                            + sentrycrash_scopesync_getLength(scope->traceContext)
+                            + sentrycrash_scopesync_getLength(scope->environment)
+                            + sentrycrash_scopesync_getLength(scope->tags)
+                            + sentrycrash_scopesync_getLength(scope->extras)
+                            + sentrycrash_scopesync_getLength(scope->fingerprint)
+                            + sentrycrash_scopesync_getLength(scope->level))
+        + lengthOfString(g_userInfoJSON);
+    if (scope->breadcrumbs != NULL) {
+        for (long i = 0; i < scope->maxCrumbs; i++) {
+            budget->breadcrumbsSize
+                += (int64_t)sentrycrash_scopesync_getLength(scope->breadcrumbs[i]);
+        }
+    }
+}
+
 // ============================================================================
 #    pragma mark - Report Writing -
 // ============================================================================
@@ -1116,16 +1303,24 @@ writeThread(const SentryCrashReportWriter *const writer, const char *const key,
 }
 
 /** Write information about all threads to the report.
+ *
+ * If the report size is limited, the crashed thread is written first, and the other threads are
+ * only written while there is room left for the sections that are more important than them.
  *
  * @param writer The writer.
  *
  * @param key The object key, if needed.
  *
  * @param crash The crash handler context.
+ *
+ * @param writeNotableAddresses If true, write the notable addresses of the crashed thread.
+ *
+ * @param budget The size budget of the report.
  */
 static void
 writeAllThreads(const SentryCrashReportWriter *const writer, const char *const key,
-    const SentryCrash_MonitorContext *const crash, bool writeNotableAddresses)
+    const SentryCrash_MonitorContext *const crash, bool writeNotableAddresses,
+    SentryCrashReportBudget *const budget)
 {
     const struct SentryCrashMachineContext *const context = crash->offendingMachineContext;
 
@@ -1136,17 +1331,38 @@ writeAllThreads(const SentryCrashReportWriter *const writer, const char *const k
     int threadCount = sentrycrashmc_getThreadCount(context);
     SentryCrashMC_NEW_CONTEXT(machineContext);
 
+    // Memory introspection is the least important part of the report, so it needs room for all
+    // other sections.
+    int64_t reserved
+        = referencedImagesReserve(budget) + budget->scopeSize + budget->breadcrumbsSize;
+    bool shouldWriteNotableAddresses = writeNotableAddresses
+        && fitsInBudget(budget, reserved + (int64_t)(threadCount - 1) * kEstimatedThreadSize);
+    budget->omittedNotableAddresses = writeNotableAddresses && !shouldWriteNotableAddresses;
+
     // Fetch info for all threads.
     writer->beginArray(writer, key);
     {
         SENTRY_ASYNC_SAFE_LOG_DEBUG("Writing %d threads.", threadCount);
+        int writtenThreadIndex = -1;
+        if (budget->maxSize > 0) {
+            writtenThreadIndex = sentrycrashmc_indexOfThread(context, offendingThread);
+            if (writtenThreadIndex >= 0) {
+                writeThread(
+                    writer, NULL, crash, context, writtenThreadIndex, shouldWriteNotableAddresses);
+            }
+        }
         for (int i = 0; i < threadCount; i++) {
+            if (i == writtenThreadIndex) {
+                continue;
+            }
             SentryCrashThread thread = sentrycrashmc_getThreadAtIndex(context, i);
             if (thread == offendingThread) {
-                writeThread(writer, NULL, crash, context, i, writeNotableAddresses);
-            } else {
+                writeThread(writer, NULL, crash, context, i, shouldWriteNotableAddresses);
+            } else if (fitsInBudget(budget, reserved)) {
                 sentrycrashmc_getContextForThread(thread, machineContext, false);
-                writeThread(writer, NULL, crash, machineContext, i, writeNotableAddresses);
+                writeThread(writer, NULL, crash, machineContext, i, shouldWriteNotableAddresses);
+            } else {
+                budget->omittedThreads++;
             }
         }
     }
@@ -1188,10 +1404,24 @@ writeBinaryImage(const SentryCrashReportWriter *const writer, const char *const
     writer->endContainer(writer);
 }
 
+typedef struct {
+    const SentryCrashReportWriter *writer;
+    SentryCrashReportBudget *budget;
+} BinaryImagesContext;
+
 static void
 binaryImagesIteratorCallback(SentryCrashBinaryImage *image, void *context)
 {
-    SentryCrashReportWriter *writer = (SentryCrashReportWriter *)context;
+    BinaryImagesContext *imagesContext = (BinaryImagesContext *)context;
+    const SentryCrashReportWriter *writer = imagesContext->writer;
+    SentryCrashReportBudget *budget = imagesContext->budget;
+    if (isReferencedImage(budget, image->address)) {
+        budget->referencedImagesWritten++;
+    } else if (!fitsInBudget(budget,
+                   referencedImagesReserve(budget) + budget->scopeSize + budget->breadcrumbsSize)) {
+        budget->omittedBinaryImages++;
+        return;
+    }
     // We can only retrieve the crash info after a crash occurred. So we need to
     // fetch it when writing the crash report.
     // Swift puts its fatalErrors into the crash info message.
@@ -1200,16 +1430,23 @@ binaryImagesIteratorCallback(SentryCrashBinaryImage *image, void *context)
 }
 
 /** Write information about all images to the report.
+ *
+ * If the report size is limited, images not referenced by the crashed thread are only written
+ * while there is room left for the referenced ones and the scope.
  *
  * @param writer The writer.
  *
  * @param key The object key, if needed.
+ *
+ * @param budget The size budget of the report.
  */
 static void
-writeBinaryImages(const SentryCrashReportWriter *const writer, const char *const key)
+writeBinaryImages(const SentryCrashReportWriter *const writer, const char *const key,
+    SentryCrashReportBudget *const budget)
 {
+    BinaryImagesContext context = { .writer = writer, .budget = budget };
     writer->beginArray(writer, key);
-    sentrycrashbic_iterateOverImages(&binaryImagesIteratorCallback, (void *)writer);
+    sentrycrashbic_iterateOverImages(&binaryImagesIteratorCallback, &context);
     writer->endContainer(writer);
 }
 
@@ -1431,6 +1668,49 @@ writeReportInfo(const SentryCrashReportWriter *const writer, const char *const k
     writer->endContainer(writer);
 }
 
+/** Write statistics about how the report was written.
+ *
+ * @param writer The writer.
+ *
+ * @param key The object key.
+ *
+ * @param bufferedWriter The buffered writer the report is written with.
+ */
+static void
+writeReportWriterStats(const SentryCrashReportWriter *const writer, const char *const key,
+    const SentryCrashBufferedWriter *const bufferedWriter)
+{
+    writer->beginObject(writer, key);
+    {
+        writer->addIntegerElement(writer, SentryCrashField_WriteCalls, bufferedWriter->writeCalls);
+        writer->addIntegerElement(
+            writer, SentryCrashField_BytesWritten, bufferedWriter->bytesWritten);
+    }
+    writer->endContainer(writer);
+}
+
+/** Write the counters of the C++ exceptions thrown since the monitor was enabled.
+ *
+ * @param writer The writer.
+ *
+ * @param key The object key, if needed.
+ */
+static void
+writeCPPExceptionThrowStats(const SentryCrashReportWriter *const writer, const char *const key)
+{
+    const SentryCrashCPPExceptionThrowStatistics statistics
+        = sentrycrashcm_cppexception_getThrowStatistics();
+    writer->beginObject(writer, key);
+    {
+        writer->addUIntegerElement(writer, SentryCrashField_ThrowCount, statistics.throwCount);
+        writer->addUIntegerElement(
+            writer, SentryCrashField_NSExceptionThrowCount, statistics.nsExceptionThrowCount);
+        writer->addUIntegerElement(
+            writer, SentryCrashField_CapturedStackTraceCount, statistics.capturedStackTraceCount);
+    }
+    writer->endContainer(writer);
+}
+
 static void
 writeRecrash(
     const SentryCrashReportWriter *const writer, const char *const key, const char *crashReportPath)
@@ -1478,7 +1758,9 @@ void
 sentrycrashreport_writeRecrashReport(
     const SentryCrash_MonitorContext *const monitorContext, const char *const path)
 {
-    char writeBuffer[1024];
+    char fallbackWriteBuffer[kFallbackWriteBufferSize];
+    int writeBufferLength;
+    char *writeBuffer = acquireWriteBuffer(fallbackWriteBuffer, &writeBufferLength);
     SentryCrashBufferedWriter bufferedWriter;
     static char tempPath[SentryCrashFU_MAX_PATH_LENGTH];
     strlcpy(tempPath, path, sizeof(tempPath) - 10);
@@ -1500,8 +1782,8 @@ sentrycrashreport_writeRecrashReport(
         SENTRY_ASYNC_SAFE_LOG_ERROR(
             "Could not rename %s to %s: %s", path, tempPath, SENTRY_STRERROR_R(errno));
     }
-    if (!sentrycrashfu_openBufferedWriter(
-            &bufferedWriter, path, writeBuffer, sizeof(writeBuffer))) {
+    if (!sentrycrashfu_openBufferedWriter(&bufferedWriter, path, writeBuffer, writeBufferLength)) {
+        releaseWriteBuffer(writeBuffer);
         return;
     }
 
@@ -1545,11 +1827,18 @@ sentrycrashreport_writeRecrashReport(
             sentrycrashfu_flushBufferedWriter(&bufferedWriter);
         }
         writer->endContainer(writer);
+
+        writer->beginObject(writer, SentryCrashField_Debug);
+        {
+            writeReportWriterStats(writer, SentryCrashField_ReportWriter, &bufferedWriter);
+        }
+        writer->endContainer(writer);
     }
     writer->endContainer(writer);
 
     sentrycrashjson_endEncode(getJsonContext(writer));
     sentrycrashfu_closeBufferedWriter(&bufferedWriter);
+    releaseWriteBuffer(writeBuffer);
     sentrycrashccd_unfreeze();
 }
 
@@ -1610,50 +1899,257 @@ writeSystemInfo(const SentryCrashReportWriter *const writer, const char *const k
 
 static void
 writeDebugInfo(const SentryCrashReportWriter *const writer, const char *const key,
-    const SentryCrash_MonitorContext *const monitorContext)
+    const SentryCrash_MonitorContext *const monitorContext,
+    const SentryCrashBufferedWriter *const bufferedWriter, SentryCrashReportBudget *const budget)
 {
     writer->beginObject(writer, key);
     {
-        addTextLinesFromFile(writer, SentryCrashField_ConsoleLog, g_logFilename);
+        if (fitsInBudget(budget, 0)) {
+            addTextLinesFromFile(writer, SentryCrashField_ConsoleLog, g_logFilename);
+        } else {
+            budget->omittedConsoleLog = g_logFilename[0] != '\0';
+        }
+        writeReportWriterStats(writer, SentryCrashField_ReportWriter, bufferedWriter);
+        writeCPPExceptionThrowStats(writer, SentryCrashField_CPPExceptionThrows);
+    }
+    writer->endContainer(writer);
+}
+
+/** Write what was left out of the report to stay below its size limit, if anything.
+ *
+ * @param writer The writer.
+ *
+ * @param key The object key, if needed.
+ *
+ * @param budget The size budget of the report.
+ */
+static void
+writeTruncation(const SentryCrashReportWriter *const writer, const char *const key,
+    const SentryCrashReportBudget *const budget)
+{
+    if (!budget->omittedNotableAddresses && budget->omittedThreads == 0
+        && !budget->omittedBreadcrumbs && !budget->omittedScope
+        && budget->omittedBinaryImages == 0 && !budget->omittedConsoleLog) {
+        return;
+    }
+    writer->beginObject(writer, key);
+    {
+        writer->addIntegerElement(writer, SentryCrashField_MaxSize, budget->maxSize);
+        writer->addBooleanElement(
+            writer, SentryCrashField_OmittedNotableAddresses, budget->omittedNotableAddresses);
+        writer->addIntegerElement(writer, SentryCrashField_OmittedThreads, budget->omittedThreads);
+        writer->addBooleanElement(
+            writer, SentryCrashField_OmittedBreadcrumbs, budget->omittedBreadcrumbs);
+        writer->addBooleanElement(writer, SentryCrashField_OmittedScope, budget->omittedScope);
+        writer->addIntegerElement(
+            writer, SentryCrashField_OmittedBinaryImages, budget->omittedBinaryImages);
+        writer->addBooleanElement(
+            writer, SentryCrashField_OmittedConsoleLog, budget->omittedConsoleLog);
     }
     writer->endContainer(writer);
 }
 
+/** Read a value from a binary scope record, if there are enough bytes left.
+ *
+ * @param cursor The position in the record, which is advanced past the value.
+ *
+ * @param end The end of the record.
+ *
+ * @param value The value to read into.
+ *
+ * @param size The size of the value.
+ *
+ * @return true if the value was read.
+ */
+static bool
+readScopeRecordValue(
+    const char **const cursor, const char *const end, void *const value, const size_t size)
+{
+    if ((size_t)(end - *cursor) < size) {
+        return false;
+    }
+    memcpy(value, *cursor, size);
+    *cursor += size;
+    return true;
+}
+
+/** Write a binary scope record as JSON, see SentryCrashScopeRecordType.
+ *
+ * The record is written without pretty printing, like the JSON strings of the scope, so that it
+ * doesn't get longer than its length as JSON. A malformed record is written up to where it's
+ * broken, and the containers it began are ended so that the report stays valid JSON.
+ *
+ * @param writer The writer.
+ *
+ * @param key The name of the record's top-level element.
+ *
+ * @param record The record, a field of the scope.
+ */
 static void
-writeScopeJson(const SentryCrashReportWriter *const writer)
+addScopeRecordElement(
+    const SentryCrashReportWriter *const writer, const char *const key, const char *const record)
+{
+    SentryCrashJSONEncodeContext *const context = getJsonContext(writer);
+    const char *cursor = record;
+    const char *const end = record + sentrycrash_scopesync_getSize(record);
+    const bool prettyPrint = context->prettyPrint;
+    context->prettyPrint = false;
+    int depth = 0;
+    do {
+        uint8_t type;
+        if (!readScopeRecordValue(&cursor, end, &type, sizeof(type))) {
+            break;
+        }
+        if (type == SentryCrashScopeRecordEndContainer) {
+            if (depth == 0 || sentrycrashjson_endContainer(context) != SentryCrashJSON_OK) {
+                break;
+            }
+            depth--;
+            continue;
+        }
+
+        const size_t nameLength = strnlen(cursor, (size_t)(end - cursor));
+        if (nameLength == (size_t)(end - cursor)) {
+            break;
+        }
+        const char *const name = depth == 0 ? key : cursor;
+        cursor += nameLength + 1;
+
+        int result;
+        switch (type) {
+        case SentryCrashScopeRecordNull:
+            result = sentrycrashjson_addNullElement(context, name);
+            break;
+        case SentryCrashScopeRecordBoolean: {
+            uint8_t value;
+            if (!readScopeRecordValue(&cursor, end, &value, sizeof(value))) {
+                goto done;
+            }
+            result = sentrycrashjson_addBooleanElement(context, name, value != 0);
+            break;
+        }
+        case SentryCrashScopeRecordInteger: {
+            int64_t value;
+            if (!readScopeRecordValue(&cursor, end, &value, sizeof(value))) {
+                goto done;
+            }
+            result = sentrycrashjson_addIntegerElement(context, name, value);
+            break;
+        }
+        case SentryCrashScopeRecordFloatingPoint: {
+            double value;
+            if (!readScopeRecordValue(&cursor, end, &value, sizeof(value))) {
+                goto done;
+            }
+            result = sentrycrashjson_addFloatingPointElement(context, name, value);
+            break;
+        }
+        case SentryCrashScopeRecordString:
+        case SentryCrashScopeRecordData: {
+            uint32_t length;
+            if (!readScopeRecordValue(&cursor, end, &length, sizeof(length)) || length > INT_MAX
+                || (size_t)(end - cursor) < length) {
+                goto done;
+            }
+            result = type == SentryCrashScopeRecordString
+                ? sentrycrashjson_addStringElement(context, name, cursor, (int)length)
+                : sentrycrashjson_addDataElement(context, name, cursor, (int)length);
+            cursor += length;
+            break;
+        }
+        case SentryCrashScopeRecordBeginObject:
+            result = sentrycrashjson_beginObject(context, name);
+            depth += result == SentryCrashJSON_OK ? 1 : 0;
+            break;
+        case SentryCrashScopeRecordBeginArray:
+            result = sentrycrashjson_beginArray(context, name);
+            depth += result == SentryCrashJSON_OK ? 1 : 0;
+            break;
+        default:
+            goto done;
+        }
+        if (result != SentryCrashJSON_OK) {
+            break;
+        }
+    } while (depth > 0);
+
+done:
+    if (depth > 0) {
+        SENTRY_ASYNC_SAFE_LOG_ERROR("Malformed scope record for %s", key);
+    }
+    for (; depth > 0; depth--) {
+        sentrycrashjson_endContainer(context);
+    }
+    context->prettyPrint = prettyPrint;
+}
+
+/** Write a field of the scope, which is either a binary record or a JSON string.
+ *
+ * @param writer The writer.
+ *
+ * @param key The object key.
+ *
+ * @param field The field of the scope.
+ */
+static void
+addScopeFieldElement(
+    const SentryCrashReportWriter *const writer, const char *const key, const char *const field)
+{
+    if (sentrycrash_scopesync_isRecord(field)) {
+        addScopeRecordElement(writer, key, field);
+    } else {
+        addJSONElement(writer, key, field, false);
+    }
+}
+
+/** Write the scope to the report.
+ *
+ * If the report size is limited, the breadcrumbs are left out when there isn't room for all of
+ * the scope, and the scope is left out when there isn't room for it without the breadcrumbs.
+ *
+ * @param writer The writer.
+ *
+ * @param budget The size budget of the report.
+ */
+static void
+writeScopeJson(const SentryCrashReportWriter *const writer, SentryCrashReportBudget *const budget)
 {
     SentryCrashScope *scope = sentrycrash_scopesync_getScope();
+    bool shouldWriteBreadcrumbs = fitsInBudget(budget, budget->scopeSize + budget->breadcrumbsSize);
+    budget->omittedScope = !shouldWriteBreadcrumbs && !fitsInBudget(budget, budget->scopeSize);
+    budget->omittedBreadcrumbs
+        = !shouldWriteBreadcrumbs && !budget->omittedScope && budget->breadcrumbsSize > 0;
     writer->beginObject(writer, SentryCrashField_Scope);
-    {
+    if (!budget->omittedScope) {
         if (scope->user) {
-            addJSONElement(writer, "user", scope->user, false);
+            addScopeFieldElement(writer, "user", scope->user);
         }
         if (scope->dist) {
-            addJSONElement(writer, "dist", scope->dist, false);
+            addScopeFieldElement(writer, "dist", scope->dist);
         }
         if (scope->context) {
-            addJSONElement(writer, "context", scope->context, false);
+            addScopeFieldElement(writer, "context", scope->context);
         }
         if (scope->traceContext) {
-            addJSONElement(writer, "traceContext", scope->traceContext, false);
+            addScopeFieldElement(writer, "traceContext", scope->traceContext);
         }
         if (scope->environment) {
-            addJSONElement(writer, "environment", scope->environment, false);
+            addScopeFieldElement(writer, "environment", scope->environment);
         }
         if (scope->tags) {
-            addJSONElement(writer, "tags", scope->tags, false);
+            addScopeFieldElement(writer, "tags", scope->tags);
         }
         if (scope->extras) {
-            addJSONElement(writer, "extra", scope->extras, false);
+            addScopeFieldElement(writer, "extra", scope->extras);
         }
         if (scope->fingerprint) {
-            addJSONElement(writer, "fingerprint", scope->fingerprint, false);
+            addScopeFieldElement(writer, "fingerprint", scope->fingerprint);
         }
         if (scope->level) {
-            addJSONElement(writer, "level", scope->level, false);
+            addScopeFieldElement(writer, "level", scope->level);
         }
 
-        if (scope->breadcrumbs) {
+        if (scope->breadcrumbs && shouldWriteBreadcrumbs) {
 
             bool areThereBreadcrumbs = false;
             for (int i = 0; i < scope->maxCrumbs; i++) {
@@ -1671,7 +2167,7 @@ writeScopeJson(const SentryCrashReportWriter *const writer)
                         // crumbs in the correct order.
                         long index = (scope->currentCrumb + i) % scope->maxCrumbs;
                         if (scope->breadcrumbs[index]) {
-                            addJSONElement(writer, "crumb", scope->breadcrumbs[index], false);
+                            addScopeFieldElement(writer, "crumb", scope->breadcrumbs[index]);
                         }
                     }
                 }
@@ -1687,16 +2183,21 @@ sentrycrashreport_writeStandardReport(
     const SentryCrash_MonitorContext *const monitorContext, const char *const path)
 {
     SENTRY_ASYNC_SAFE_LOG_INFO("Writing crash report to %s", path);
-    char writeBuffer[1024];
+    char fallbackWriteBuffer[kFallbackWriteBufferSize];
+    int writeBufferLength;
+    char *writeBuffer = acquireWriteBuffer(fallbackWriteBuffer, &writeBufferLength);
     SentryCrashBufferedWriter bufferedWriter;
 
-    if (!sentrycrashfu_openBufferedWriter(
-            &bufferedWriter, path, writeBuffer, sizeof(writeBuffer))) {
+    if (!sentrycrashfu_openBufferedWriter(&bufferedWriter, path, writeBuffer, writeBufferLength)) {
+        releaseWriteBuffer(writeBuffer);
         return;
     }
 
     sentrycrashccd_freeze();
 
+    SentryCrashReportBudget budget;
+    prepareBudget(&budget, monitorContext, &bufferedWriter);
+
     SentryCrashJSONEncodeContext jsonContext;
     jsonContext.userData = &bufferedWriter;
     SentryCrashReportWriter concreteWriter;
@@ -1705,14 +2206,22 @@ sentrycrashreport_writeStandardReport(
 
     sentrycrashjson_beginEncode(getJsonContext(writer), true, addJSONData, &bufferedWriter);
 
+    // When the report size is limited, each section only leaves out its less important parts, and
+    // keeps room for the more important sections written after it, see SentryCrashReportBudget.
+    // The binary images then come after the threads, so that the threads are written while there
+    // is still room and images not referenced by the crashed thread are left out instead. Without
+    // a limit, they come first as they always have.
+    const bool writeBinaryImagesFirst = budget.maxSize <= 0;
     writer->beginObject(writer, SentryCrashField_Report);
     {
         writeReportInfo(writer, SentryCrashField_Report, SentryCrashReportType_Standard,
             monitorContext->eventID, monitorContext->System.processName);
         sentrycrashfu_flushBufferedWriter(&bufferedWriter);
 
-        writeBinaryImages(writer, SentryCrashField_BinaryImages);
-        sentrycrashfu_flushBufferedWriter(&bufferedWriter);
+        if (writeBinaryImagesFirst) {
+            writeBinaryImages(writer, SentryCrashField_BinaryImages, &budget);
+            sentrycrashfu_flushBufferedWriter(&bufferedWriter);
+        }
 
         writeProcessState(writer, SentryCrashField_ProcessState, monitorContext);
         sentrycrashfu_flushBufferedWriter(&bufferedWriter);
@@ -1724,16 +2233,21 @@ sentrycrashreport_writeStandardReport(
         {
             writeError(writer, SentryCrashField_Error, monitorContext);
             sentrycrashfu_flushBufferedWriter(&bufferedWriter);
-            writeAllThreads(
-                writer, SentryCrashField_Threads, monitorContext, g_introspectionRules.enabled);
+            writeAllThreads(writer, SentryCrashField_Threads, monitorContext,
+                g_introspectionRules.enabled, &budget);
             sentrycrashfu_flushBufferedWriter(&bufferedWriter);
         }
         writer->endContainer(writer);
 
-        writeScopeJson(writer);
+        if (!writeBinaryImagesFirst) {
+            writeBinaryImages(writer, SentryCrashField_BinaryImages, &budget);
+            sentrycrashfu_flushBufferedWriter(&bufferedWriter);
+        }
+
+        writeScopeJson(writer, &budget);
         sentrycrashfu_flushBufferedWriter(&bufferedWriter);
 
-        if (g_userInfoJSON != NULL) {
+        if (g_userInfoJSON != NULL && !budget.omittedScope) {
             addJSONElement(writer, SentryCrashField_User, g_userInfoJSON, false);
             sentrycrashfu_flushBufferedWriter(&bufferedWriter);
         } else {
@@ -1742,12 +2256,14 @@ sentrycrashreport_writeStandardReport(
         writer->endContainer(writer);
         sentrycrashfu_flushBufferedWriter(&bufferedWriter);
 
-        writeDebugInfo(writer, SentryCrashField_Debug, monitorContext);
+        writeDebugInfo(writer, SentryCrashField_Debug, monitorContext, &bufferedWriter, &budget);
+        writeTruncation(writer, SentryCrashField_Truncation, &budget);
     }
     writer->endContainer(writer);
 
     sentrycrashjson_endEncode(getJsonContext(writer));
     sentrycrashfu_closeBufferedWriter(&bufferedWriter);
+    releaseWriteBuffer(writeBuffer);
     sentrycrashccd_unfreeze();
 }
 
@@ -1775,6 +2291,12 @@ sentrycrashreport_setIntrospectMemory(bool shouldIntrospectMemory)
     g_introspectionRules.enabled = shouldIntrospectMemory;
 }
 
+void
+sentrycrashreport_setMaxReportSize(int64_t maxReportSize)
+{
+    g_maxReportSize = maxReportSize;
+}
+
 void
 sentrycrashreport_setDoNotIntrospectClasses(const char **doNotIntrospectClasses, int length)
 {
@@ -1809,4 +2331,46 @@ sentrycrashreport_setDoNotIntrospectClasses(const char **doNotIntrospectClasses,
     }
 }
 
+
+#    if defined(SENTRY_TEST) || defined(SENTRY_TEST_CI)
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t length;
+    bool didOverflow;
+} ScopeFieldJSONBuffer;
+
+static int
+addJSONDataToScopeFieldBuffer(const char *const data, const int length, void *const userData)
+{
+    ScopeFieldJSONBuffer *const jsonBuffer = (ScopeFieldJSONBuffer *)userData;
+    if (jsonBuffer->size - jsonBuffer->length <= (size_t)length) {
+        jsonBuffer->didOverflow = true;
+        return SentryCrashJSON_ERROR_CANNOT_ADD_DATA;
+    }
+    memcpy(jsonBuffer->buffer + jsonBuffer->length, data, (size_t)length);
+    jsonBuffer->length += (size_t)length;
+    jsonBuffer->buffer[jsonBuffer->length] = '\0';
+    return SentryCrashJSON_OK;
+}
+
+bool
+sentrycrashreport_writeScopeFieldJSONForTests(
+    const char *const field, char *const buffer, const size_t bufferSize)
+{
+    if (field == NULL || bufferSize == 0) {
+        return false;
+    }
+    buffer[0] = '\0';
+    ScopeFieldJSONBuffer jsonBuffer
+        = { .buffer = buffer, .size = bufferSize, .length = 0, .didOverflow = false };
+    SentryCrashJSONEncodeContext jsonContext;
+    SentryCrashReportWriter writer;
+    prepareReportWriter(&writer, &jsonContext);
+    sentrycrashjson_beginEncode(&jsonContext, false, addJSONDataToScopeFieldBuffer, &jsonBuffer);
+    addScopeFieldElement(&writer, NULL, field);
+    return !jsonBuffer.didOverflow;
+}
+#    endif // defined(SENTRY_TEST) || defined(SENTRY_TEST_CI)
+
 #endif // !SDK_V10
@@ -39,6 +39,7 @@ extern "C" {
 #import "SentryCrashReportWriter.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 // ============================================================================
 #pragma mark - Configuration -
@@ -64,6 +65,18 @@ void sentrycrashreport_setIntrospectMemory(bool shouldIntrospectMemory);
  */
 void sentrycrashreport_setDoNotIntrospectClasses(const char **doNotIntrospectClasses, int length);
 
+/** Set the size in bytes a standard report should not exceed.
+ *  When a report would exceed it, sections are left out starting with the least
+ *  important one: memory introspection, then the other threads, the binary
+ *  images not referenced by the crashed thread, the breadcrumbs and the scope.
+ *  The console log only gets the room left over. The error, the crashed thread
+ *  and the images it references are always written. What was left out is
+ *  recorded in the report.
+ *
+ * @param maxReportSize The maximum size of a report, or 0 for no limit.
+ */
+void sentrycrashreport_setMaxReportSize(int64_t maxReportSize);
+
 // ============================================================================
 #pragma mark - Main API -
 // ============================================================================
@@ -88,6 +101,22 @@ void sentrycrashreport_writeStandardReport(
 void sentrycrashreport_writeRecrashReport(
     const struct SentryCrash_MonitorContext *const monitorContext, const char *path);
 
+#if defined(SENTRY_TEST) || defined(SENTRY_TEST_CI)
+#    include <stddef.h>
+/** Write a field of the scope as JSON the way it is written into reports, for tests.
+ *
+ * @param field A field of the scope returned by sentrycrash_scopesync_getScope.
+ *
+ * @param buffer The buffer to write the NUL-terminated JSON to.
+ *
+ * @param bufferSize The size of the buffer.
+ *
+ * @return true if the JSON fit into the buffer.
+ */
+bool sentrycrashreport_writeScopeFieldJSONForTests(
+    const char *field, char *buffer, size_t bufferSize);
+#endif // defined(SENTRY_TEST) || defined(SENTRY_TEST_CI)
+
 #ifdef __cplusplus
 }
 #endif
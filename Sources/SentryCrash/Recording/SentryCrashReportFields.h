@@ -165,6 +165,21 @@
 #define SentryCrashField_Threads "threads"
 #define SentryCrashField_User "user"
 #define SentryCrashField_ConsoleLog "console_log"
+#define SentryCrashField_ReportWriter "report_writer"
+#define SentryCrashField_WriteCalls "write_calls"
+#define SentryCrashField_BytesWritten "bytes_written"
+#define SentryCrashField_CPPExceptionThrows "cpp_exception_throws"
+#define SentryCrashField_ThrowCount "throw_count"
+#define SentryCrashField_NSExceptionThrowCount "ns_exception_throw_count"
+#define SentryCrashField_CapturedStackTraceCount "captured_stack_trace_count"
+#define SentryCrashField_Truncation "truncation"
+#define SentryCrashField_MaxSize "max_size"
+#define SentryCrashField_OmittedNotableAddresses "omitted_notable_addresses"
+#define SentryCrashField_OmittedThreads "omitted_threads"
+#define SentryCrashField_OmittedBreadcrumbs "omitted_breadcrumbs"
+#define SentryCrashField_OmittedScope "omitted_scope"
+#define SentryCrashField_OmittedBinaryImages "omitted_binary_images"
+#define SentryCrashField_OmittedConsoleLog "omitted_console_log"
 
 #define SentryCrashField_Scope "sentry_sdk_scope"
 
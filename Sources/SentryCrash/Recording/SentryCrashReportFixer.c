@@ -31,6 +31,7 @@
 #    include "SentryCrashDate.h"
 #    include "SentryCrashJSONCodec.h"
 #    include "SentryCrashReportFields.h"
+#    include "SentryCrashReportFixer.h"
 #    include "SentryInternalCDefines.h"
 
 #    include <stdlib.h>
@@ -114,6 +115,38 @@ shouldFixDate(FixupContext *context, const char *name)
     return matchesAPath(context, name, datePaths, datePathsCount);
 }
 
+/** Whether the container being decoded is part of the notable addresses of a thread. */
+static bool
+isInNotableAddresses(FixupContext *context)
+{
+    for (int i = 0; i < context->currentDepth; i++) {
+        if (strncmp(context->objectPath[i], SentryCrashField_NotableAddresses, MAX_NAME_LENGTH)
+            == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * The memory introspection of the notable addresses describes the ivars of the objects they point
+ * to, recursively, and the first object of autorelease pool pages. Nothing reads those subtrees
+ * after the report was written, so they are left out of the fixed report instead of being encoded
+ * again and later decoded into Objective-C objects.
+ */
+static bool
+shouldSkipContainer(FixupContext *context, const char *name)
+{
+    if (name == NULL) {
+        return false;
+    }
+    if (strcmp(name, SentryCrashField_Ivars) != 0
+        && strcmp(name, SentryCrashField_FirstObject) != 0) {
+        return false;
+    }
+    return isInNotableAddresses(context);
+}
+
 static int
 onBooleanElement(const char *const name, const bool value, void *const userData)
 {
@@ -178,10 +211,21 @@ onStringElement(const char *const name, const char *const value, void *const use
     return result;
 }
 
+static int
+onStringSliceElement(
+    const char *const name, const char *const value, const int length, void *const userData)
+{
+    FixupContext *context = (FixupContext *)userData;
+    return sentrycrashjson_addStringElement(context->encodeContext, name, value, length);
+}
+
 static int
 onBeginObject(const char *const name, void *const userData)
 {
     FixupContext *context = (FixupContext *)userData;
+    if (shouldSkipContainer(context, name)) {
+        return SentryCrashJSON_SKIP_CONTAINER;
+    }
     int result = sentrycrashjson_beginObject(context->encodeContext, name);
     if (!increaseDepth(context, name)) {
         return SentryCrashJSON_ERROR_DATA_TOO_LONG;
@@ -193,6 +237,9 @@ static int
 onBeginArray(const char *const name, void *const userData)
 {
     FixupContext *context = (FixupContext *)userData;
+    if (shouldSkipContainer(context, name)) {
+        return SentryCrashJSON_SKIP_CONTAINER;
+    }
     int result = sentrycrashjson_beginArray(context->encodeContext, name);
     if (!increaseDepth(context, name)) {
         return SentryCrashJSON_ERROR_DATA_TOO_LONG;
@@ -242,6 +289,18 @@ sentrycrashcrf_fixupCrashReport(const char *crashReport)
         return NULL;
     }
 
+    // strlen here cannot read out of bounds: crashReport is the C-string contract of this
+    // public sentrycrashcrf_fixupCrashReport entry point.
+    return sentrycrashcrf_fixupCrashReportWithLength(crashReport, (int)strlen(crashReport));
+}
+
+char *
+sentrycrashcrf_fixupCrashReportWithLength(const char *crashReport, int crashReportLength)
+{
+    if (crashReport == NULL) {
+        return NULL;
+    }
+
     SentryCrashJSONDecodeCallbacks callbacks = {
         .onBeginArray = onBeginArray,
         .onBeginObject = onBeginObject,
@@ -253,6 +312,7 @@ sentrycrashcrf_fixupCrashReport(const char *crashReport)
         .onUIntegerElement = onUIntegerElement,
         .onNullElement = onNullElement,
         .onStringElement = onStringElement,
+        .onStringSliceElement = onStringSliceElement,
     };
     int stringBufferLength = SentryCrashMAX_STRINGBUFFERSIZE;
     char *stringBuffer = malloc((unsigned)stringBufferLength);
@@ -261,13 +321,9 @@ sentrycrashcrf_fixupCrashReport(const char *crashReport)
             "Failed to allocate string buffer of size %ul", stringBufferLength);
         return NULL;
     }
-    // strlen here cannot read out of bounds: crashReport is the C-string contract of this
-    // public sentrycrashcrf_fixupCrashReport entry point, called only by SentryCrashReportStore
-    // after reading a report file via sentrycrashfu_readEntireFile, which always
-    // null-terminates its returned buffer.
-    int crashReportLength = (int)strlen(crashReport);
     int fixedReportLength = (int)(crashReportLength * 1.5);
-    char *fixedReport = malloc((unsigned)fixedReportLength);
+    // The report isn't necessarily null terminated, so leave room for the terminator.
+    char *fixedReport = malloc((unsigned)fixedReportLength + 1);
     if (fixedReport == NULL) {
         free(stringBuffer);
         SENTRY_ASYNC_SAFE_LOG_ERROR(
@@ -35,6 +35,8 @@ extern "C" {
 /** Fixes up fields in a crash report that could not be fixed up at crash time.
  * Some fields, such a mangled fields and dates, cannot be fixed up at crash
  * time because the function calls needed to do it are not async-safe.
+ * The ivars and first objects that the memory introspection of the notable
+ * addresses describes are left out, as nothing reads them.
  *
  * @param crashReport A raw report loaded from disk.
  *
@@ -44,6 +46,19 @@ extern "C" {
  */
 char *sentrycrashcrf_fixupCrashReport(const char *crashReport);
 
+/** Like sentrycrashcrf_fixupCrashReport(), but for a report that isn't null
+ * terminated, such as a memory mapped report file.
+ *
+ * @param crashReport A raw report loaded from disk.
+ *
+ * @param crashReportLength The length of the report.
+ *
+ * @return A fixed up, null terminated crash report.
+ *         MEMORY MANAGEMENT WARNING: User is responsible for calling free() on
+ * the returned value.
+ */
+char *sentrycrashcrf_fixupCrashReportWithLength(const char *crashReport, int crashReportLength);
+
 #ifdef __cplusplus
 }
 #endif
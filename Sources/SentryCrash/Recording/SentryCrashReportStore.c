@@ -39,10 +39,12 @@
 #    include <stdio.h>
 #    include <stdlib.h>
 #    include <string.h>
+#    include <sys/stat.h>
 #    include <time.h>
 #    include <unistd.h>
 
 static int g_maxReportCount = 5;
+static int64_t g_maxReportStoreSize = 0;
 // Have to use max 32-bit atomics because of MIPS.
 static _Atomic(uint32_t) g_nextUniqueIDLow;
 static int64_t g_nextUniqueIDHigh;
@@ -52,6 +54,34 @@ static char g_appName[SentryCrashCRS_MAX_PATH_LENGTH];
 static char g_reportsPath[SentryCrashCRS_MAX_PATH_LENGTH];
 static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+typedef struct {
+    int64_t reportID;
+    /** The size when the entry was added, or 0 if it wasn't read. Reports written outside the
+     * store may still grow after that, so pruning rebuilds the manifest instead of relying on it.
+     */
+    int64_t size;
+} SentryCrashReportManifestEntry;
+
+/** The reports on disk, sorted by ID, so the reports directory doesn't need to be scanned for
+ * every query. Guarded by g_mutex.
+ *
+ * Reports are also written without going through the store, at crash time with a path from
+ * sentrycrashcrs_getNextCrashReportPath, and the directory can be deleted as a whole. The
+ * manifest therefore remembers the directory's modification time and inode when it was last in
+ * sync, and is rebuilt from the directory whenever they changed. After the store changes the
+ * directory itself, the new state is only remembered if the store's change is known to be the
+ * last one, see markManifestInSyncAfterCreating and markManifestInSyncAfterDeleting.
+ */
+static struct {
+    SentryCrashReportManifestEntry *entries;
+    int count;
+    int capacity;
+    int64_t totalSize;
+    bool isValid;
+    ino_t directoryInode;
+    struct timespec directoryModificationTime;
+} g_manifest;
+
 static int
 compareInt64(const void *a, const void *b)
 {
@@ -119,68 +149,294 @@ getReportIDFromFilePath(const char *filepath)
     return getReportIDFromFilename(filename);
 }
 
+static bool
+getDirectoryStat(struct stat *st)
+{
+    if (stat(g_reportsPath, st) != 0) {
+        SENTRY_ASYNC_SAFE_LOG_ERROR(
+            "Could not stat directory %s: %s", g_reportsPath, SENTRY_STRERROR_R(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool
+isSameTime(const struct timespec *a, const struct timespec *b)
+{
+    return a->tv_sec == b->tv_sec && a->tv_nsec == b->tv_nsec;
+}
+
+/** Remember the given state of the directory, which the manifest is in sync with. */
+static void
+recordDirectoryState(const struct stat *st)
+{
+    g_manifest.isValid = true;
+    // On file systems with a resolution of one second, another change in the same second
+    // wouldn't change the modification time, so the manifest can't be trusted yet.
+    if (st->st_mtimespec.tv_nsec == 0 && st->st_mtimespec.tv_sec >= time(NULL)) {
+        g_manifest.isValid = false;
+        return;
+    }
+    g_manifest.directoryInode = st->st_ino;
+    g_manifest.directoryModificationTime = st->st_mtimespec;
+}
+
+/** Remember the directory's current state, before the manifest is brought in sync with it. */
+static void
+markManifestInSync(void)
+{
+    struct stat st;
+    g_manifest.isValid = getDirectoryStat(&st);
+    if (g_manifest.isValid) {
+        recordDirectoryState(&st);
+    }
+}
+
+/** Remember the directory's state after the store created a report in it.
+ *
+ * Reports can be written outside the store at any time, so a stat taken after the store's own
+ * change may already include another one, which the manifest would then never pick up. The
+ * directory's modification time is set to the creation time of the newest file, so the state is
+ * only remembered if it still matches the creation time of the store's report. Otherwise, the
+ * manifest is rebuilt on next use.
+ *
+ * @param wasInSync Whether the manifest was in sync with the directory right before the change.
+ *
+ * @param creationTime The creation time of the report the store created.
+ */
+static void
+markManifestInSyncAfterCreating(bool wasInSync, const struct timespec *creationTime)
+{
+    struct stat st;
+    if (wasInSync && getDirectoryStat(&st) && st.st_ino == g_manifest.directoryInode
+        && isSameTime(&st.st_mtimespec, creationTime)) {
+        recordDirectoryState(&st);
+    } else {
+        g_manifest.isValid = false;
+    }
+}
+
+/** Remember the directory's state after the store deleted reports from it.
+ *
+ * Unlike a created report, a deleted one leaves no timestamp to compare the directory's
+ * modification time with. Reports written outside the store take their ID from
+ * sentrycrashcrs_getNextCrashReportPath, so the state is only remembered if no ID was taken while
+ * deleting. A report whose ID was taken before, but that is only created while deleting, is missed
+ * until the manifest is next rebuilt.
+ *
+ * @param wasInSync Whether the manifest was in sync with the directory right before deleting.
+ *
+ * @param nextIDLow The low part of the next report ID right before deleting.
+ */
+static void
+markManifestInSyncAfterDeleting(bool wasInSync, uint32_t nextIDLow)
+{
+    struct stat st;
+    if (wasInSync && getDirectoryStat(&st) && st.st_ino == g_manifest.directoryInode
+        && g_nextUniqueIDLow == nextIDLow) {
+        recordDirectoryState(&st);
+    } else {
+        g_manifest.isValid = false;
+    }
+}
+
+static bool
+appendManifestEntry(int64_t reportID, int64_t size)
+{
+    if (g_manifest.count == g_manifest.capacity) {
+        int newCapacity = g_manifest.capacity == 0 ? 16 : g_manifest.capacity * 2;
+        SentryCrashReportManifestEntry *newEntries = (SentryCrashReportManifestEntry *)realloc(
+            g_manifest.entries, sizeof(*newEntries) * (size_t)newCapacity);
+        if (newEntries == NULL) {
+            SENTRY_ASYNC_SAFE_LOG_ERROR(
+                "Could not grow the report manifest: %s", SENTRY_STRERROR_R(errno));
+            return false;
+        }
+        g_manifest.entries = newEntries;
+        g_manifest.capacity = newCapacity;
+    }
+    g_manifest.entries[g_manifest.count++]
+        = (SentryCrashReportManifestEntry) { .reportID = reportID, .size = size };
+    g_manifest.totalSize += size;
+    return true;
+}
+
+static void
+clearManifest(void)
+{
+    g_manifest.count = 0;
+    g_manifest.totalSize = 0;
+}
+
 static int
-getReportCount(void)
+compareManifestEntries(const void *a, const void *b)
+{
+    return compareInt64(&((const SentryCrashReportManifestEntry *)a)->reportID,
+        &((const SentryCrashReportManifestEntry *)b)->reportID);
+}
+
+/** Keep the manifest sorted after appending a report, whose ID is usually the highest one. IDs are
+ * based on the launch time, so a report from a launch with a wrong clock can be out of order.
+ */
+static void
+sortManifestIfNeeded(void)
 {
-    int count = 0;
+    const int count = g_manifest.count;
+    if (count > 1
+        && g_manifest.entries[count - 1].reportID < g_manifest.entries[count - 2].reportID) {
+        qsort(g_manifest.entries, (size_t)count, sizeof(g_manifest.entries[0]),
+            compareManifestEntries);
+    }
+}
+
+/** Rebuild the manifest from the reports directory.
+ *
+ * @param readSizes Whether to read the size of every report, which is only needed for pruning by
+ * size and costs a stat per report.
+ */
+static void
+rebuildManifest(bool readSizes)
+{
+    SENTRY_ASYNC_SAFE_LOG_DEBUG("Rebuilding report manifest from %s", g_reportsPath);
+    clearManifest();
+    // Take the directory's state before reading it, so that changes made while reading trigger
+    // another rebuild.
+    markManifestInSync();
+
     DIR *dir = opendir(g_reportsPath);
     if (dir == NULL) {
         SENTRY_ASYNC_SAFE_LOG_ERROR("Could not open directory %s", g_reportsPath);
-        goto done;
+        return;
     }
+
     struct dirent *ent;
     while ((ent = readdir(dir)) != NULL) {
-        if (ent->d_type != DT_DIR && getReportIDFromFilename(ent->d_name) > 0) {
-            count++;
+        if (ent->d_type == DT_DIR) {
+            continue;
+        }
+        int64_t reportID = getReportIDFromFilename(ent->d_name);
+        if (reportID <= 0) {
+            continue;
+        }
+        struct stat st;
+        int64_t size
+            = readSizes && fstatat(dirfd(dir), ent->d_name, &st, 0) == 0 ? (int64_t)st.st_size : 0;
+        if (!appendManifestEntry(reportID, size)) {
+            g_manifest.isValid = false;
+            break;
         }
     }
+    closedir(dir);
 
-done:
-    if (dir != NULL) {
-        closedir(dir);
+    if (g_manifest.count > 1) {
+        qsort(g_manifest.entries, (size_t)g_manifest.count, sizeof(g_manifest.entries[0]),
+            compareManifestEntries);
     }
-    return count;
 }
 
-static int
-getReportIDs(int64_t *reportIDs, int count)
+/** Whether nothing changed in the reports directory since the manifest was last in sync with it.
+ * Costs a stat of the directory.
+ */
+static bool
+isManifestInSync(void)
 {
-    int index = 0;
-    DIR *dir = opendir(g_reportsPath);
-    if (dir == NULL) {
-        SENTRY_ASYNC_SAFE_LOG_ERROR("Could not open directory %s", g_reportsPath);
-        goto done;
+    struct stat st;
+    return g_manifest.isValid && getDirectoryStat(&st) && st.st_ino == g_manifest.directoryInode
+        && isSameTime(&st.st_mtimespec, &g_manifest.directoryModificationTime);
+}
+
+/** Bring the manifest in sync with the reports directory. Only costs a stat of the directory if
+ * nothing changed behind the store's back.
+ */
+static void
+syncManifest(void)
+{
+    if (!isManifestInSync()) {
+        rebuildManifest(false);
     }
+}
 
-    struct dirent *ent;
-    while ((ent = readdir(dir)) != NULL && index < count) {
-        int64_t reportID = getReportIDFromFilename(ent->d_name);
-        if (reportID > 0) {
-            reportIDs[index++] = reportID;
+static void
+removeManifestEntry(int64_t reportID)
+{
+    for (int i = 0; i < g_manifest.count; i++) {
+        if (g_manifest.entries[i].reportID == reportID) {
+            g_manifest.totalSize -= g_manifest.entries[i].size;
+            memmove(&g_manifest.entries[i], &g_manifest.entries[i + 1],
+                sizeof(g_manifest.entries[0]) * (size_t)(g_manifest.count - i - 1));
+            g_manifest.count--;
+            return;
         }
     }
+}
 
-    qsort(reportIDs, (unsigned)count, sizeof(reportIDs[0]), compareInt64);
+static void
+deleteReportWithID(int64_t reportID)
+{
+    char path[SentryCrashCRS_MAX_PATH_LENGTH];
+    getCrashReportPathByID(reportID, path);
+    sentrycrashfu_removeFile(path, true);
+    removeManifestEntry(reportID);
+}
 
-done:
-    if (dir != NULL) {
-        closedir(dir);
+static int
+getReportCount(void)
+{
+    syncManifest();
+    return g_manifest.count;
+}
+
+static int
+getReportIDs(int64_t *reportIDs, int count)
+{
+    syncManifest();
+    int index = 0;
+    for (; index < count && index < g_manifest.count; index++) {
+        reportIDs[index] = g_manifest.entries[index].reportID;
     }
     return index;
 }
 
+/** Delete the oldest reports until both the count and the size limit are met. The newest report
+ * is always kept, even if it exceeds the size limit on its own.
+ *
+ * With a size limit, the manifest is always rebuilt first, because the sizes of reports that were
+ * still being written outside the store when they were added to it are outdated.
+ */
 static void
 pruneReports(void)
 {
-    int reportCount = getReportCount();
-    if (reportCount > g_maxReportCount) {
-        int64_t reportIDs[reportCount];
-        reportCount = getReportIDs(reportIDs, reportCount);
+    if (g_maxReportStoreSize > 0) {
+        rebuildManifest(true);
+    } else {
+        syncManifest();
+    }
+    int deleteCount = 0;
+    int64_t remainingSize = g_manifest.totalSize;
+    while (deleteCount < g_manifest.count
+        && (g_manifest.count - deleteCount > g_maxReportCount
+            || (g_maxReportStoreSize > 0 && remainingSize > g_maxReportStoreSize
+                && deleteCount < g_manifest.count - 1))) {
+        remainingSize -= g_manifest.entries[deleteCount].size;
+        deleteCount++;
+    }
+    if (deleteCount == 0) {
+        return;
+    }
 
-        for (int i = 0; i < reportCount - g_maxReportCount; i++) {
-            sentrycrashcrs_deleteReportWithID(reportIDs[i]);
-        }
+    SENTRY_ASYNC_SAFE_LOG_DEBUG("Pruning %d reports", deleteCount);
+    const uint32_t nextIDLow = g_nextUniqueIDLow;
+    const bool wasInSync = isManifestInSync();
+    char path[SentryCrashCRS_MAX_PATH_LENGTH];
+    for (int i = 0; i < deleteCount; i++) {
+        getCrashReportPathByID(g_manifest.entries[i].reportID, path);
+        sentrycrashfu_removeFile(path, true);
     }
+    memmove(&g_manifest.entries[0], &g_manifest.entries[deleteCount],
+        sizeof(g_manifest.entries[0]) * (size_t)(g_manifest.count - deleteCount));
+    g_manifest.count -= deleteCount;
+    g_manifest.totalSize = remainingSize;
+    markManifestInSyncAfterDeleting(wasInSync, nextIDLow);
 }
 
 static int64_t
@@ -294,6 +550,18 @@ sentrycrashcrs_readReport(int64_t reportID)
     return result;
 }
 
+bool
+sentrycrashcrs_mapReport(int64_t reportID, const char **data, int *length)
+{
+    pthread_mutex_lock(&g_mutex);
+    char path[SentryCrashCRS_MAX_PATH_LENGTH];
+    getCrashReportPathByID(reportID, path);
+    // The mapping stays valid even if the report is deleted before it's unmapped.
+    bool result = sentrycrashfu_mapFile(path, data, length, 2000000);
+    pthread_mutex_unlock(&g_mutex);
+    return result;
+}
+
 void
 sentrycrashcrs_getAttachmentsPath_forReportId(int64_t reportID, char *pathBuffer)
 {
@@ -311,9 +579,14 @@ int64_t
 sentrycrashcrs_addUserReport(const char *report, int reportLength)
 {
     pthread_mutex_lock(&g_mutex);
+    syncManifest();
+    const bool wasInSync = g_manifest.isValid;
     int64_t currentID = getNextUniqueID();
     char crashReportPath[SentryCrashCRS_MAX_PATH_LENGTH];
     getCrashReportPathByID(currentID, crashReportPath);
+    int bytesWritten = 0;
+    struct stat reportStat;
+    bool hasReportStat = false;
 
     int fd = open(crashReportPath, O_WRONLY | O_CREAT, 0644);
     if (fd < 0) {
@@ -322,7 +595,7 @@ sentrycrashcrs_addUserReport(const char *report, int reportLength)
         goto done;
     }
 
-    int bytesWritten = (int)write(fd, report, (unsigned)reportLength);
+    bytesWritten = (int)write(fd, report, (unsigned)reportLength);
     if (bytesWritten < 0) {
         SENTRY_ASYNC_SAFE_LOG_ERROR(
             "Could not write to file %s: %s", crashReportPath, SENTRY_STRERROR_R(errno));
@@ -334,7 +607,16 @@ sentrycrashcrs_addUserReport(const char *report, int reportLength)
 
 done:
     if (fd >= 0) {
+        hasReportStat = fstat(fd, &reportStat) == 0;
         close(fd);
+        // The file exists even if writing to it failed, so it counts as a report.
+        if (appendManifestEntry(currentID, bytesWritten > 0 ? bytesWritten : 0)) {
+            sortManifestIfNeeded();
+            markManifestInSyncAfterCreating(
+                wasInSync && hasReportStat, &reportStat.st_birthtimespec);
+        } else {
+            g_manifest.isValid = false;
+        }
     }
     pthread_mutex_unlock(&g_mutex);
 
@@ -346,15 +628,20 @@ sentrycrashcrs_deleteAllReports(void)
 {
     pthread_mutex_lock(&g_mutex);
     sentrycrashfu_deleteContentsOfPath(g_reportsPath);
+    clearManifest();
+    g_manifest.isValid = false;
     pthread_mutex_unlock(&g_mutex);
 }
 
 void
 sentrycrashcrs_deleteReportWithID(int64_t reportID)
 {
-    char path[SentryCrashCRS_MAX_PATH_LENGTH];
-    getCrashReportPathByID(reportID, path);
-    sentrycrashfu_removeFile(path, true);
+    pthread_mutex_lock(&g_mutex);
+    const uint32_t nextIDLow = g_nextUniqueIDLow;
+    const bool wasInSync = isManifestInSync();
+    deleteReportWithID(reportID);
+    markManifestInSyncAfterDeleting(wasInSync, nextIDLow);
+    pthread_mutex_unlock(&g_mutex);
 }
 
 void
@@ -363,4 +650,10 @@ sentrycrashcrs_setMaxReportCount(int maxReportCount)
     g_maxReportCount = maxReportCount;
 }
 
+void
+sentrycrashcrs_setMaxReportStoreSize(int64_t maxReportStoreSize)
+{
+    g_maxReportStoreSize = maxReportStoreSize;
+}
+
 #endif // !SDK_V10
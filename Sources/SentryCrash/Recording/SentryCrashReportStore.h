@@ -32,6 +32,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define SentryCrashCRS_MAX_PATH_LENGTH 500
@@ -83,6 +84,20 @@ void sentrycrashcrs_getCrashReportPathById(int64_t reportId, char *pathBuffer);
  */
 char *sentrycrashcrs_readReport(int64_t reportID);
 
+/** Map a report into memory instead of reading it, so it can be decoded without
+ * copying it.
+ *
+ * @param reportID The report's ID.
+ *
+ * @param data Place to store a pointer to the report, which is NOT null
+ *             terminated. Must be unmapped with sentrycrashfu_unmapFile().
+ *
+ * @param length Place to store the length of the report.
+ *
+ * @return true if the report was mapped.
+ */
+bool sentrycrashcrs_mapReport(int64_t reportID, const char **data, int *length);
+
 /** Gets a report attachments directory for given report id.
  *
  * @param reportID The report's ID.
@@ -123,6 +138,14 @@ void sentrycrashcrs_deleteReportWithID(int64_t reportID);
  */
 void sentrycrashcrs_setMaxReportCount(int maxReportCount);
 
+/** Set the maximum total size in bytes of the reports on disk before old ones
+ * get deleted. The newest report is always kept.
+ *
+ * @param maxReportStoreSize The maximum total size of the reports, or 0 for no
+ * limit.
+ */
+void sentrycrashcrs_setMaxReportStoreSize(int64_t maxReportStoreSize);
+
 #if defined(SENTRY_TEST) || defined(SENTRY_TEST_CI)
 struct tm;
 /** Initialize the report ID generator with UTC time fields for tests. */
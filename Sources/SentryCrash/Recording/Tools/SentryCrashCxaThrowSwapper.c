@@ -59,6 +59,7 @@
 #    include <mach-o/dyld.h>
 #    include <mach-o/nlist.h>
 #    include <mach/mach.h>
+#    include <stdatomic.h>
 #    include <stdint.h>
 #    include <stdio.h>
 #    include <stdlib.h>
@@ -68,20 +69,43 @@
 #    include <unistd.h>
 
 #    include "SentryAsyncSafeLog.h"
+#    include "SentryCrashBinaryImageCache.h"
 #    include "SentryCrashMach-O.h"
 #    include "SentryCrashPlatformSpecificDefines.h"
 
+/** The maximum number of images whose original __cxa_throw can be stored. Must be a power of two.
+ * Apps typically load a few hundred images, so the table stays sparse and lookups short.
+ */
+#    define CXA_ORIGINALS_CAPACITY 2048
+
+/** Marks a slot that a writer claimed but hasn't filled yet. */
+#    define CXA_ORIGINALS_RESERVED ((uintptr_t)1)
+
 typedef struct {
-    uintptr_t image_dli_fbase_address;
+    /** 0 for empty slots. Published last, so readers never see a slot without its function. */
+    _Atomic(uintptr_t) image_dli_fbase_address;
     uintptr_t cxa_throw_original_function;
 } SentryCrashImageToOriginalCxaThrowPair;
 
 static cxa_throw_type g_cxa_throw_handler = NULL;
 static const char *const g_cxa_throw_name = "__cxa_throw";
 
-static SentryCrashImageToOriginalCxaThrowPair *g_cxa_originals = NULL;
-static size_t g_cxa_originals_capacity = 0;
-static size_t g_cxa_originals_count = 0;
+/** Open addressing table with linear probing, keyed by the image base address. Entries are never
+ * removed, so that a throw site in an image that couldn't be unswapped still finds its original.
+ */
+static SentryCrashImageToOriginalCxaThrowPair g_cxa_originals[CXA_ORIGINALS_CAPACITY];
+static _Atomic(size_t) g_cxa_originals_count = 0;
+
+/** dyld has no API to unregister callbacks, so the add image callback is only registered once. */
+static bool g_is_dyld_callback_registered = false;
+
+static size_t
+originalsSlotForImage(uintptr_t image_dli_fbase_address)
+{
+    // Images are page aligned, so the low bits carry no information.
+    const uint64_t page = (uint64_t)image_dli_fbase_address >> 12;
+    return (size_t)((page * 0x9E3779B97F4A7C15ULL) >> 32) & (CXA_ORIGINALS_CAPACITY - 1);
+}
 
 static bool
 getSystemPageSize(uintptr_t *pageSize)
@@ -140,54 +164,53 @@ findOriginalCxaThrowFunction(uintptr_t image_dli_fbase_address)
     SENTRY_ASYNC_SAFE_LOG_TRACE(
         "Finding original __cxa_throw for image with base address %p", image_dli_fbase_address);
 
-    for (size_t i = 0; i < g_cxa_originals_count; i++) {
-        if (g_cxa_originals[i].image_dli_fbase_address == image_dli_fbase_address) {
-            return g_cxa_originals[i].cxa_throw_original_function;
+    size_t slot = originalsSlotForImage(image_dli_fbase_address);
+    for (size_t probe = 0; probe < CXA_ORIGINALS_CAPACITY; probe++) {
+        SentryCrashImageToOriginalCxaThrowPair *pair = &g_cxa_originals[slot];
+        const uintptr_t address
+            = atomic_load_explicit(&pair->image_dli_fbase_address, memory_order_acquire);
+        if (address == image_dli_fbase_address) {
+            return pair->cxa_throw_original_function;
+        }
+        if (address == 0) {
+            break;
         }
+        slot = (slot + 1) & (CXA_ORIGINALS_CAPACITY - 1);
     }
     SENTRY_ASYNC_SAFE_LOG_WARN("Address %p not found", image_dli_fbase_address);
     return (uintptr_t)NULL;
 }
 
-static void
-addPair(SentryCrashImageToOriginalCxaThrowPair pair)
+static bool
+addPair(uintptr_t image_dli_fbase_address, uintptr_t cxa_throw_original_function)
 {
-    uintptr_t originalCxaThrowFunction = findOriginalCxaThrowFunction(pair.image_dli_fbase_address);
-    if (originalCxaThrowFunction != (uintptr_t)NULL) {
-        SENTRY_ASYNC_SAFE_LOG_DEBUG("Already added address pair with image with base address: %p, "
-                                    "and originalCxaThrowFunction: %p",
-            (void *)pair.cxa_throw_original_function, (void *)pair.cxa_throw_original_function);
-        return;
-    }
-
-    SENTRY_ASYNC_SAFE_LOG_DEBUG(
-        "Adding pair for image with base address: %p, and originalCxaThrowFunction: %p",
-        (void *)pair.image_dli_fbase_address, (void *)pair.cxa_throw_original_function);
-
-    if (g_cxa_originals_count == g_cxa_originals_capacity) {
-        g_cxa_originals_capacity *= 2;
-
-        g_cxa_originals = (SentryCrashImageToOriginalCxaThrowPair *)realloc(g_cxa_originals,
-            sizeof(SentryCrashImageToOriginalCxaThrowPair) * g_cxa_originals_capacity);
-
-        // Strictly speaking we should use a temp variable for g_cxa_originals and free
-        // g_cxa_originals in case realloc fails. But if realloc fails for such a small structure
-        // the leak we're causing here is negligible. Ideally, we would need to escalate this and
-        // return an error, because we would free the global structure g_cxa_originals. We
-        // intentionally ignore this edge case in the first iteration of this code.
-
-        if (g_cxa_originals == NULL) {
-            SENTRY_ASYNC_SAFE_LOG_ERROR(
-                "Failed to realloc memory for g_cxa_originals: %s", SENTRY_STRERROR_R(errno));
-            return;
+    size_t slot = originalsSlotForImage(image_dli_fbase_address);
+    for (size_t probe = 0; probe < CXA_ORIGINALS_CAPACITY; probe++) {
+        SentryCrashImageToOriginalCxaThrowPair *pair = &g_cxa_originals[slot];
+        uintptr_t address = 0;
+        if (atomic_compare_exchange_strong_explicit(&pair->image_dli_fbase_address, &address,
+                CXA_ORIGINALS_RESERVED, memory_order_acq_rel, memory_order_acquire)) {
+            SENTRY_ASYNC_SAFE_LOG_DEBUG(
+                "Adding pair for image with base address: %p, and originalCxaThrowFunction: %p",
+                (void *)image_dli_fbase_address, (void *)cxa_throw_original_function);
+            pair->cxa_throw_original_function = cxa_throw_original_function;
+            atomic_store_explicit(
+                &pair->image_dli_fbase_address, image_dli_fbase_address, memory_order_release);
+            atomic_fetch_add_explicit(&g_cxa_originals_count, 1, memory_order_relaxed);
+            return true;
         }
+        if (address == image_dli_fbase_address) {
+            SENTRY_ASYNC_SAFE_LOG_DEBUG(
+                "Already added address pair with image with base address: %p",
+                (void *)image_dli_fbase_address);
+            return true;
+        }
+        slot = (slot + 1) & (CXA_ORIGINALS_CAPACITY - 1);
     }
-    // memcpy here cannot write out of bounds: the realloc above grew g_cxa_originals to
-    // g_cxa_originals_capacity entries, and the surrounding logic (see the loop entry) only
-    // reaches this line when g_cxa_originals_count < g_cxa_originals_capacity, so the indexed
-    // slot is in range. The destination size is the full struct size by construction.
-    memcpy(&g_cxa_originals[g_cxa_originals_count++], &pair,
-        sizeof(SentryCrashImageToOriginalCxaThrowPair));
+    SENTRY_ASYNC_SAFE_LOG_ERROR("No room to store the original __cxa_throw for image with base "
+                                "address %p, not swapping it.",
+        (void *)image_dli_fbase_address);
+    return false;
 }
 
 static void
@@ -204,7 +227,6 @@ __cxa_throw_decorator(void *thrown_exception, void *tinfo, void (*dest)(void *))
     void *backtraceArr[REQUIRED_FRAMES];
     int count = backtrace(backtraceArr, REQUIRED_FRAMES);
 
-    Dl_info info;
     if (count < REQUIRED_FRAMES) {
         // This can happen if the throw happened in a signal handler. This is an edge case we ignore
         // for now. It can also happen with concurrency frameworks for which backtrace does not work
@@ -219,13 +241,24 @@ __cxa_throw_decorator(void *thrown_exception, void *tinfo, void (*dest)(void *))
         return;
     }
 
-    if (dladdr(backtraceArr[REQUIRED_FRAMES - 1], &info) == 0) {
-        SENTRY_ASYNC_SAFE_LOG_ERROR(
-            "dladdr failed for throwsite. Can't identify image of throwsite.");
-        return;
+    // The binary image cache finds the image without taking any lock. Fall back to dladdr, which
+    // takes the dyld lock, if the cache isn't running or doesn't know the image yet.
+    uintptr_t imageBaseAddress;
+    SentryCrashBinaryImage image;
+    if (sentrycrashbic_imageForAddress(
+            (uint64_t)(uintptr_t)backtraceArr[REQUIRED_FRAMES - 1], &image)) {
+        imageBaseAddress = (uintptr_t)image.address;
+    } else {
+        Dl_info info;
+        if (dladdr(backtraceArr[REQUIRED_FRAMES - 1], &info) == 0) {
+            SENTRY_ASYNC_SAFE_LOG_ERROR(
+                "dladdr failed for throwsite. Can't identify image of throwsite.");
+            return;
+        }
+        imageBaseAddress = (uintptr_t)info.dli_fbase;
     }
 
-    uintptr_t function = findOriginalCxaThrowFunction((uintptr_t)info.dli_fbase);
+    uintptr_t function = findOriginalCxaThrowFunction(imageBaseAddress);
     if (function == (uintptr_t)NULL) {
         SENTRY_ASYNC_SAFE_LOG_ERROR(
             "Can't find original cxa_throw for the image of the throwsite.");
@@ -238,8 +271,9 @@ __cxa_throw_decorator(void *thrown_exception, void *tinfo, void (*dest)(void *))
 }
 
 static void
-perform_rebinding_with_section(const section_t *dataSection, intptr_t slide, nlist_t *symtab,
-    char *strtab, uint32_t *indirect_symtab, bool is_swapping_cxa_throw)
+perform_rebinding_with_section(const section_t *dataSection, uintptr_t image_dli_fbase_address,
+    intptr_t slide, nlist_t *symtab, char *strtab, uint32_t *indirect_symtab,
+    bool is_swapping_cxa_throw)
 {
     SENTRY_ASYNC_SAFE_LOG_TRACE(
         "Processing section %s,%s", dataSection->segname, dataSection->sectname);
@@ -285,29 +319,29 @@ perform_rebinding_with_section(const section_t *dataSection, intptr_t slide, nli
         char *symbol_name = strtab + strtab_offset;
         bool symbol_name_longer_than_1 = symbol_name[0] && symbol_name[1];
         if (symbol_name_longer_than_1 && strcmp(&symbol_name[1], g_cxa_throw_name) == 0) {
-            Dl_info info;
-            if (dladdr(dataSection, &info) != 0) {
-                if (is_swapping_cxa_throw) {
-                    // Swapping: Store original and set new handler
-                    SentryCrashImageToOriginalCxaThrowPair pair
-                        = { (uintptr_t)info.dli_fbase, (uintptr_t)indirect_symbol_bindings[i] };
-                    addPair(pair);
+            if (is_swapping_cxa_throw) {
+                // The image can be processed twice when it's loaded while swapping. The decorator
+                // must never be stored as the original, or throwing would recurse forever.
+                if (indirect_symbol_bindings[i] == (void *)__cxa_throw_decorator) {
+                    continue;
+                }
+                // Swapping: Store original and set new handler
+                if (addPair(image_dli_fbase_address, (uintptr_t)indirect_symbol_bindings[i])) {
                     indirect_symbol_bindings[i] = (void *)__cxa_throw_decorator;
                     SENTRY_ASYNC_SAFE_LOG_TRACE("Swapped __cxa_throw function at %p with decorator",
                         (void *)indirect_symbol_bindings[i]);
+                }
+            } else {
+                // Unswapping: Restore original handler
+                uintptr_t original_function = findOriginalCxaThrowFunction(image_dli_fbase_address);
+                if (original_function != (uintptr_t)NULL) {
+                    indirect_symbol_bindings[i] = (void *)original_function;
+                    SENTRY_ASYNC_SAFE_LOG_TRACE("Restored original __cxa_throw function at %p",
+                        (void *)original_function);
                 } else {
-                    // Unswapping: Restore original handler
-                    uintptr_t original_function
-                        = findOriginalCxaThrowFunction((uintptr_t)info.dli_fbase);
-                    if (original_function != (uintptr_t)NULL) {
-                        indirect_symbol_bindings[i] = (void *)original_function;
-                        SENTRY_ASYNC_SAFE_LOG_TRACE("Restored original __cxa_throw function at %p",
-                            (void *)original_function);
-                    } else {
-                        SENTRY_ASYNC_SAFE_LOG_WARN("Can't unswap original __cxa_throw function for "
-                                                   "image with base address %p",
-                            (void *)info.dli_fbase);
-                    }
+                    SENTRY_ASYNC_SAFE_LOG_WARN("Can't unswap original __cxa_throw function for "
+                                               "image with base address %p",
+                        (void *)image_dli_fbase_address);
                 }
             }
         }
@@ -347,12 +381,12 @@ process_segment(const struct mach_header *header, intptr_t slide, const char *se
             segment, S_NON_LAZY_SYMBOL_POINTERS);
 
         if (lazy_sym_sect != NULL) {
-            perform_rebinding_with_section(
-                lazy_sym_sect, slide, symtab, strtab, indirect_symtab, is_swapping_cxa_throw);
+            perform_rebinding_with_section(lazy_sym_sect, (uintptr_t)header, slide, symtab, strtab,
+                indirect_symtab, is_swapping_cxa_throw);
         }
         if (non_lazy_sym_sect != NULL) {
-            perform_rebinding_with_section(
-                non_lazy_sym_sect, slide, symtab, strtab, indirect_symtab, is_swapping_cxa_throw);
+            perform_rebinding_with_section(non_lazy_sym_sect, (uintptr_t)header, slide, symtab,
+                strtab, indirect_symtab, is_swapping_cxa_throw);
         }
     } else {
         SENTRY_ASYNC_SAFE_LOG_WARN("Segment %s not found", segname);
@@ -373,15 +407,10 @@ rebind_symbols_for_image(
         return;
     }
 
-    SENTRY_ASYNC_SAFE_LOG_TRACE("Rebinding symbols for image with slide %p", (void *)slide);
-
-    Dl_info info;
-    if (dladdr(header, &info) == 0) {
-        SENTRY_ASYNC_SAFE_LOG_WARN("dladdr failed");
-        return;
-    }
-
-    SENTRY_ASYNC_SAFE_LOG_DEBUG("Image name: %s", info.dli_fname);
+    // The header is the image base address, which is what dladdr would return as dli_fbase. Not
+    // calling dladdr avoids taking the dyld lock for every loaded image.
+    SENTRY_ASYNC_SAFE_LOG_TRACE(
+        "Rebinding symbols for image at %p with slide %p", (void *)header, (void *)slide);
 
     const struct symtab_command *symtab_cmd
         = (struct symtab_command *)sentrycrash_macho_getCommandByTypeFromHeader(
@@ -416,6 +445,10 @@ typedef void (*dyld_image_callback)(const struct mach_header *mh, intptr_t vmadd
 static void
 rebind_symbols_for_image_wrapper(const struct mach_header *mh, intptr_t vmaddr_slide)
 {
+    // Images loaded while unswapped are rebound by the next call to sentrycrashct_swap_cxa_throw.
+    if (g_cxa_throw_handler == NULL) {
+        return;
+    }
     rebind_symbols_for_image(mh, vmaddr_slide, true);
 }
 
@@ -429,26 +462,21 @@ sentrycrashct_swap_cxa_throw(const cxa_throw_type handler)
 
     SENTRY_ASYNC_SAFE_LOG_TRACE("Swapping __cxa_throw.");
 
-    if (g_cxa_originals == NULL) {
-        g_cxa_originals_count = 0;
-        g_cxa_originals_capacity = 25;
-        g_cxa_originals = (SentryCrashImageToOriginalCxaThrowPair *)malloc(
-            sizeof(SentryCrashImageToOriginalCxaThrowPair) * g_cxa_originals_capacity);
-        if (g_cxa_originals == NULL) {
-            SENTRY_ASYNC_SAFE_LOG_ERROR(
-                "Failed to allocate memory for g_cxa_originals: %s", SENTRY_STRERROR_R(errno));
-            return -1;
-        }
+    const bool isSwapped = g_cxa_throw_handler != NULL;
+    g_cxa_throw_handler = handler;
+    if (isSwapped) {
+        // All images already call the decorator, which picks up the new handler on the next throw.
+        return 0;
     }
 
-    if (g_cxa_throw_handler == NULL) {
-        g_cxa_throw_handler = handler;
+    if (!g_is_dyld_callback_registered) {
+        // dyld calls the callback right away for every loaded image, and later on for every image
+        // that gets loaded, so each image is only rebound once.
+        g_is_dyld_callback_registered = true;
         _dyld_register_func_for_add_image(rebind_symbols_for_image_wrapper);
     } else {
-        g_cxa_throw_handler = handler;
-
-        // Call _dyld_image_count inside the loop in case images get loaded or unloaded while
-        // iterating.
+        // The images were restored by sentrycrashct_unswap_cxa_throw. Call _dyld_image_count
+        // inside the loop in case images get loaded or unloaded while iterating.
         for (uint32_t i = 0; i < _dyld_image_count(); i++) {
             const struct mach_header *header = _dyld_get_image_header(i);
             intptr_t slide = _dyld_get_image_vmaddr_slide(i);
@@ -457,8 +485,7 @@ sentrycrashct_swap_cxa_throw(const cxa_throw_type handler)
                 continue;
             }
 
-            rebind_symbols_for_image(
-                _dyld_get_image_header(i), _dyld_get_image_vmaddr_slide(i), true);
+            rebind_symbols_for_image(header, slide, true);
         }
     }
     return 0;
@@ -467,7 +494,8 @@ sentrycrashct_swap_cxa_throw(const cxa_throw_type handler)
 int
 sentrycrashct_unswap_cxa_throw(void)
 {
-    if (g_cxa_throw_handler == NULL || g_cxa_originals == NULL || g_cxa_originals_count == 0) {
+    if (g_cxa_throw_handler == NULL
+        || atomic_load_explicit(&g_cxa_originals_count, memory_order_relaxed) == 0) {
         SENTRY_ASYNC_SAFE_LOG_INFO("No original __cxa_throw handlers to restore");
         return -1;
     }
@@ -32,11 +32,14 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 /** Buffer size to use in the "writeFmt" functions.
@@ -340,6 +343,65 @@ done:
     return isSuccessful;
 }
 
+bool
+sentrycrashfu_mapFile(const char *const path, const char **data, int *length, int maxLength)
+{
+    bool isSuccessful = false;
+    void *mem = NULL;
+    int fileLength = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        SENTRY_ASYNC_SAFE_LOG_ERROR("Could not open %s: %s", path, SENTRY_STRERROR_R(errno));
+        goto done;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        SENTRY_ASYNC_SAFE_LOG_ERROR("Could not fstat %s: %s", path, SENTRY_STRERROR_R(errno));
+        goto done;
+    }
+    if (st.st_size > INT_MAX || (maxLength > 0 && st.st_size > maxLength)) {
+        SENTRY_ASYNC_SAFE_LOG_ERROR(
+            "%s is too large to map (%lld bytes)", path, (long long)st.st_size);
+        goto done;
+    }
+    fileLength = (int)st.st_size;
+
+    // mmap fails for empty files, so there is nothing to map.
+    if (fileLength == 0) {
+        isSuccessful = true;
+        goto done;
+    }
+
+    mem = mmap(NULL, (size_t)fileLength, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mem == MAP_FAILED) {
+        SENTRY_ASYNC_SAFE_LOG_ERROR("Could not map %s: %s", path, SENTRY_STRERROR_R(errno));
+        mem = NULL;
+        goto done;
+    }
+    // Decoders read the file front to back.
+    madvise(mem, (size_t)fileLength, MADV_SEQUENTIAL);
+    isSuccessful = true;
+
+done:
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    *data = mem;
+    *length = isSuccessful ? fileLength : 0;
+    return isSuccessful;
+}
+
+void
+sentrycrashfu_unmapFile(const char *data, int length)
+{
+    if (data != NULL && length > 0) {
+        munmap((void *)data, (size_t)length);
+    }
+}
+
 bool
 sentrycrashfu_writeStringToFD(const int fd, const char *const string)
 {
@@ -516,6 +578,47 @@ sentrycrashfu_deleteContentsOfPath(const char *path)
     return deletePathContents(path, false);
 }
 
+/** Write all of the data described by an I/O vector, with as few system calls as possible.
+ * writev is a plain system call just like write, so it's async-signal-safe in practice.
+ *
+ * @param writer The writer whose file to write to.
+ *
+ * @param iov The I/O vector, which is modified to keep track of partial writes.
+ *
+ * @param iovCount The number of elements in the I/O vector.
+ *
+ * @return True if all of the data was written.
+ */
+static bool
+writeVectorToBufferedWriter(SentryCrashBufferedWriter *writer, struct iovec *iov, int iovCount)
+{
+    while (iovCount > 0) {
+        ssize_t bytesWritten = writev(writer->fd, iov, iovCount);
+        writer->writeCalls++;
+        if (bytesWritten < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytesWritten <= 0) {
+            SENTRY_ASYNC_SAFE_LOG_ERROR(
+                "Could not write to fd %d: %s", writer->fd, SENTRY_STRERROR_R(errno));
+            return false;
+        }
+        writer->bytesWritten += bytesWritten;
+
+        // Skip the elements that were written completely and the written part of the next one.
+        while (iovCount > 0 && (size_t)bytesWritten >= iov->iov_len) {
+            bytesWritten -= (ssize_t)iov->iov_len;
+            iov++;
+            iovCount--;
+        }
+        if (iovCount > 0) {
+            iov->iov_base = (char *)iov->iov_base + bytesWritten;
+            iov->iov_len -= (size_t)bytesWritten;
+        }
+    }
+    return true;
+}
+
 bool
 sentrycrashfu_openBufferedWriter(SentryCrashBufferedWriter *writer, const char *const path,
     char *writeBuffer, int writeBufferLength)
@@ -523,6 +626,8 @@ sentrycrashfu_openBufferedWriter(SentryCrashBufferedWriter *writer, const char *
     writer->buffer = writeBuffer;
     writer->bufferLength = writeBufferLength;
     writer->position = 0;
+    writer->writeCalls = 0;
+    writer->bytesWritten = 0;
     writer->fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
     if (writer->fd < 0) {
         SENTRY_ASYNC_SAFE_LOG_ERROR(
@@ -547,14 +652,16 @@ sentrycrashfu_writeBufferedWriter(
     SentryCrashBufferedWriter *writer, const char *restrict const data, const int length)
 {
     if (length > writer->bufferLength - writer->position) {
-        sentrycrashfu_flushBufferedWriter(writer);
-    }
-    if (length > writer->bufferLength) {
-        return sentrycrashfu_writeBytesToFD(writer->fd, data, length);
+        // Write the buffered data and the new data with a single system call rather than
+        // flushing the buffer first.
+        struct iovec iov[2] = {
+            { .iov_base = writer->buffer, .iov_len = (size_t)writer->position },
+            { .iov_base = (void *)data, .iov_len = (size_t)length },
+        };
+        writer->position = 0;
+        return writeVectorToBufferedWriter(writer, iov, 2);
     }
-    // memcpy here cannot write out of bounds: the flush above resets writer->position to 0 if
-    // length would otherwise overflow the remaining buffer, and the second check returns
-    // early when length itself exceeds the entire buffer. After both checks we are guaranteed
+    // memcpy here cannot write out of bounds: the check above guarantees
     // length <= writer->bufferLength - writer->position, which is exactly the space remaining
     // at writer->buffer + writer->position.
     memcpy(writer->buffer + writer->position, data, length);
@@ -566,7 +673,8 @@ bool
 sentrycrashfu_flushBufferedWriter(SentryCrashBufferedWriter *writer)
 {
     if (writer->fd > 0 && writer->position > 0) {
-        if (!sentrycrashfu_writeBytesToFD(writer->fd, writer->buffer, writer->position)) {
+        struct iovec iov = { .iov_base = writer->buffer, .iov_len = (size_t)writer->position };
+        if (!writeVectorToBufferedWriter(writer, &iov, 1)) {
             return false;
         }
         writer->position = 0;
@@ -38,6 +38,7 @@ extern "C" {
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define SentryCrashFU_MAX_PATH_LENGTH 500
 
@@ -89,6 +90,30 @@ bool sentrycrashfu_readBytesFromFD(const int fd, char *bytes, int length);
  */
 bool sentrycrashfu_readEntireFile(const char *path, char **data, int *length, int maxLength);
 
+/** Map an entire file into memory for reading. Unlike sentrycrashfu_readEntireFile(),
+ * this doesn't copy the file, and only the pages that are accessed are read.
+ *
+ * @param path The path to the file.
+ *
+ * @param data Place to store a pointer to the mapped data, which is NOT null
+ *             terminated. Must be unmapped with sentrycrashfu_unmapFile().
+ *
+ * @param length Place to store the length of the mapped data.
+ *
+ * @param maxLength Files larger than this aren't mapped. 0 = no maximum.
+ *
+ * @return true if the operation was successful.
+ */
+bool sentrycrashfu_mapFile(const char *path, const char **data, int *length, int maxLength);
+
+/** Unmap a file mapped with sentrycrashfu_mapFile().
+ *
+ * @param data The mapped data.
+ *
+ * @param length The length of the mapped data.
+ */
+void sentrycrashfu_unmapFile(const char *data, int length);
+
 /** Write a string to a file.
  *
  * @param fd The file descriptor.
@@ -173,12 +198,16 @@ bool sentrycrashfu_removeFile(const char *path, bool mustExist);
 bool sentrycrashfu_deleteContentsOfPath(const char *path);
 
 /** Buffered writer structure. Everything inside should be considered internal
- * use only. */
+ * use only, except for the statistics, which may be read. */
 typedef struct {
     char *buffer;
     int bufferLength;
     int position;
     int fd;
+    /** The number of write system calls made. */
+    int writeCalls;
+    /** The number of bytes written to the file. */
+    int64_t bytesWritten;
 } SentryCrashBufferedWriter;
 
 /** Open a file for buffered writing.
@@ -202,7 +231,8 @@ bool sentrycrashfu_openBufferedWriter(SentryCrashBufferedWriter *writer, const c
  */
 void sentrycrashfu_closeBufferedWriter(SentryCrashBufferedWriter *writer);
 
-/** Write to a buffered writer.
+/** Write to a buffered writer. Data that doesn't fit in the buffer is written
+ * together with the buffered data, in a single system call.
  *
  * @param writer The writer to write to.
  *
@@ -38,6 +38,12 @@
 #include <string.h>
 #include <unistd.h>
 
+#if defined(__aarch64__)
+#    include <arm_neon.h>
+#elif defined(__SSE2__)
+#    include <emmintrin.h>
+#endif
+
 // ============================================================================
 #pragma mark - Configuration -
 // ============================================================================
@@ -61,6 +67,13 @@
 #    define SentryCrashJSONCODEC_WorkBufferSize 512
 #endif
 
+/** Runs of characters that don't need escaping longer than this are passed to the data handler
+ * directly instead of being copied to the work buffer.
+ */
+#ifndef SentryCrashJSONCODEC_MaxCopiedRunLength
+#    define SentryCrashJSONCODEC_MaxCopiedRunLength 32
+#endif
+
 // ============================================================================
 #pragma mark - Helpers -
 // ============================================================================
@@ -109,7 +122,80 @@ sentrycrashjson_stringForError(const int error)
  */
 #define addJSONData(CONTEXT, DATA, LENGTH) (CONTEXT)->addJSONData(DATA, LENGTH, (CONTEXT)->userData)
 
-/** Escape a string portion for use with JSON and send to data handler.
+/** Find the first character in a string that must be escaped in JSON: a quote, a backslash or a
+ * control character. Scans 16 bytes at a time where the CPU supports it.
+ *
+ * @param src The start of the string.
+ *
+ * @param srcEnd The end of the string.
+ *
+ * @return A pointer to the first character to escape, or srcEnd if there is none.
+ */
+static inline const char *
+findCharacterToEscape(const char *src, const char *const srcEnd)
+{
+#if defined(__aarch64__)
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(' ');
+    for (; srcEnd - src >= 16; src += 16) {
+        const uint8x16_t chars = vld1q_u8((const uint8_t *)src);
+        const uint8x16_t isQuote = vceqq_u8(chars, quote);
+        const uint8x16_t isBackslash = vceqq_u8(chars, backslash);
+        const uint8x16_t isControl = vcltq_u8(chars, space);
+        const uint8x16_t matches = vorrq_u8(vorrq_u8(isQuote, isBackslash), isControl);
+        // Narrow each byte of the comparison to a nybble, so the index of the first match is
+        // the number of trailing zero bits divided by 4.
+        const uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+        unlikely_if(mask != 0) { return src + (__builtin_ctzll(mask) >> 2); }
+    }
+#elif defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i maxControl = _mm_set1_epi8(' ' - 1);
+    for (; srcEnd - src >= 16; src += 16) {
+        const __m128i chars = _mm_loadu_si128((const __m128i *)src);
+        // SSE2 only compares signed bytes, so compare the unsigned minimum to find control
+        // characters without matching UTF-8 continuation bytes.
+        const __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chars, maxControl), chars));
+        const int mask = _mm_movemask_epi8(matches);
+        unlikely_if(mask != 0) { return src + __builtin_ctz((unsigned)mask); }
+    }
+#endif
+    for (; src < srcEnd; src++) {
+        unlikely_if(*src == '\\' || *src == '\"' || (unsigned char)*src < ' ') { break; }
+    }
+    return src;
+}
+
+/** Send the escaped characters collected in the work buffer to the data handler.
+ *
+ * @param context The JSON context.
+ *
+ * @param workBuffer The work buffer.
+ *
+ * @param dst The end of the data in the work buffer, which is reset to its start.
+ *
+ * @return SentryCrashJSON_OK if the data was handled successfully.
+ */
+static int
+flushWorkBuffer(
+    SentryCrashJSONEncodeContext *const context, char *const workBuffer, char **const dst)
+{
+    const int length = (int)(*dst - workBuffer);
+    *dst = workBuffer;
+    unlikely_if(length == 0) { return SentryCrashJSON_OK; }
+    return addJSONData(context, workBuffer, length);
+}
+
+/** Escape a string for use with JSON and send to data handler.
+ *
+ * Runs of characters that don't need escaping are sent to the data handler as is. Escape
+ * sequences, and short runs between them, are collected in a work buffer first so that strings
+ * with many escapes don't cause a call to the data handler for every character.
  *
  * @param context The JSON context.
  *
@@ -120,91 +206,85 @@ sentrycrashjson_stringForError(const int error)
  * @return SentryCrashJSON_OK if the data was handled successfully.
  */
 static int
-appendEscapedString(
+addEscapedString(
     SentryCrashJSONEncodeContext *const context, const char *restrict const string, int length)
 {
     char workBuffer[SentryCrashJSONCODEC_WorkBufferSize];
+    char *const workBufferEnd = workBuffer + sizeof(workBuffer);
+    char *dst = workBuffer;
+    const char *src = string;
     const char *const srcEnd = string + length;
+    int result = SentryCrashJSON_OK;
 
-    const char *restrict src = string;
-    char *restrict dst = workBuffer;
-
-    // Simple case (no escape or special characters)
-    for (; src < srcEnd && *src != '\\' && *src != '\"' && (unsigned char)*src >= ' '; src++) {
-        *dst++ = *src;
-    }
+    while (src < srcEnd) {
+        const char *const runEnd = findCharacterToEscape(src, srcEnd);
+        const int runLength = (int)(runEnd - src);
+        likely_if(runLength > SentryCrashJSONCODEC_MaxCopiedRunLength)
+        {
+            unlikely_if((result = flushWorkBuffer(context, workBuffer, &dst))
+                != SentryCrashJSON_OK)
+            {
+                return result;
+            }
+            unlikely_if((result = addJSONData(context, src, runLength)) != SentryCrashJSON_OK)
+            {
+                return result;
+            }
+        }
+        else if (runLength > 0)
+        {
+            unlikely_if(workBufferEnd - dst < runLength)
+            {
+                unlikely_if((result = flushWorkBuffer(context, workBuffer, &dst))
+                    != SentryCrashJSON_OK)
+                {
+                    return result;
+                }
+            }
+            memcpy(dst, src, (size_t)runLength);
+            dst += runLength;
+        }
+        src = runEnd;
+        unlikely_if(src >= srcEnd) { break; }
 
-    // Deal with complicated case (if any)
-    for (; src < srcEnd; src++) {
+        char escaped;
         switch (*src) {
         case '\\':
         case '\"':
-            *dst++ = '\\';
-            *dst++ = *src;
+            escaped = *src;
             break;
         case '\b':
-            *dst++ = '\\';
-            *dst++ = 'b';
+            escaped = 'b';
             break;
         case '\f':
-            *dst++ = '\\';
-            *dst++ = 'f';
+            escaped = 'f';
             break;
         case '\n':
-            *dst++ = '\\';
-            *dst++ = 'n';
+            escaped = 'n';
             break;
         case '\r':
-            *dst++ = '\\';
-            *dst++ = 'r';
+            escaped = 'r';
             break;
         case '\t':
-            *dst++ = '\\';
-            *dst++ = 't';
+            escaped = 't';
             break;
         default:
-            unlikely_if((unsigned char)*src < ' ')
-            {
-                SENTRY_ASYNC_SAFE_LOG_DEBUG("Invalid character 0x%02x in string: %s", *src, string);
-                return SentryCrashJSON_ERROR_INVALID_CHARACTER;
-            }
-            *dst++ = *src;
+            SENTRY_ASYNC_SAFE_LOG_DEBUG("Invalid character 0x%02x in string: %s", *src, string);
+            return SentryCrashJSON_ERROR_INVALID_CHARACTER;
         }
-    }
-    int encLength = (int)(dst - workBuffer);
-    dst -= encLength;
-    return addJSONData(context, dst, encLength);
-}
-
-/** Escape a string for use with JSON and send to data handler.
- *
- * @param context The JSON context.
- *
- * @param string The string to escape and write.
- *
- * @param length The length of the string.
- *
- * @return SentryCrashJSON_OK if the data was handled successfully.
- */
-static int
-addEscapedString(
-    SentryCrashJSONEncodeContext *const context, const char *restrict const string, int length)
-{
-    int result = SentryCrashJSON_OK;
-
-    // Keep adding portions until the whole string has been processed.
-    int offset = 0;
-    while (offset < length) {
-        int toAdd = length - offset;
-        unlikely_if(toAdd > SentryCrashJSONCODEC_WorkBufferSize / 2)
+        unlikely_if(workBufferEnd - dst < 2)
         {
-            toAdd = SentryCrashJSONCODEC_WorkBufferSize / 2;
+            unlikely_if((result = flushWorkBuffer(context, workBuffer, &dst))
+                != SentryCrashJSON_OK)
+            {
+                return result;
+            }
         }
-        result = appendEscapedString(context, string + offset, toAdd);
-        unlikely_if(result != SentryCrashJSON_OK) { break; }
-        offset += toAdd;
+        *dst++ = '\\';
+        *dst++ = escaped;
+        src++;
     }
-    return result;
+    return flushWorkBuffer(context, workBuffer, &dst);
 }
 
 /** Escape and quote a string for use with JSON and send to data handler.
@@ -876,10 +956,34 @@ static int writeUTF8(unsigned int character, char **dst);
  *
  * @param dstBufferLength Length of the destination buffer.
  *
+ * @param decodedLength If not NULL, will contain the length of the decoded string.
+ *
+ * @return SentryCrashJSON_OK if successful.
+ */
+static int decodeString(SentryCrashJSONDecodeContext *context, char *dstBuffer,
+    int dstBufferLength, int *decodedLength);
+
+/** Decode a string value without copying it if it contains no escape sequences.
+ *
+ * @param context The decoding context.
+ *
+ * @param value Will point to the string, either in the decoded data or in the string buffer.
+ *
+ * @param length Will contain the length of the string.
+ *
  * @return SentryCrashJSON_OK if successful.
  */
-static int decodeString(
-    SentryCrashJSONDecodeContext *context, char *dstBuffer, int dstBufferLength);
+static int decodeStringSlice(
+    SentryCrashJSONDecodeContext *context, const char **value, int *length);
+
+/** Skip past the contents of the container whose opening bracket was just consumed, including
+ * its closing bracket.
+ *
+ * @param context The decoding context.
+ *
+ * @return SentryCrashJSON_OK if successful.
+ */
+static int skipContainer(SentryCrashJSONDecodeContext *context);
 
 /** Decode a JSON element.
  *
@@ -970,7 +1074,8 @@ writeUTF8(unsigned int character, char **dst)
 }
 
 static int
-decodeString(SentryCrashJSONDecodeContext *context, char *dstBuffer, int dstBufferLength)
+decodeString(SentryCrashJSONDecodeContext *context, char *dstBuffer, int dstBufferLength,
+    int *decodedLength)
 {
     *dstBuffer = '\0';
     unlikely_if(*context->bufferPtr != '\"')
@@ -1014,6 +1119,9 @@ decodeString(SentryCrashJSONDecodeContext *context, char *dstBuffer, int dstBuff
         // entirely within context->buffer, so the read is in-bounds as well.
         memcpy(dstBuffer, src, length);
         dstBuffer[length] = 0;
+        if (decodedLength != NULL) {
+            *decodedLength = length;
+        }
         return SentryCrashJSON_OK;
     }
 
@@ -1112,9 +1220,76 @@ decodeString(SentryCrashJSONDecodeContext *context, char *dstBuffer, int dstBuff
     }
 
     *dst = 0;
+    if (decodedLength != NULL) {
+        *decodedLength = (int)(dst - dstBuffer);
+    }
+    return SentryCrashJSON_OK;
+}
+
+static int
+decodeStringSlice(SentryCrashJSONDecodeContext *context, const char **value, int *length)
+{
+    unlikely_if(*context->bufferPtr != '\"')
+    {
+        SENTRY_ASYNC_SAFE_LOG_DEBUG("Expected '\"' but got '%c'", *context->bufferPtr);
+        return SentryCrashJSON_ERROR_INVALID_CHARACTER;
+    }
+
+    const char *const start = context->bufferPtr + 1;
+    const char *src = start;
+    for (; src < context->bufferEnd && *src != '\"'; src++) {
+        unlikely_if(*src == '\\')
+        {
+            // Escape sequences must be decoded into the string buffer.
+            *value = context->stringBuffer;
+            return decodeString(
+                context, context->stringBuffer, context->stringBufferLength, length);
+        }
+    }
+    unlikely_if(src >= context->bufferEnd)
+    {
+        SENTRY_ASYNC_SAFE_LOG_DEBUG("Premature end of data");
+        return SentryCrashJSON_ERROR_INCOMPLETE;
+    }
+
+    *value = start;
+    *length = (int)(src - start);
+    context->bufferPtr = src + 1;
     return SentryCrashJSON_OK;
 }
 
+static int
+skipContainer(SentryCrashJSONDecodeContext *context)
+{
+    // Brackets can't be mismatched in valid JSON, so it's enough to count them.
+    int depth = 1;
+    for (const char *src = context->bufferPtr; src < context->bufferEnd; src++) {
+        switch (*src) {
+        case '\"':
+            for (src++; src < context->bufferEnd && *src != '\"'; src++) {
+                unlikely_if(*src == '\\') { src++; }
+            }
+            break;
+        case '[':
+        case '{':
+            depth++;
+            break;
+        case ']':
+        case '}':
+            unlikely_if(--depth == 0)
+            {
+                context->bufferPtr = src + 1;
+                return SentryCrashJSON_OK;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    SENTRY_ASYNC_SAFE_LOG_DEBUG("Premature end of data");
+    return SentryCrashJSON_ERROR_INCOMPLETE;
+}
+
 static int
 decodeElement(const char *const name, SentryCrashJSONDecodeContext *context)
 {
@@ -1132,6 +1307,7 @@ decodeElement(const char *const name, SentryCrashJSONDecodeContext *context)
     case '[': {
         context->bufferPtr++;
         result = context->callbacks->onBeginArray(name, context->userData);
+        unlikely_if(result == SentryCrashJSON_SKIP_CONTAINER) return skipContainer(context);
         unlikely_if(result != SentryCrashJSON_OK) return result;
         while (context->bufferPtr < context->bufferEnd) {
             SKIP_WHITESPACE(context);
@@ -1153,6 +1329,7 @@ decodeElement(const char *const name, SentryCrashJSONDecodeContext *context)
     case '{': {
         context->bufferPtr++;
         result = context->callbacks->onBeginObject(name, context->userData);
+        unlikely_if(result == SentryCrashJSON_SKIP_CONTAINER) return skipContainer(context);
         unlikely_if(result != SentryCrashJSON_OK) return result;
         while (context->bufferPtr < context->bufferEnd) {
             SKIP_WHITESPACE(context);
@@ -1162,7 +1339,7 @@ decodeElement(const char *const name, SentryCrashJSONDecodeContext *context)
                 context->bufferPtr++;
                 return context->callbacks->onEndContainer(context->userData);
             }
-            result = decodeString(context, context->nameBuffer, context->nameBufferLength);
+            result = decodeString(context, context->nameBuffer, context->nameBufferLength, NULL);
             unlikely_if(result != SentryCrashJSON_OK) return result;
             SKIP_WHITESPACE(context);
             unlikely_if(context->bufferPtr >= context->bufferEnd) { break; }
@@ -1183,7 +1360,16 @@ decodeElement(const char *const name, SentryCrashJSONDecodeContext *context)
         return SentryCrashJSON_ERROR_INCOMPLETE;
     }
     case '\"': {
-        result = decodeString(context, context->stringBuffer, context->stringBufferLength);
+        likely_if(context->callbacks->onStringSliceElement != NULL)
+        {
+            const char *value;
+            int length;
+            result = decodeStringSlice(context, &value, &length);
+            unlikely_if(result != SentryCrashJSON_OK) return result;
+            return context->callbacks->onStringSliceElement(
+                name, value, length, context->userData);
+        }
+        result = decodeString(context, context->stringBuffer, context->stringBufferLength, NULL);
         unlikely_if(result != SentryCrashJSON_OK) return result;
         result
             = context->callbacks->onStringElement(name, context->stringBuffer, context->userData);
@@ -1482,6 +1668,16 @@ addJSONFromFile_onStringElement(
     return result;
 }
 
+static int
+addJSONFromFile_onStringSliceElement(
+    const char *const name, const char *const value, const int length, void *const userData)
+{
+    JSONFromFileContext *context = (JSONFromFileContext *)userData;
+    int result = sentrycrashjson_addStringElement(context->encodeContext, name, value, length);
+    context->updateDecoderCallback(context);
+    return result;
+}
+
 static int
 addJSONFromFile_onBeginObject(const char *const name, void *const userData)
 {
@@ -1592,6 +1788,8 @@ sentrycrashjson_addJSONElement(SentryCrashJSONEncodeContext *const encodeContext
         .onUIntegerElement = addJSONFromFile_onUIntegerElement,
         .onNullElement = addJSONFromFile_onNullElement,
         .onStringElement = addJSONFromFile_onStringElement,
+        // The whole document is in memory, so strings can be passed on without copying them.
+        .onStringSliceElement = addJSONFromFile_onStringSliceElement,
     };
     char nameBuffer[100] = { 0 };
     char stringBuffer[5000] = { 0 };
@@ -70,6 +70,13 @@ enum {
      * semantic or structural reasons.
      */
     SentryCrashJSON_ERROR_INVALID_DATA = 5,
+
+    /** Decoding: Not an error. Meant to be returned by the onBeginObject or
+     * onBeginArray callback to skip over the container's contents without
+     * decoding them. No further callbacks are called for the container,
+     * including onEndContainer.
+     */
+    SentryCrashJSON_SKIP_CONTAINER = 6,
 };
 
 /** Get a description for an error code.
@@ -388,7 +395,8 @@ int sentrycrashjson_addJSONFromFile(SentryCrashJSONEncodeContext *const context,
 
 /**
  * Callbacks called during a JSON decode process.
- * All function pointers must point to valid functions.
+ * All function pointers must point to valid functions, except for
+ * onStringSliceElement, which may be NULL.
  */
 typedef struct SentryCrashJSONDecodeCallbacks {
     /** Called when a boolean element is decoded.
@@ -467,6 +475,23 @@ typedef struct SentryCrashJSONDecodeCallbacks {
      */
     int (*onStringElement)(const char *name, const char *value, void *userData);
 
+    /** If set, called instead of onStringElement when a string element is
+     * decoded. Strings without escape sequences are not copied: the value then
+     * points directly into the data being decoded.
+     *
+     * @param name The element's name.
+     *
+     * @param value The element's value. It is NOT null terminated.
+     *
+     * @param length The length of the value.
+     *
+     * @param userData Data that was specified when calling
+     * sentrycrashjson_decode().
+     *
+     * @return SentryCrashJSON_OK if decoding should continue.
+     */
+    int (*onStringSliceElement)(const char *name, const char *value, int length, void *userData);
+
     /** Called when a new object is encountered.
      *
      * @param name The object's name.
@@ -474,7 +499,8 @@ typedef struct SentryCrashJSONDecodeCallbacks {
      * @param userData Data that was specified when calling
      * sentrycrashjson_decode().
      *
-     * @return SentryCrashJSON_OK if decoding should continue.
+     * @return SentryCrashJSON_OK if decoding should continue, or
+     * SentryCrashJSON_SKIP_CONTAINER to skip the object's contents.
      */
     int (*onBeginObject)(const char *name, void *userData);
 
@@ -485,7 +511,8 @@ typedef struct SentryCrashJSONDecodeCallbacks {
      * @param userData Data that was specified when calling
      * sentrycrashjson_decode().
      *
-     * @return SentryCrashJSON_OK if decoding should continue.
+     * @return SentryCrashJSON_OK if decoding should continue, or
+     * SentryCrashJSON_SKIP_CONTAINER to skip the array's contents.
      */
     int (*onBeginArray)(const char *name, void *userData);
 
@@ -512,7 +539,8 @@ typedef struct SentryCrashJSONDecodeCallbacks {
 
 /** Read a JSON encoded file from the specified FD.
  *
- * @param data UTF-8 encoded JSON data.
+ * @param data UTF-8 encoded JSON data. It doesn't need to be null terminated,
+ *             so it can point to a memory mapped file.
  *
  * @param length Length of the data.
  *
@@ -125,7 +125,7 @@
     if ((self = [super init])) {
         self.containerStack = [NSMutableArray array];
 
-        self.callbacks = malloc(sizeof(*self.callbacks));
+        self.callbacks = calloc(1, sizeof(*self.callbacks));
         // Unlikely malloc failure.
         NSAssert(self.callbacks != NULL, @"Could not allocate callbacks");
         if (self.callbacks == NULL) {
@@ -143,6 +143,7 @@
         self.callbacks->onUIntegerElement = onUIntegerElement;
         self.callbacks->onNullElement = onNullElement;
         self.callbacks->onStringElement = onStringElement;
+        self.callbacks->onStringSliceElement = onStringSliceElement;
 
         self.prettyPrint = (encodeOptions & SentryCrashJSONEncodeOptionPretty) != 0;
         self.sorted = (encodeOptions & SentryCrashJSONEncodeOptionSorted) != 0;
@@ -265,6 +266,18 @@ onStringElement(const char *const cName, const char *const value, void *const us
     return onElement(codec, name, element);
 }
 
+static int
+onStringSliceElement(
+    const char *const cName, const char *const value, const int length, void *const userData)
+{
+    NSString *name = stringFromCString(cName);
+    id element = [[NSString alloc] initWithBytes:value
+                                          length:(NSUInteger)length
+                                        encoding:NSUTF8StringEncoding];
+    SentryCrashJSONCodec *codec = (__bridge SentryCrashJSONCodec *)userData;
+    return onElement(codec, name, element);
+}
+
 static int
 onBeginObject(const char *const cName, void *const userData)
 {
@@ -42,6 +42,18 @@ extern "C" {
  */
 void sentrycrashsc_initSelfThread(SentryCrashStackCursor *cursor, int skipEntries);
 
+/** Record the return addresses of the current thread's stack, without initializing a cursor.
+ * Use sentrycrashsc_initWithBacktrace to walk the recorded addresses later on.
+ *
+ * @param addresses The buffer to record the addresses to.
+ *
+ * @param maxLength The maximum number of addresses to record.
+ *
+ * @return The number of recorded addresses. The first one is the return address into this
+ *         function itself, so skip one entry more to start at the caller.
+ */
+int sentrycrashsc_backtraceSelfThread(uintptr_t *addresses, int maxLength);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,7 @@
 #include <execinfo.h>
 
 #include "SentryAsyncSafeLog.h"
+#include "SentryCompiler.h"
 
 #define MAX_BACKTRACE_LENGTH                                                                       \
     (SentryCrashSC_CONTEXT_SIZE                                                                    \
@@ -65,3 +66,17 @@ sentrycrashsc_initSelfThread(SentryCrashStackCursor *cursor, int skipEntries)
     SENTRY_ASYNC_SAFE_LOG_DEBUG("Finished retrieving backtrace.");
     sentrycrashsc_initWithBacktrace(cursor, context->backtrace, backtraceLength, skipEntries + 1);
 }
+
+NEVER_INLINE int
+sentrycrashsc_backtraceSelfThread(uintptr_t *addresses, int maxLength)
+{
+    int backtraceLength;
+    if (stitchSwiftAsync) {
+        backtraceLength = (int)backtrace_async((void **)addresses, (size_t)maxLength, NULL);
+    } else {
+        backtraceLength = backtrace((void **)addresses, maxLength);
+    }
+    // Callers skip one entry for this function, so its frame must not be replaced by a tail call.
+    THWART_TAIL_CALL_OPTIMISATION
+    return backtraceLength;
+}
@@ -42,6 +42,29 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) BOOL enableUIViewControllerInitSwizzling;
 
+/**
+ * The size in bytes a crash report should not exceed, or @c 0 for no limit.
+ *
+ * When a report would exceed it, the error, the crashed thread and the binary images its frames are
+ * in are kept, and less important parts of the report are left out: first memory introspection,
+ * then the other threads, the binary images not referenced by the crashed thread, the breadcrumbs
+ * and finally the scope. The report records what was left out.
+ *
+ * @warning This is an experimental feature and is therefore disabled by default.
+ */
+@property (nonatomic) NSUInteger maxCrashReportSize;
+
+/**
+ * The total size in bytes the crash reports waiting to be sent should not exceed, or @c 0 for no
+ * limit.
+ *
+ * When the SDK starts and the reports exceed it, the oldest ones are deleted, but the newest one is
+ * always kept.
+ *
+ * @warning This is an experimental feature and is therefore disabled by default.
+ */
+@property (nonatomic) NSUInteger maxCrashReportStoreSize;
+
 /// Initializes experimental options with default values.
 - (instancetype)init;
 
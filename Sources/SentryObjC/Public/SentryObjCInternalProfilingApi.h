@@ -30,6 +30,10 @@ SENTRY_NO_INIT
 /// Discards the profiler session without collecting data.
 - (void)discardFor:(SentryObjCId *)traceId;
 
+/// Returns histograms and counters describing the sampling overhead of the running continuous
+/// profiler, or @c nil if none is running.
+- (nullable NSDictionary<NSString *, id> *)samplingTelemetry;
+
 @end
 
 NS_ASSUME_NONNULL_END
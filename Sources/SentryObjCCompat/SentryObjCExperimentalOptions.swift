@@ -31,6 +31,16 @@ import Foundation
         get { wrapped.enableUIViewControllerInitSwizzling }
         set { wrapped.enableUIViewControllerInitSwizzling = newValue }
     }
+
+    @objc public var maxCrashReportSize: UInt {
+        get { wrapped.maxCrashReportSize }
+        set { wrapped.maxCrashReportSize = newValue }
+    }
+
+    @objc public var maxCrashReportStoreSize: UInt {
+        get { wrapped.maxCrashReportStoreSize }
+        set { wrapped.maxCrashReportStoreSize = newValue }
+    }
 }
 
 // swiftlint:enable missing_docs
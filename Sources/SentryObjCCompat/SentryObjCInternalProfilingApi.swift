@@ -27,6 +27,10 @@ import Foundation
     @objc public func discard(for traceId: SentryObjCId) {
         wrapped.value.discard(for: traceId.wrapped)
     }
+
+    @objc public func samplingTelemetry() -> [String: Any]? {
+        wrapped.value.samplingTelemetry()
+    }
 }
 
 #endif
@@ -24,6 +24,10 @@ import Foundation
  * This class listens to `SentryCrashBinaryImageCache` to keep a copy of the loaded binaries
  * information in a sorted collection that will be used to symbolicate frames with better
  * performance.
+ *
+ * The C cache keeps its own sorted index for lookups while writing crash reports, see
+ * `sentrycrashbic_imageForAddress`. This copy is separate from it because it holds the names and
+ * UUIDs as Swift strings, and because tests add images to it that dyld never loaded.
  */
 @objc(SentryBinaryImageCache)
 @_spi(Private) public final class SentryBinaryImageCache: NSObject {
@@ -150,28 +154,52 @@ import Foundation
     @objc
     func binaryImageRemoved(_ imageAddress: UInt64) {
         lock.synchronized {
-            guard let index = indexOfImage(address: imageAddress) else { return }
+            guard let cache = self.cache, let index = Self.indexOfImage(address: imageAddress, in: cache) else { return }
             self.cache?.remove(at: index)
         }
     }
     
     @objc
     public func imageByAddress(_ address: UInt64) -> SentryBinaryImageInfo? {
-        lock.synchronized {
-            guard let index = indexOfImage(address: address) else { return nil }
-            return cache?[index]
-        }
+        // The array is copy-on-write, so taking a snapshot under the lock only retains it. The
+        // search then runs without the lock, so threads symbolicating frames at the same time
+        // don't wait on each other.
+        guard let images = lock.synchronized({ cache }) else { return nil }
+        guard let index = Self.indexOfImage(address: address, in: images) else { return nil }
+        return images[index]
     }
     
-    private func indexOfImage(address: UInt64) -> Int? {
-        guard let cache = self.cache else { return nil }
+    /**
+     * Returns the images containing any of the given addresses, sorted by address. All addresses
+     * are resolved against the same snapshot of the cache in a single pass over it.
+     */
+    func imagesContaining(addresses: [UInt64]) -> [SentryBinaryImageInfo] {
+        guard let images = lock.synchronized({ cache }), !images.isEmpty else { return [] }
         
+        var result = [SentryBinaryImageInfo]()
+        var imageIndex = 0
+        for address in addresses.sorted() {
+            // The addresses are sorted, so images ending before this address can't contain any of
+            // the following addresses either.
+            while imageIndex < images.count && address >= images[imageIndex].address + images[imageIndex].size {
+                imageIndex += 1
+            }
+            guard imageIndex < images.count else { break }
+            let image = images[imageIndex]
+            if address >= image.address && result.last !== image {
+                result.append(image)
+            }
+        }
+        return result
+    }
+    
+    private static func indexOfImage(address: UInt64, in images: [SentryBinaryImageInfo]) -> Int? {
         var left = 0
-        var right = cache.count - 1
+        var right = images.count - 1
         
         while left <= right {
             let mid = (left + right) / 2
-            let image = cache[mid]
+            let image = images[mid]
             
             if address >= image.address && address < (image.address + image.size) {
                 return mid
@@ -24,6 +24,19 @@ public struct SentryInternalProfilingApi {
     public func discard(for traceId: SentryId) {
         PrivateSentrySDKOnly.discardProfiler(forTrace: traceId)
     }
+
+    /// Returns histograms and counters describing the sampling overhead of the running
+    /// continuous profiler, or `nil` if none is running.
+    public func samplingTelemetry() -> [String: Any]? {
+        PrivateSentrySDKOnly.profilerSamplingTelemetry()
+    }
+
+    /// Lowers the sampling rate of profilers started from now on while sampling costs more than
+    /// `cpuBudget` of a CPU core, and skips threads that were idle for more than
+    /// `idleTicksBeforeSkipping` ticks. Pass `0` to turn either off again, which is the default.
+    public func setAdaptiveSampling(cpuBudget: Double, idleTicksBeforeSkipping: UInt32) {
+        PrivateSentrySDKOnly.setProfilerAdaptiveSampling(withCPUBudget: cpuBudget, idleTicksBeforeSkipping: idleTicksBeforeSkipping)
+    }
 }
 
 #endif
@@ -62,6 +62,8 @@ final class SentryCrashIntegration<Dependencies: CrashIntegrationProvider>: NSOb
 
         // Configure memory introspection based on options
         crashReporter.introspectMemory = options.enableMemoryIntrospection
+        crashReporter.maxReportSize = Int64(clamping: options.experimental.maxCrashReportSize)
+        crashReporter.maxReportStoreSize = Int64(clamping: options.experimental.maxCrashReportStoreSize)
 
         self.sessionHandler = dependencies.getCrashIntegrationSessionBuilder(options, bridge: bridge)
         self.scopeObserver = SentryCrashScopeObserver(maxBreadcrumbs: Int(options.maxBreadcrumbs))
@@ -106,6 +106,16 @@ private final class CrashReportFilterBridge: NSObject, SentryCrashReportFilter {
         set { sentryCrash.introspectMemory = newValue }
     }
 
+    @objc public var maxReportSize: Int64 {
+        get { sentryCrash.maxReportSize }
+        set { sentryCrash.maxReportSize = newValue }
+    }
+
+    @objc public var maxReportStoreSize: Int64 {
+        get { sentryCrash.maxReportStoreSize }
+        set { sentryCrash.maxReportStoreSize = newValue }
+    }
+
     @objc public func hasOnCrash() -> Bool {
         sentryCrash.onCrash != nil
     }
@@ -56,6 +56,15 @@ internal import _SentryPrivate
         return infos.map { debugMeta(from: $0) }
     }
 
+    /**
+     * Returns a list of debug images containing the given instruction addresses, such as the
+     * frames of a profile, so that only the images actually referenced are attached.
+     */
+    @objc(getDebugImagesFromCacheForInstructionAddresses:) public func getDebugImagesFromCacheForInstructionAddresses(_ addresses: [NSNumber]) -> [DebugMeta] {
+        let infos = binaryImageCache.imagesContaining(addresses: addresses.map { $0.uint64Value })
+        return infos.map { debugMeta(from: $0) }
+    }
+
     @objc public func getDebugImagesFromCache() -> [DebugMeta] {
         let infos = binaryImageCache.getAllBinaryImages()
         return infos.map { debugMeta(from: $0) }
@@ -35,4 +35,27 @@ public final class SentryExperimentalOptions: NSObject {
      * See https://github.com/getsentry/sentry-cocoa/issues/8548.
      */
     public var enableUIViewControllerInitSwizzling = false
+
+    /**
+     * The size in bytes a crash report should not exceed, or `0` for no limit.
+     *
+     * When a report would exceed it, the error, the crashed thread and the binary images its frames
+     * are in are kept, and less important parts of the report are left out: first memory
+     * introspection, then the other threads, the binary images not referenced by the crashed thread,
+     * the breadcrumbs and finally the scope. The report records what was left out.
+     *
+     * - Experiment: This is an experimental feature and is therefore disabled by default.
+     */
+    public var maxCrashReportSize: UInt = 0
+
+    /**
+     * The total size in bytes the crash reports waiting to be sent should not exceed, or `0` for
+     * no limit.
+     *
+     * When the SDK starts and the reports exceed it, the oldest ones are deleted, but the newest
+     * one is always kept.
+     *
+     * - Experiment: This is an experimental feature and is therefore disabled by default.
+     */
+    public var maxCrashReportStoreSize: UInt = 0
 }
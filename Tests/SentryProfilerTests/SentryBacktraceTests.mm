@@ -5,6 +5,7 @@
 #    import <XCTest/XCTest.h>
 
 #    import "SentryBacktrace.hpp"
+#    import "SentrySampleRingBuffer.hpp"
 #    import "SentryThreadHandle.hpp"
 
 #    import <cmath>
@@ -247,6 +248,119 @@ countof(Array &)
     XCTAssertTrue(foundThread2);
 }
 
+- (void)testCountsEveryThreadDroppedWhenBufferIsFull
+{
+    pthread_t threads[3];
+    for (auto &thread : threads) {
+        XCTAssertEqual(
+            pthread_create(&thread, nullptr, threadEntry, reinterpret_cast<void *>(bc_a)), 0);
+    }
+
+    ThreadMetadataCache cache;
+    SampleRingBuffer buffer(1);
+    const auto numRecords = enumerateBacktracesForAllThreads(
+        buffer, &cache, [] { return static_cast<std::uint64_t>(0); });
+
+    for (const auto &thread : threads) {
+        XCTAssertEqual(pthread_cancel(thread), 0);
+        XCTAssertEqual(pthread_join(thread, nullptr), 0);
+    }
+
+    // Only one sample fits, every other thread of the tick is dropped rather than just the first.
+    XCTAssertEqual(numRecords, 1UL);
+    XCTAssertGreaterThanOrEqual(buffer.numDropped(), 2ULL);
+}
+
+- (void)testReadableStackBounds
+{
+    const auto current = ThreadHandle::current();
+    const auto bounds = current->stackBounds();
+    const auto readableBounds = readableStackBounds(bounds);
+
+    XCTAssertTrue(readableBounds.isValid());
+    XCTAssertEqual(readableBounds.start, bounds.start);
+    XCTAssertGreaterThanOrEqual(readableBounds.end, bounds.end);
+    XCTAssertTrue(
+        readableBounds.contains(reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0))));
+
+    XCTAssertFalse(readableStackBounds(StackBounds()).isValid());
+}
+
+- (void)testBacktraceWithReadableBounds
+{
+    const auto current = ThreadHandle::current();
+    const auto bounds = current->stackBounds();
+    const auto readableBounds = readableStackBounds(bounds);
+
+    std::uintptr_t checkedAddresses[128];
+    std::uintptr_t uncheckedAddresses[128];
+    bool checkedReachedEnd = false;
+    bool uncheckedReachedEnd = false;
+    const auto checkedDepth = backtrace(*current, *current, checkedAddresses, bounds,
+        &checkedReachedEnd, countof(checkedAddresses), 0);
+    const auto uncheckedDepth = backtrace(*current, *current, uncheckedAddresses, bounds,
+        &uncheckedReachedEnd, countof(uncheckedAddresses), 0, &readableBounds);
+
+    XCTAssertEqual(checkedDepth, uncheckedDepth);
+    XCTAssertEqual(checkedReachedEnd, uncheckedReachedEnd);
+    // The innermost frames differ, since they're in different callers of backtrace().
+    for (std::size_t i = 2; i < checkedDepth; i++) {
+        XCTAssertEqual(checkedAddresses[i], uncheckedAddresses[i]);
+    }
+}
+
+- (void)testBacktraceFromStackCopy
+{
+    pthread_t thread;
+    XCTAssertEqual(
+        pthread_create(&thread, nullptr, threadEntry, reinterpret_cast<void *>(bc_a)), 0);
+    ThreadHandle handle(pthread_mach_thread_np(thread));
+    const auto bounds = handle.stackBounds();
+
+    StackCopy copy(64 * 1024);
+    std::uintptr_t addresses[128];
+    bool foundThread = false;
+    // Try up to 3 times.
+    for (int i = 0; i < 3 && !foundThread; i++) {
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(static_cast<long long>(std::pow(2, i + 1))));
+        XCTAssertTrue(handle.suspend());
+        const auto copied = copyStack(handle, bounds, &copy);
+        handle.resume();
+        XCTAssertTrue(copied);
+
+        bool reachedEndOfStack = false;
+        bool reachedEndOfCopy = false;
+        const auto depth = backtrace(copy, addresses, bounds, &reachedEndOfStack,
+            &reachedEndOfCopy, countof(addresses));
+        const auto start = indexOfSymbol(addresses, depth, "bc_c");
+        if (start != -1 && depth >= static_cast<unsigned long>(start + 3)) {
+            foundThread = true;
+            XCTAssertTrue(reachedEndOfStack);
+            XCTAssertFalse(reachedEndOfCopy);
+            XCTAssertEqual(symbolicate(addresses[start + 1]), "bc_b");
+            XCTAssertEqual(symbolicate(addresses[start + 2]), "bc_a");
+        }
+    }
+
+    // A copy that is too small to hold the outer frames ends the walk early.
+    StackCopy smallCopy(sizeof(StackFrame));
+    XCTAssertTrue(handle.suspend());
+    XCTAssertTrue(copyStack(handle, bounds, &smallCopy));
+    handle.resume();
+    bool reachedEndOfStack = false;
+    bool reachedEndOfCopy = false;
+    backtrace(smallCopy, addresses, bounds, &reachedEndOfStack, &reachedEndOfCopy,
+        countof(addresses));
+    XCTAssertFalse(reachedEndOfStack);
+    XCTAssertTrue(reachedEndOfCopy);
+
+    XCTAssertEqual(pthread_cancel(thread), 0);
+    XCTAssertEqual(pthread_join(thread, nullptr), 0);
+
+    XCTAssertTrue(foundThread);
+}
+
 @end
 
 #endif
@@ -362,6 +362,10 @@ private extension SentryContinuousProfilerTests {
             XCTAssertNotNil(stacks[stackID])
         }
 
+        // the rate is only adapted to the sampling cost when opted into
+        let samplingTelemetry = try XCTUnwrap(profile["sampling_telemetry"] as? [String: Any])
+        XCTAssertEqual(try XCTUnwrap(samplingTelemetry["sampling_rate_hz"] as? Int), 101)
+
         let measurements = try XCTUnwrap(profile["measurements"] as? [String: Any])
 
         let chunkStartTime = try XCTUnwrap(samples.first?["timestamp"] as? TimeInterval)
@@ -0,0 +1,85 @@
+#import "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    import <XCTest/XCTest.h>
+
+#    import "SentryMetricTimeSeries.hpp"
+
+#    import <thread>
+#    import <vector>
+
+using namespace sentry::profiling;
+
+@interface SentryMetricTimeSeriesTests : XCTestCase
+@end
+
+@implementation SentryMetricTimeSeriesTests
+
+- (void)testOverwritesOldestReadingsWhenFull
+{
+    MetricTimeSeries series(3);
+    XCTAssertEqual(series.capacity(), 4UL);
+    for (int i = 0; i < 6; i++) {
+        series.record(i, i * 0.5, i * 2.0);
+    }
+
+    const auto range = series.readableRange();
+    XCTAssertEqual(range.begin, 2ULL);
+    XCTAssertEqual(range.end, 6ULL);
+    std::vector<MetricReading> readings;
+    XCTAssertEqual(series.forEach(range,
+                       [&readings](const MetricReading &reading) { readings.push_back(reading); }),
+        4UL);
+    XCTAssertEqual(readings.front().systemTime, 2ULL);
+    XCTAssertEqual(readings.front().dateInterval, 1.0);
+    XCTAssertEqual(readings.front().value, 4.0);
+    XCTAssertEqual(readings.back().value, 10.0);
+}
+
+- (void)testClearKeepsCapturedRangeReadable
+{
+    MetricTimeSeries series(8);
+    series.record(1, 1.0, 1.0);
+    series.record(2, 2.0, 2.0);
+    const auto range = series.readableRange();
+
+    series.clear();
+    const auto clearedRange = series.readableRange();
+    XCTAssertEqual(clearedRange.begin, clearedRange.end);
+
+    // readings captured before clearing can still be read until they're overwritten
+    series.record(3, 3.0, 3.0);
+    XCTAssertEqual(series.forEach(range, [](const MetricReading &) { }), 2UL);
+    for (int i = 0; i < 8; i++) {
+        series.record(4, 4.0, 4.0);
+    }
+    XCTAssertEqual(series.forEach(range, [](const MetricReading &) { }), 0UL);
+}
+
+- (void)testConcurrentWritersDontTearReadings
+{
+    MetricTimeSeries series(64);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 4; i++) {
+        writers.emplace_back([&series] {
+            for (std::uint64_t j = 0; j < 10000; j++) {
+                series.record(j, static_cast<double>(j), static_cast<double>(j));
+            }
+        });
+    }
+    for (int i = 0; i < 100; i++) {
+        series.forEach(series.readableRange(), [self](const MetricReading &reading) {
+            XCTAssertEqual(static_cast<double>(reading.systemTime), reading.value);
+            XCTAssertEqual(reading.dateInterval, reading.value);
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    XCTAssertEqual(series.forEach(series.readableRange(), [](const MetricReading &) { }), 64UL);
+}
+
+@end
+
+#endif
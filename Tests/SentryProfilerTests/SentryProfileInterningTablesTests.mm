@@ -0,0 +1,84 @@
+#import "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    import <XCTest/XCTest.h>
+
+#    import "SentryProfileInterningTables.hpp"
+
+#    import <vector>
+
+using namespace sentry::profiling;
+
+@interface SentryProfileInterningTablesTests : XCTestCase
+@end
+
+@implementation SentryProfileInterningTablesTests
+
+- (void)testIntegerIndexMapFindsInsertedValues
+{
+    IntegerIndexMap map;
+    XCTAssertEqual(map.find(42), IntegerIndexMap::kNotFound);
+
+    // insert enough keys to force the table to grow several times
+    for (std::uint32_t i = 0; i < 10000; i++) {
+        XCTAssertEqual(map.findOrInsert(i * 16, i), IntegerIndexMap::kNotFound);
+    }
+    XCTAssertEqual(map.size(), 10000UL);
+
+    for (std::uint32_t i = 0; i < 10000; i++) {
+        XCTAssertEqual(map.find(i * 16), i);
+        XCTAssertEqual(map.findOrInsert(i * 16, 0), i);
+    }
+    XCTAssertEqual(map.find(8), IntegerIndexMap::kNotFound);
+    XCTAssertEqual(map.size(), 10000UL);
+}
+
+- (void)testFrameTableDeduplicatesAddresses
+{
+    FrameTable frames;
+    XCTAssertEqual(frames.intern(0x123), 0U);
+    XCTAssertEqual(frames.intern(0x456), 1U);
+    XCTAssertEqual(frames.intern(0x123), 0U);
+    XCTAssertEqual(frames.size(), 2UL);
+    XCTAssertEqual(frames.addressAt(0), 0x123UL);
+    XCTAssertEqual(frames.addressAt(1), 0x456UL);
+}
+
+- (void)testStackTableDeduplicatesStacks
+{
+    StackTable stacks;
+    const std::uint32_t stack1[] = { 2, 1, 0 };
+    const std::uint32_t stack2[] = { 3, 1, 0 };
+    const std::uint32_t stack3[] = { 1, 0 };
+
+    XCTAssertEqual(stacks.intern(stack1, 3), 0U);
+    XCTAssertEqual(stacks.intern(stack2, 3), 1U);
+    // a prefix of known stacks that wasn't recorded as a stack itself yet
+    XCTAssertEqual(stacks.intern(stack3, 2), 2U);
+    XCTAssertEqual(stacks.intern(nullptr, 0), 3U);
+
+    XCTAssertEqual(stacks.intern(stack1, 3), 0U);
+    XCTAssertEqual(stacks.intern(stack2, 3), 1U);
+    XCTAssertEqual(stacks.intern(stack3, 2), 2U);
+    XCTAssertEqual(stacks.intern(nullptr, 0), 3U);
+    XCTAssertEqual(stacks.size(), 4UL);
+}
+
+- (void)testStackTableReturnsFramesInnermostFirst
+{
+    StackTable stacks;
+    const std::uint32_t stack[] = { 5, 4, 7 };
+    const auto index = stacks.intern(stack, 3);
+
+    std::vector<std::uint32_t> frames;
+    stacks.framesOfStack(index, frames);
+    XCTAssertTrue(frames == std::vector<std::uint32_t>({ 5, 4, 7 }));
+
+    stacks.framesOfStack(stacks.intern(nullptr, 0), frames);
+    XCTAssertTrue(frames.empty());
+}
+
+@end
+
+#endif
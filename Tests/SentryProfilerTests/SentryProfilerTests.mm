@@ -10,6 +10,7 @@
 #    import "SentryProfilerMocks.h"
 #    import "SentryProfilerSerialization+Test.h"
 #    import "SentryProfilerState+ObjCpp.h"
+#    import "SentryProfilingSwiftHelpers.h"
 #    import "SentrySwift.h"
 #    import "SentryThread.h"
 #    import "SentryTransaction.h"
@@ -292,6 +293,143 @@ using namespace sentry::profiling;
     }];
 }
 
+- (void)testContinuousProfileChunkJSON
+{
+    SentryProfilerState *state = [[SentryProfilerState alloc] init];
+
+    const auto backtrace1 = mockBacktrace(
+        12345568910, 666, "test\"Thread", std::vector<std::uintptr_t>({ 0x123, 0x456, 0x789 }));
+    [state appendBacktrace:backtrace1];
+    const auto backtrace2 = mockBacktrace(
+        12345568910, 666, "test\"Thread", std::vector<std::uintptr_t>({ 0x777, 0x888, 0x789 }));
+    [state appendBacktrace:backtrace2];
+    [state appendBacktrace:backtrace2];
+
+    SentryProfilerMutableState *detachedState = [state detachMutableState];
+    NSMutableData *data = [NSMutableData data];
+    [detachedState appendContinuousProfileChunkJSONToData:data];
+
+    NSError *error;
+    NSDictionary<NSString *, id> *profile = [NSJSONSerialization JSONObjectWithData:data
+                                                                            options:0
+                                                                              error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(profile[@"stacks"], detachedState.stacks);
+
+    NSArray<NSDictionary<NSString *, id> *> *frames = profile[@"frames"];
+    XCTAssertEqual(frames.count, 5UL);
+    [frames enumerateObjectsUsingBlock:^(NSDictionary<NSString *, id> *_Nonnull frame,
+        NSUInteger idx, __unused BOOL *_Nonnull stop) {
+        XCTAssertEqualObjects(
+            frame[@"instruction_addr"], detachedState.frames[idx][@"instruction_addr"]);
+    }];
+
+    NSArray<NSDictionary<NSString *, id> *> *samples = profile[@"samples"];
+    XCTAssertEqual(samples.count, 3UL);
+    XCTAssertEqualObjects(samples[0][@"stack_id"], @0);
+    XCTAssertEqualObjects(samples[1][@"stack_id"], @1);
+    XCTAssertEqualObjects(samples[2][@"stack_id"], @1);
+    XCTAssertEqualObjects(samples[0][@"thread_id"], @"12345568910");
+    XCTAssertEqualWithAccuracy([samples[0][@"timestamp"] doubleValue],
+        detachedState.samples[0].absoluteNSDateInterval, 1e-6);
+
+    NSDictionary *threadMetadata = profile[@"thread_metadata"][@"12345568910"];
+    XCTAssertEqualObjects(threadMetadata[@"name"], @"test\"Thread");
+    XCTAssertEqualObjects(threadMetadata[@"priority"], @666);
+
+    // the state that was detached for the chunk is no longer written to
+    [state appendBacktrace:backtrace1];
+    XCTAssertEqual(detachedState.samples.count, 3UL);
+    [state mutate:^(SentryProfilerMutableState *mutableState) {
+        XCTAssertEqual(mutableState.samples.count, 1UL);
+        XCTAssertEqual(mutableState.frames.count, 3UL);
+    }];
+}
+
+- (void)testSampleDatesAreWhenTheSamplesWereTaken
+{
+    SentryProfilerState *state = [[SentryProfilerState alloc] init];
+    auto backtrace = mockBacktrace(
+        12345568910, 666, "testThread", std::vector<std::uintptr_t>({ 0x123, 0x456 }));
+
+    const auto sampledDateInterval = sentry_getDate().timeIntervalSince1970;
+    const auto sampledSystemTime = sentry_getSystemTime();
+
+    // Drain the samples some time after they were taken, as the drain queue might.
+    [NSThread sleepForTimeInterval:0.5];
+    backtrace.absoluteTimestamp = sampledSystemTime - 100000000;
+    [state appendBacktrace:backtrace];
+    backtrace.absoluteTimestamp = sampledSystemTime;
+    [state appendBacktrace:backtrace];
+
+    SentryProfilerMutableState *detachedState = [state detachMutableState];
+    XCTAssertEqual(detachedState.samples.count, 2UL);
+    XCTAssertEqualWithAccuracy(
+        detachedState.samples[0].absoluteNSDateInterval, sampledDateInterval - 0.1, 0.05);
+    XCTAssertEqualWithAccuracy(
+        detachedState.samples[1].absoluteNSDateInterval, sampledDateInterval, 0.05);
+}
+
+- (void)testTruncatedStacksEndWithMarkerFrame
+{
+    SentryProfilerState *state = [[SentryProfilerState alloc] init];
+
+    auto backtrace = mockBacktrace(
+        12345568910, 666, "testThread", std::vector<std::uintptr_t>({ 0x123, 0x456 }));
+    [state appendBacktrace:backtrace];
+    backtrace.isTruncated = true;
+    [state appendBacktrace:backtrace];
+    [state appendBacktrace:backtrace];
+
+    SentryProfilerMutableState *detachedState = [state detachMutableState];
+    XCTAssertEqual(detachedState.numTruncatedSamples, 2ULL);
+    NSArray<NSNumber *> *expectedTruncatedStack = @[ @0, @1, @2 ];
+    XCTAssertEqualObjects(detachedState.stacks, (@[ @[ @0, @1 ], expectedTruncatedStack ]));
+    XCTAssertEqualObjects(detachedState.frames[2], @{ @"function" : @"<truncated>" });
+
+    NSMutableData *data = [NSMutableData data];
+    [detachedState appendContinuousProfileChunkJSONToData:data];
+    NSError *error;
+    NSDictionary<NSString *, id> *profile = [NSJSONSerialization JSONObjectWithData:data
+                                                                            options:0
+                                                                              error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(profile[@"truncated_samples"], @2);
+    XCTAssertEqualObjects(profile[@"frames"][2], @{ @"function" : @"<truncated>" });
+    XCTAssertEqualObjects(profile[@"samples"][1][@"stack_id"], @1);
+}
+
+- (void)testSlicingSamplesBetweenSystemTimes
+{
+    SentryProfilerState *state = [[SentryProfilerState alloc] init];
+    auto backtrace = mockBacktrace(
+        12345568910, 666, "testThread", std::vector<std::uintptr_t>({ 0x123, 0x456 }));
+    for (const auto timestamp : { 10, 20, 20, 30, 40, 50 }) {
+        backtrace.absoluteTimestamp = timestamp;
+        [state appendBacktrace:backtrace];
+    }
+
+    NSArray<SentrySample *> *samples
+        = [state copyProfilingDataFromSystemTime:20 toSystemTime:40][@"profile"][@"samples"];
+    XCTAssertEqual(samples.count, 4UL);
+    XCTAssertEqual(samples.firstObject.absoluteTimestamp, 20ULL);
+    XCTAssertEqual(samples.lastObject.absoluteTimestamp, 40ULL);
+
+    samples = [state copyProfilingDataFromSystemTime:41 toSystemTime:49][@"profile"][@"samples"];
+    XCTAssertEqual(samples.count, 0UL);
+
+    [state mutate:^(SentryProfilerMutableState *mutableState) {
+        NSArray<SentrySample *> *slice = sentry_slicedProfileSamples(mutableState.samples, 15, 45);
+        XCTAssertEqual(slice.count, 4UL);
+        XCTAssertEqual(slice.firstObject.absoluteTimestamp, 20ULL);
+        XCTAssertEqual(slice.lastObject.absoluteTimestamp, 40ULL);
+
+        XCTAssertNil(sentry_slicedProfileSamples(mutableState.samples, 51, 60));
+        XCTAssertNil(sentry_slicedProfileSamples(mutableState.samples, 1, 9));
+        XCTAssertEqual(sentry_slicedProfileSamples(mutableState.samples, 41, 49).count, 0UL);
+    }];
+}
+
 @end
 
 #endif // SENTRY_TARGET_PROFILING_SUPPORTED
@@ -0,0 +1,97 @@
+#import "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    import <XCTest/XCTest.h>
+
+#    import "SentrySampleRingBuffer.hpp"
+
+using namespace sentry::profiling;
+
+@interface SentrySampleRingBufferTests : XCTestCase
+@end
+
+@implementation SentrySampleRingBufferTests
+
+- (void)testRoundsCapacityUpToPowerOfTwo
+{
+    XCTAssertEqual(SampleRingBuffer(5).capacity(), 8UL);
+    XCTAssertEqual(SampleRingBuffer(8).capacity(), 8UL);
+    XCTAssertEqual(SampleRingBuffer(0).capacity(), 1UL);
+}
+
+- (void)testRecordsHaveRoomForMaxDepth
+{
+    SampleRingBuffer buffer(2, 300);
+    XCTAssertEqual(buffer.maxDepth(), 300UL);
+
+    const auto first = buffer.reserve();
+    first->addresses[299] = 1;
+    buffer.commit();
+    const auto second = buffer.reserve();
+    second->addresses[0] = 2;
+    buffer.commit();
+
+    XCTAssertEqual(buffer.peek()->addresses[299], 1UL);
+    XCTAssertEqual(second->addresses - first->addresses, 300L);
+}
+
+- (void)testRecordsAreReadInWriteOrder
+{
+    SampleRingBuffer buffer(4);
+    XCTAssertTrue(buffer.peek() == nullptr);
+
+    for (std::uint64_t i = 1; i <= 3; i++) {
+        const auto record = buffer.reserve();
+        XCTAssertTrue(record != nullptr);
+        record->threadID = i;
+        buffer.commit();
+    }
+
+    for (std::uint64_t i = 1; i <= 3; i++) {
+        const auto record = buffer.peek();
+        XCTAssertTrue(record != nullptr);
+        XCTAssertEqual(record->threadID, i);
+        buffer.pop();
+    }
+    XCTAssertTrue(buffer.peek() == nullptr);
+}
+
+- (void)testUncommittedRecordIsNotVisible
+{
+    SampleRingBuffer buffer(4);
+    const auto record = buffer.reserve();
+    record->threadID = 1;
+    XCTAssertTrue(buffer.peek() == nullptr);
+
+    // an uncommitted slot is handed out again
+    XCTAssertEqual(buffer.reserve(), record);
+}
+
+- (void)testDropsSamplesWhenFull
+{
+    SampleRingBuffer buffer(2);
+    for (std::uint64_t i = 1; i <= 2; i++) {
+        const auto record = buffer.reserve();
+        record->threadID = i;
+        buffer.commit();
+    }
+
+    XCTAssertTrue(buffer.reserve() == nullptr);
+    XCTAssertTrue(buffer.reserve() == nullptr);
+    XCTAssertEqual(buffer.numDropped(), 2ULL);
+
+    buffer.pop();
+    const auto record = buffer.reserve();
+    XCTAssertTrue(record != nullptr);
+    record->threadID = 3;
+    buffer.commit();
+
+    XCTAssertEqual(buffer.peek()->threadID, 2ULL);
+    buffer.pop();
+    XCTAssertEqual(buffer.peek()->threadID, 3ULL);
+}
+
+@end
+
+#endif
@@ -0,0 +1,85 @@
+#import "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    import <XCTest/XCTest.h>
+
+#    import "SentrySamplingPolicy.hpp"
+#    import "SentryThreadHandle.hpp"
+
+using namespace sentry::profiling;
+
+@interface SentrySamplingPolicyTests : XCTestCase
+@end
+
+@implementation SentrySamplingPolicyTests
+
+- (void)testSamplesEveryThreadByDefault
+{
+    SamplingPolicy policy(100, SamplingPolicyOptions());
+    const auto thread = ThreadHandle::current();
+    for (int i = 0; i < 10; i++) {
+        policy.beginTick();
+        XCTAssertTrue(policy.shouldSampleThread(*thread, true));
+        XCTAssertFalse(policy.endTick(1000000000));
+    }
+    XCTAssertEqual(policy.samplingRateHz(), 100U);
+    XCTAssertEqual(policy.intervalNs(), 10000000ULL);
+}
+
+- (void)testSkipsThreadsAfterBeingIdleForConsecutiveTicks
+{
+    SamplingPolicyOptions options;
+    options.idleTicksBeforeSkipping = 2;
+    SamplingPolicy policy(100, options);
+    const auto thread = ThreadHandle::current();
+
+    for (int i = 0; i < 2; i++) {
+        policy.beginTick();
+        XCTAssertTrue(policy.shouldSampleThread(*thread, true));
+        policy.endTick(0);
+    }
+    policy.beginTick();
+    XCTAssertFalse(policy.shouldSampleThread(*thread, true));
+    policy.endTick(0);
+
+    // the thread is sampled again as soon as it runs
+    policy.beginTick();
+    XCTAssertTrue(policy.shouldSampleThread(*thread, false));
+    policy.endTick(0);
+    policy.beginTick();
+    XCTAssertTrue(policy.shouldSampleThread(*thread, true));
+    policy.endTick(0);
+}
+
+- (void)testLowersSamplingRateWhenOverBudget
+{
+    SamplingPolicyOptions options;
+    options.cpuBudget = 0.1;
+    options.minSamplingRateHz = 20;
+    SamplingPolicy policy(100, options);
+
+    // every tick costs half of the initial interval
+    for (int i = 0; i < 100; i++) {
+        policy.beginTick();
+        policy.endTick(5000000);
+    }
+    XCTAssertEqual(policy.samplingRateHz(), 20U);
+    XCTAssertEqual(policy.intervalNs(), 50000000ULL);
+
+    // once ticks are cheap again, the rate is raised back up to the initial rate
+    for (int i = 0; i < 200; i++) {
+        policy.beginTick();
+        policy.endTick(1000);
+    }
+    XCTAssertEqual(policy.samplingRateHz(), 100U);
+
+    policy.beginTick();
+    policy.endTick(5000000);
+    policy.reset();
+    XCTAssertEqual(policy.samplingRateHz(), 100U);
+}
+
+@end
+
+#endif
@@ -10,6 +10,7 @@
 #    import "SentryTime.h"
 
 #    import "SentrySwift.h"
+#    import <atomic>
 #    import <chrono>
 #    import <iostream>
 #    import <pthread.h>
@@ -61,6 +62,35 @@ using namespace sentry::profiling;
     XCTAssertGreaterThan(numIdleSamples, 0);
 }
 
+- (void)testSampleBufferCapacity_GrowsWithThreadCountAndSamplingRate
+{
+    const auto fewThreads = SamplingProfiler::sampleBufferCapacity(1, 101);
+    const auto manyThreads = SamplingProfiler::sampleBufferCapacity(100, 101);
+    XCTAssertGreaterThanOrEqual(fewThreads, 512UL);
+    XCTAssertGreaterThan(manyThreads, fewThreads);
+    // A busy app with 100 threads keeps a quarter of a second of samples.
+    XCTAssertGreaterThanOrEqual(manyThreads, 100UL * 25UL);
+    XCTAssertGreaterThan(SamplingProfiler::sampleBufferCapacity(64, 301),
+        SamplingProfiler::sampleBufferCapacity(64, 101));
+    XCTAssertLessThanOrEqual(SamplingProfiler::sampleBufferCapacity(10000, 1000), 4096UL);
+}
+
+- (void)testDrainPendingSamples_PassesSamplesWhileSampling
+{
+    const std::uint32_t samplingRateHz = 301;
+    std::atomic_int numSamples { 0 };
+    const auto profiler = std::make_shared<SamplingProfiler>(
+        [&](__unused auto &backtrace) { numSamples++; }, samplingRateHz);
+    profiler->startSampling();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    profiler->drainPendingSamples();
+
+    XCTAssertTrue(profiler->isSampling());
+    XCTAssertGreaterThan(numSamples.load(), 0);
+    profiler->stopSampling();
+}
+
 static void *
 idleThreadEntry(__unused void *ptr)
 {
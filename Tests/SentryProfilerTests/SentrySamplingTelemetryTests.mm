@@ -0,0 +1,61 @@
+#import "SentryProfilingConditionals.h"
+
+#if SENTRY_TARGET_PROFILING_SUPPORTED
+
+#    import <XCTest/XCTest.h>
+
+#    import "SentrySamplingTelemetry.hpp"
+
+using namespace sentry::profiling;
+
+@interface SentrySamplingTelemetryTests : XCTestCase
+@end
+
+@implementation SentrySamplingTelemetryTests
+
+- (void)testHistogramBuckets
+{
+    Histogram histogram;
+    histogram.record(0);
+    histogram.record(1);
+    histogram.record(3);
+    histogram.record(4);
+    histogram.record(UINT64_MAX);
+
+    const auto snapshot = histogram.snapshot();
+    XCTAssertEqual(snapshot.count, 5ULL);
+    XCTAssertEqual(snapshot.max, UINT64_MAX);
+    XCTAssertEqual(snapshot.buckets[0], 1ULL);
+    XCTAssertEqual(snapshot.buckets[1], 1ULL);
+    XCTAssertEqual(snapshot.buckets[2], 1ULL);
+    XCTAssertEqual(snapshot.buckets[3], 1ULL);
+    XCTAssertEqual(snapshot.buckets[Histogram::kNumBuckets - 1], 1ULL);
+
+    XCTAssertEqual(Histogram::bucketUpperBound(0), 1ULL);
+    XCTAssertEqual(Histogram::bucketUpperBound(2), 4ULL);
+    XCTAssertEqual(Histogram::bucketUpperBound(Histogram::kNumBuckets - 1), UINT64_MAX);
+}
+
+- (void)testSnapshotDifference
+{
+    SamplingTelemetry telemetry;
+    telemetry.stackDepth.record(10);
+    telemetry.suspendFailures.fetch_add(1);
+    const auto first = telemetry.snapshot();
+
+    telemetry.stackDepth.record(20);
+    telemetry.stackDepth.record(30);
+    telemetry.truncatedStacks.fetch_add(2);
+    const auto delta = telemetry.snapshot().since(first);
+
+    XCTAssertEqual(delta.stackDepth.count, 2ULL);
+    XCTAssertEqual(delta.stackDepth.sum, 50ULL);
+    XCTAssertEqual(delta.stackDepth.max, 30ULL);
+    XCTAssertEqual(delta.suspendFailures, 0ULL);
+    XCTAssertEqual(delta.truncatedStacks, 2ULL);
+    XCTAssertEqual(delta.tickDurationNs.count, 0ULL);
+}
+
+@end
+
+#endif
@@ -127,6 +127,53 @@ threadGetName(void *namePtr)
     XCTAssertFalse(foundCurrentThread);
 }
 
+- (void)testAllExcludingCurrentReusesSnapshot
+{
+    pthread_t thread1, thread2;
+    XCTAssertEqual(pthread_create(&thread1, nullptr, threadSpin, nullptr), 0);
+    XCTAssertEqual(pthread_create(&thread2, nullptr, threadSpin, nullptr), 0);
+
+    ThreadSnapshot snapshot(1);
+    XCTAssertEqual(snapshot.capacity(), 1UL);
+    XCTAssertTrue(snapshot.empty());
+
+    bool foundThread1 = false, foundThread2 = false, foundCurrentThread = false;
+    ThreadHandle::allExcludingCurrent(&snapshot);
+    XCTAssertEqual(snapshot.current().nativeHandle(), currentMachThread());
+    for (const auto &thread : snapshot) {
+        const auto pt = pthread_from_mach_thread_np(thread->nativeHandle());
+        if (pthread_equal(pt, thread1)) {
+            foundThread1 = true;
+        } else if (pthread_equal(pt, thread2)) {
+            foundThread2 = true;
+        } else if (pthread_equal(pt, pthread_self())) {
+            foundCurrentThread = true;
+        }
+    }
+    XCTAssertTrue(foundThread1);
+    XCTAssertTrue(foundThread2);
+    XCTAssertFalse(foundCurrentThread);
+
+    // the snapshot grew to fit all threads, and taking another one reuses its handles
+    const auto size = snapshot.size();
+    const auto capacity = snapshot.capacity();
+    XCTAssertGreaterThanOrEqual(capacity, size);
+    const auto firstHandle = snapshot.begin()->get();
+    ThreadHandle::allExcludingCurrent(&snapshot);
+    XCTAssertEqual(snapshot.capacity(), capacity);
+    XCTAssertEqual(snapshot.begin()->get(), firstHandle);
+
+    snapshot.clear();
+    XCTAssertTrue(snapshot.empty());
+    XCTAssertEqual(snapshot.capacity(), capacity);
+
+    XCTAssertEqual(pthread_cancel(thread1), 0);
+    XCTAssertEqual(pthread_join(thread1, nullptr), 0);
+
+    XCTAssertEqual(pthread_cancel(thread2), 0);
+    XCTAssertEqual(pthread_join(thread2, nullptr), 0);
+}
+
 - (void)testName
 {
     pthread_t thread;
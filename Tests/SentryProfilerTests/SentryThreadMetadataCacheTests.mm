@@ -111,6 +111,105 @@ threadSpin(void *name)
     XCTAssertEqual(pthread_join(thread, nullptr), 0);
 }
 
+- (void)testEvictsThreadsThatWereNotMarkedAlive
+{
+    pthread_t thread1, thread2;
+    char name[] = "SentryThreadMetadataCacheTests";
+    XCTAssertEqual(
+        pthread_create(&thread1, nullptr, threadSpin, reinterpret_cast<void *>(name)), 0);
+    XCTAssertEqual(
+        pthread_create(&thread2, nullptr, threadSpin, reinterpret_cast<void *>(name)), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    ThreadMetadataCache cache;
+    ThreadHandle handle1(pthread_mach_thread_np(thread1));
+    ThreadHandle handle2(pthread_mach_thread_np(thread2));
+    cache.beginGeneration();
+    cache.metadataForThread(handle1);
+    cache.metadataForThread(handle2);
+    XCTAssertEqual(cache.evictStaleThreads(), 0UL);
+    XCTAssertEqual(cache.size(), 2UL);
+
+    cache.beginGeneration();
+    cache.markThreadAlive(handle1);
+    XCTAssertEqual(cache.evictStaleThreads(), 1UL);
+    XCTAssertEqual(cache.size(), 1UL);
+
+    XCTAssertEqual(pthread_cancel(thread1), 0);
+    XCTAssertEqual(pthread_join(thread1, nullptr), 0);
+    XCTAssertEqual(pthread_cancel(thread2), 0);
+    XCTAssertEqual(pthread_join(thread2, nullptr), 0);
+}
+
+- (void)testRequeriesMetadataWhenPortNameIsReused
+{
+    ThreadMetadataCache cache;
+    char firstName[] = "io.test.first";
+    pthread_t firstThread;
+    XCTAssertEqual(
+        pthread_create(&firstThread, nullptr, threadSpin, reinterpret_cast<void *>(firstName)), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const auto port = pthread_mach_thread_np(firstThread);
+    {
+        ThreadHandle handle(port);
+        XCTAssertTrue(cache.metadataForThread(handle).name == "io.test.first");
+    }
+    XCTAssertEqual(pthread_cancel(firstThread), 0);
+    XCTAssertEqual(pthread_join(firstThread, nullptr), 0);
+
+    // the kernel hands out port names again once their threads have exited, but not in a
+    // predictable order
+    char secondName[] = "io.test.second";
+    for (int i = 0; i < 100; i++) {
+        pthread_t thread;
+        XCTAssertEqual(
+            pthread_create(&thread, nullptr, threadSpin, reinterpret_cast<void *>(secondName)), 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const auto reusedPort = pthread_mach_thread_np(thread) == port;
+        if (reusedPort) {
+            ThreadHandle handle(port);
+            XCTAssertTrue(cache.metadataForThread(handle).name == "io.test.second");
+        }
+        XCTAssertEqual(pthread_cancel(thread), 0);
+        XCTAssertEqual(pthread_join(thread, nullptr), 0);
+        if (reusedPort) {
+            return;
+        }
+    }
+    XCTSkip(@"No thread reused the port name of the first thread.");
+}
+
+- (void)testRefreshesMetadataOfRenamedThreads
+{
+    ThreadMetadataCache cache;
+    __block std::string nameBeforeRename;
+    __block std::string nameAfterRename;
+    __block std::string nameAfterCheck;
+    ThreadMetadataCache *const cachePtr = &cache;
+    const auto expectation = [self expectationWithDescription:@"thread was renamed"];
+    [[[NSThread alloc] initWithBlock:^{
+        pthread_setname_np("io.test.before");
+        const auto handle = ThreadHandle::current();
+        nameBeforeRename = cachePtr->metadataForThread(*handle).name;
+
+        pthread_setname_np("io.test.after");
+        cachePtr->beginGeneration();
+        nameAfterRename = cachePtr->metadataForThread(*handle).name;
+
+        // the name is compared once enough generations have passed
+        for (int i = 0; i < 100; i++) {
+            cachePtr->beginGeneration();
+        }
+        nameAfterCheck = cachePtr->metadataForThread(*handle).name;
+        [expectation fulfill];
+    }] start];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+
+    XCTAssertTrue(nameBeforeRename == "io.test.before");
+    XCTAssertTrue(nameAfterRename == "io.test.before");
+    XCTAssertTrue(nameAfterCheck == "io.test.after");
+}
+
 @end
 
 #endif
@@ -189,6 +189,52 @@ class SentryCrashIntegrationTests: NotificationCenterTestCase {
         XCTAssertFalse(SentryDependencyContainer.sharedInstance().crashReporter.introspectMemory)
     }
 
+    func testMaxCrashReportSize_shouldSetMaxReportSizeOnCrashReporter() throws {
+        try XCTSkipIf(SentryTestSetup.isKSCrashEnabled, "Skipping SentryCrash test while in KSCrash mode")
+
+        // Arrange
+        fixture.options.experimental.maxCrashReportSize = 65_536
+
+        // Act
+        _ = try fixture.getSut()
+
+        // Assert
+        XCTAssertEqual(SentryDependencyContainer.sharedInstance().crashReporter.maxReportSize, 65_536)
+    }
+
+    func testMaxCrashReportSize_defaultValue_shouldBeNoLimit() throws {
+        try XCTSkipIf(SentryTestSetup.isKSCrashEnabled, "Skipping SentryCrash test while in KSCrash mode")
+
+        // Act
+        _ = try fixture.getSut()
+
+        // Assert
+        XCTAssertEqual(SentryDependencyContainer.sharedInstance().crashReporter.maxReportSize, 0)
+    }
+
+    func testMaxCrashReportStoreSize_shouldSetMaxReportStoreSizeOnCrashReporter() throws {
+        try XCTSkipIf(SentryTestSetup.isKSCrashEnabled, "Skipping SentryCrash test while in KSCrash mode")
+
+        // Arrange
+        fixture.options.experimental.maxCrashReportStoreSize = 1_048_576
+
+        // Act
+        _ = try fixture.getSut()
+
+        // Assert
+        XCTAssertEqual(SentryDependencyContainer.sharedInstance().crashReporter.maxReportStoreSize, 1_048_576)
+    }
+
+    func testMaxCrashReportStoreSize_defaultValue_shouldBeNoLimit() throws {
+        try XCTSkipIf(SentryTestSetup.isKSCrashEnabled, "Skipping SentryCrash test while in KSCrash mode")
+
+        // Act
+        _ = try fixture.getSut()
+
+        // Assert
+        XCTAssertEqual(SentryDependencyContainer.sharedInstance().crashReporter.maxReportStoreSize, 0)
+    }
+
     func testEndSessionAsCrashed_WithCurrentSession() throws {
         try XCTSkipIf(SentryTestSetup.isKSCrashEnabled, "Skipping SentryCrash test while in KSCrash mode")
 
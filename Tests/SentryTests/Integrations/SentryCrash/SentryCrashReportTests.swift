@@ -35,6 +35,7 @@ class SentryCrashReportTests: XCTestCase {
         super.tearDown()
         
         deleteTestDir()
+        sentrycrashreport_setMaxReportSize(0)
         // swiftlint:disable:next avoid_clear_test_state - just disabled to allow adding the SwiftLint rule. Please double check if you can remove this when touching this.
         clearTestState()
         sentrycrashbic_stopCache()
@@ -174,6 +175,78 @@ class SentryCrashReportTests: XCTestCase {
         XCTAssertEqual(0, mach.subcode)
     }
 
+    func testCrashReport_WithoutMaxReportSize_DoesNotContainTruncation() throws {
+        serializeToCrashReport(scope: fixture.scope)
+        writeCrashReport()
+
+        let crashReport = try readCrashReportJSON()
+        XCTAssertNil(crashReport["truncation"])
+        XCTAssertNotNil(crashReport["sentry_sdk_scope"])
+    }
+
+    func testCrashReport_WithoutMaxReportSize_WritesBinaryImagesBeforeCrash() throws {
+        serializeToCrashReport(scope: fixture.scope)
+        writeCrashReport()
+
+        // A report cut short, for example by a second crash while writing it, keeps the images
+        // needed to symbolicate whatever was written after them.
+        let crashReportContents = try XCTUnwrap(FileManager.default.contents(atPath: fixture.reportPath))
+        let crashReportString = try XCTUnwrap(String(data: crashReportContents, encoding: .utf8))
+        let binaryImagesRange = try XCTUnwrap(crashReportString.range(of: "\"binary_images\""))
+        let crashRange = try XCTUnwrap(crashReportString.range(of: "\"crash\""))
+        XCTAssertLessThan(binaryImagesRange.lowerBound, crashRange.lowerBound)
+    }
+
+    func testCrashReport_ContainsCPPExceptionThrowCountersInDebug() throws {
+        writeCrashReport()
+
+        let crashReport = try readCrashReportJSON()
+        let debug = try XCTUnwrap(crashReport["debug"] as? [String: Any])
+        let throwCounters = try XCTUnwrap(debug["cpp_exception_throws"] as? [String: Any])
+        let throwCount = try XCTUnwrap(throwCounters["throw_count"] as? Int)
+        let nsExceptionThrowCount = try XCTUnwrap(throwCounters["ns_exception_throw_count"] as? Int)
+        let capturedStackTraceCount = try XCTUnwrap(throwCounters["captured_stack_trace_count"] as? Int)
+        XCTAssertLessThanOrEqual(nsExceptionThrowCount + capturedStackTraceCount, throwCount)
+    }
+
+    func testCrashReport_ExceedingMaxReportSize_OmitsLeastImportantSections() throws {
+        let maxReportSize = 32_768
+        serializeToCrashReport(scope: fixture.scope)
+        sentrycrashreport_setMaxReportSize(Int64(maxReportSize))
+
+        writeCrashReportForCurrentThread()
+
+        let crashReport = try readCrashReportJSON()
+        let truncation = try XCTUnwrap(crashReport["truncation"] as? [String: Any])
+        XCTAssertEqual(maxReportSize, truncation["max_size"] as? Int)
+        XCTAssertGreaterThan(try XCTUnwrap(truncation["omitted_binary_images"] as? Int), 0)
+        XCTAssertNotNil(crashReport["report"])
+        XCTAssertNotNil(crashReport["sentry_sdk_scope"])
+
+        // The crashed thread and the images its frames are in are always kept.
+        let crash = try XCTUnwrap(crashReport["crash"] as? [String: Any])
+        let threads = try XCTUnwrap(crash["threads"] as? [[String: Any]])
+        let crashedThread = try XCTUnwrap(threads.first { $0["crashed"] as? Bool == true })
+        let backtrace = try XCTUnwrap(crashedThread["backtrace"] as? [String: Any])
+        let frames = try XCTUnwrap(backtrace["contents"] as? [[String: Any]])
+        XCTAssertFalse(frames.isEmpty)
+
+        let binaryImages = try XCTUnwrap(crashReport["binary_images"] as? [[String: Any]])
+        for frame in frames {
+            let address = try XCTUnwrap(frame["instruction_addr"] as? UInt64)
+            var image = SentryCrashBinaryImage()
+            guard sentrycrashbic_imageForAddress(address, &image) else { continue }
+            XCTAssertTrue(binaryImages.contains { $0["image_addr"] as? UInt64 == image.address },
+                          "The image of frame \(address) is missing from the report")
+        }
+
+        // Less important sections fill the report up to the limit, but not over it.
+        let attributes = try fileManager.attributesOfItem(atPath: fixture.reportPath)
+        let reportSize = try XCTUnwrap(attributes[.size] as? Int)
+        XCTAssertLessThanOrEqual(reportSize, maxReportSize)
+        XCTAssertGreaterThan(reportSize, maxReportSize * 3 / 4)
+    }
+
 #if os(iOS) && !targetEnvironment(macCatalyst)
     // We can't really test reading the crash_info_message from the crash_info section unless there is an
     // actual crash. To correctly test this, you must use an fatalError and let an app crash.
@@ -218,6 +291,31 @@ class SentryCrashReportTests: XCTestCase {
         sentrycrashreport_writeStandardReport(&localMonitorContext, fixture.reportPath)
     }
     
+    /**
+     * Writes a report with the current thread as the crashed thread, so that the report contains
+     * its backtrace and the binary images the backtrace references.
+     */
+    private func writeCrashReportForCurrentThread() {
+        var machineContext = SentryCrashMachineContext()
+        sentrycrashmc_getContextForThread(sentrycrashthread_self(), &machineContext, true)
+        var cursor = SentryCrashStackCursor()
+        sentrycrashsc_initSelfThread(&cursor, 0)
+
+        var monitorContext = SentryCrash_MonitorContext()
+        withUnsafeMutablePointer(to: &machineContext) { machineContextPointer in
+            withUnsafeMutablePointer(to: &cursor) { cursorPointer in
+                monitorContext.offendingMachineContext = machineContextPointer
+                monitorContext.stackCursor = UnsafeMutableRawPointer(cursorPointer)
+                writeCrashReport(monitorContext: monitorContext)
+            }
+        }
+    }
+
+    private func readCrashReportJSON() throws -> [String: Any] {
+        let crashReportContents = try XCTUnwrap(FileManager.default.contents(atPath: fixture.reportPath))
+        return try XCTUnwrap(JSONSerialization.jsonObject(with: crashReportContents) as? [String: Any])
+    }
+
     /**
      * UserInfo is picked up by the crash report when writing a new report.
      */
@@ -274,7 +274,7 @@ class SentryCrashScopeObserverTests: XCTestCase {
         var i = scope.pointee.currentCrumb
         var crumbPointer = breadcrumbs[i]
         for crumb in crumbs {
-            let scopeCrumbJSON = String(cString: crumbPointer ?? UnsafeMutablePointer<CChar>.allocate(capacity: 0))
+            let scopeCrumbJSON = try getJson(field: XCTUnwrap(crumbPointer))
             
             XCTAssertEqual(try serialize(object: crumb.serialize()), scopeCrumbJSON)
 
@@ -283,6 +283,66 @@ class SentryCrashScopeObserverTests: XCTestCase {
         }
     }
 
+    func testManyUpdates_KeepsLatestValues() throws {
+        let sut = fixture.sut
+        sut.setDist(fixture.dist)
+        sut.setTags(fixture.tags)
+
+        // Replace the fields and breadcrumbs many times.
+        let padding = String(repeating: "a", count: 1_024)
+        for i in 0..<1_000 {
+            sut.setEnvironment("\(i)\(padding)")
+            let crumb = TestData.crumb
+            crumb.message = "\(i)"
+            sut.addSerializedBreadcrumb(crumb.serialize())
+        }
+
+        XCTAssertEqual(try serialize(object: fixture.dist), getScopeJson { $0.dist })
+        XCTAssertEqual(try serialize(object: fixture.tags), getScopeJson { $0.tags })
+        XCTAssertEqual(try serialize(object: "999\(padding)"), getScopeJson { $0.environment })
+
+        let environment = try XCTUnwrap(getCrashScope().environment)
+        XCTAssertTrue(sentrycrash_scopesync_isRecord(environment))
+        XCTAssertEqual(try XCTUnwrap(getJson(field: environment)).utf8.count, sentrycrash_scopesync_getLength(environment))
+
+        let breadcrumbs = try XCTUnwrap(getCrashScope().breadcrumbs)
+        let lastCrumbIndex = (getCrashScope().currentCrumb + fixture.maxBreadcrumbs - 1) % fixture.maxBreadcrumbs
+        let lastCrumb = try XCTUnwrap(breadcrumbs[lastCrumbIndex])
+        let crumb = TestData.crumb
+        crumb.message = "999"
+        XCTAssertEqual(try serialize(object: crumb.serialize()), getJson(field: lastCrumb))
+    }
+
+    func testExtra_WithAllJSONTypes_IsSameAsSerializingIt() throws {
+        let sut = fixture.sut
+        let extras: [String: Any] = [
+            "string": "quote \" backslash \\ newline \n tab \t ü",
+            "integer": -1_234_567_890_123,
+            "double": 3.141_592_653_589_793,
+            "bool": true,
+            "null": NSNull(),
+            "date": Date(timeIntervalSince1970: 1_700_000_000),
+            "data": Data([0x00, 0xAB, 0xFF]),
+            "array": [1, "two", [3.5], ["nested": false]] as [Any],
+            "dict": ["b": 2, "a": ["c": "d"]] as [String: Any]
+        ]
+        sut.setExtras(extras)
+
+        let json = try XCTUnwrap(getScopeJson { $0.extras })
+        XCTAssertEqual(try serialize(object: extras), json)
+
+        let field = try XCTUnwrap(getCrashScope().extras)
+        XCTAssertGreaterThanOrEqual(sentrycrash_scopesync_getLength(field), json.utf8.count)
+    }
+
+    func testTags_WithInvalidCharacter_KeepsPreviousTags() throws {
+        let sut = fixture.sut
+        sut.setTags(fixture.tags)
+        sut.setTags(["tag": "\u{1}"])
+
+        XCTAssertEqual(try serialize(object: fixture.tags), getScopeJson { $0.tags })
+    }
+
     func testClear() {
         let sut = fixture.sut
         let user = TestData.user
@@ -325,7 +385,18 @@ class SentryCrashScopeObserverTests: XCTestCase {
             return nil
         }
         
-        return String(cString: charPointer)
+        return getJson(field: charPointer)
+    }
+
+    /**
+     * The fields are binary records, which are only written as JSON into crash reports.
+     */
+    private func getJson(field: UnsafePointer<CChar>) -> String? {
+        var buffer = [CChar](repeating: 0, count: 65_536)
+        guard sentrycrashreport_writeScopeFieldJSONForTests(field, &buffer, buffer.count) else {
+            return nil
+        }
+        return String(cString: buffer)
     }
     
     private func assertOneCrumbSetToScope(crumb: Breadcrumb) throws {
@@ -335,8 +406,8 @@ class SentryCrashScopeObserverTests: XCTestCase {
         
         XCTAssertEqual(1, scope.pointee.currentCrumb)
         
-        let breadcrumbs = scope.pointee.breadcrumbs
-        let breadcrumbJSON = String(cString: breadcrumbs?.pointee ?? UnsafeMutablePointer<CChar>.allocate(capacity: 0))
+        let breadcrumbs = try XCTUnwrap(scope.pointee.breadcrumbs)
+        let breadcrumbJSON = try getJson(field: XCTUnwrap(breadcrumbs.pointee))
         
         XCTAssertEqual(expected, breadcrumbJSON)
     }
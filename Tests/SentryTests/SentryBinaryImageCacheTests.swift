@@ -195,6 +195,23 @@ class SentryBinaryImageCacheTests: XCTestCase {
         XCTAssertNil(sut.imageByAddress(300))
         XCTAssertNil(sut.imageByAddress(399))
     }
+
+    func testImagesContainingAddresses_shouldReturnEachReferencedImageOnce() {
+        addBinaryImageToSut(createCrashBinaryImage(100))
+        addBinaryImageToSut(createCrashBinaryImage(400))
+        addBinaryImageToSut(createCrashBinaryImage(200))
+        addBinaryImageToSut(createCrashBinaryImage(0))
+
+        let images = sut.imagesContaining(addresses: [450, 150, 300, 199, 10_000, 100])
+
+        XCTAssertEqual(images.map { $0.name }, ["Expected Name at 100", "Expected Name at 400"])
+    }
+
+    func testImagesContainingAddresses_WhenNoAddresses_shouldReturnEmpty() {
+        addBinaryImageToSut(createCrashBinaryImage(100))
+
+        XCTAssertTrue(sut.imagesContaining(addresses: []).isEmpty)
+    }
     
     func testBinaryImageWithNULLName_DoesNotAddImage() {
         let address = UInt64(100)
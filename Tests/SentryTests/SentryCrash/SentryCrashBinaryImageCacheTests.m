@@ -324,6 +324,45 @@ initializeTestCacheState(SentryCrashBinaryImageCacheState *cache)
     [self assertCachedBinaryImages];
 }
 
+- (void)testImageForAddress_shouldFindEveryCachedImage
+{
+    sentrycrashbic_startCache();
+    addBinaryImage([mach_headers_test_cache[5] pointerValue], 0);
+
+    NSArray *images = [self binaryImageCacheToArray];
+    XCTAssertEqual(images.count, 6u);
+    for (NSValue *value in images) {
+        SentryCrashBinaryImage *expected = value.pointerValue;
+        SentryCrashBinaryImage image;
+
+        XCTAssertTrue(sentrycrashbic_imageForAddress(expected->address, &image));
+        XCTAssertEqual(image.address, expected->address);
+        uint64_t lastAddress = expected->address + expected->size - 1;
+        XCTAssertTrue(sentrycrashbic_imageForAddress(lastAddress, &image));
+        XCTAssertEqual(image.address, expected->address);
+    }
+}
+
+- (void)testImageForAddress_whenImageRemoved_shouldNotFindImage
+{
+    sentrycrashbic_startCache();
+    const struct mach_header *header = [mach_headers_expect_array[1] pointerValue];
+    SentryCrashBinaryImage image;
+    XCTAssertTrue(sentrycrashbic_imageForAddress((uint64_t)header, &image));
+
+    removeBinaryImage(header, 0);
+
+    XCTAssertFalse(sentrycrashbic_imageForAddress((uint64_t)header, &image));
+}
+
+- (void)testImageForAddress_whenAddressIsNotInAnyImage_shouldReturnFalse
+{
+    sentrycrashbic_startCache();
+    SentryCrashBinaryImage image;
+
+    XCTAssertFalse(sentrycrashbic_imageForAddress(0, &image));
+}
+
 - (void)testRemoveImageAddAgain
 {
     // Use index 1 since we can't dynamically insert dyld image (`dladdr` returns null)
@@ -26,7 +26,9 @@
 #import <XCTest/XCTest.h>
 
 #import "SentryCrashCachedData.h"
+#import "SentryCrashThread.h"
 #import "TestThread.h"
+#import <pthread.h>
 
 @interface SentryCrashCachedData_Tests : XCTestCase
 @end
@@ -254,6 +256,73 @@
     [thread cancel];
 }
 
+- (void)testGetThreadName_whenThreadStartedAfterInit_shouldReturnNameOfBothThreads
+{
+    // -- Arrange --
+    NSString *firstName = @"First thread";
+    NSString *secondName = @"Second thread";
+    TestThread *firstThread = [self startThreadWithName:firstName];
+    sentrycrashccd_init(1);
+
+    // -- Act --
+    TestThread *secondThread = [self startThreadWithName:secondName];
+    [NSThread sleepForTimeInterval:2.0];
+    sentrycrashccd_freeze();
+    const char *cFirstName = sentrycrashccd_getThreadName(firstThread.thread);
+    const char *cSecondName = sentrycrashccd_getThreadName(secondThread.thread);
+
+    // -- Assert --
+    XCTAssertTrue(cFirstName != NULL);
+    XCTAssertTrue(cSecondName != NULL);
+    XCTAssertEqualObjects([NSString stringWithUTF8String:cFirstName], firstName);
+    XCTAssertEqualObjects([NSString stringWithUTF8String:cSecondName], secondName);
+
+    sentrycrashccd_unfreeze();
+    [firstThread cancel];
+    [secondThread cancel];
+}
+
+- (void)testGetThreadName_whenThreadNamedAfterCacheSawIt_shouldReturnNewName
+{
+    // -- Arrange --
+    __block SentryCrashThread machThread = 0;
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    dispatch_semaphore_t shouldRename = dispatch_semaphore_create(0);
+    dispatch_semaphore_t renamed = dispatch_semaphore_create(0);
+    dispatch_semaphore_t shouldExit = dispatch_semaphore_create(0);
+    NSThread *thread = [[NSThread alloc] initWithBlock:^{
+        machThread = sentrycrashthread_self();
+        dispatch_semaphore_signal(started);
+        dispatch_semaphore_wait(shouldRename, DISPATCH_TIME_FOREVER);
+        pthread_setname_np("Named later");
+        dispatch_semaphore_signal(renamed);
+        dispatch_semaphore_wait(shouldExit, DISPATCH_TIME_FOREVER);
+    }];
+    [thread start];
+    dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+
+    sentrycrashccd_init(1);
+    // Wait for the quick polls after start to finish, which query all threads, so the following
+    // updates only query threads that are new or had no name.
+    [NSThread sleepForTimeInterval:4.5];
+
+    // -- Act --
+    dispatch_semaphore_signal(shouldRename);
+    dispatch_semaphore_wait(renamed, DISPATCH_TIME_FOREVER);
+    [NSThread sleepForTimeInterval:1.5];
+    sentrycrashccd_freeze();
+    const char *cName = sentrycrashccd_getThreadName(machThread);
+
+    // -- Assert --
+    XCTAssertTrue(cName != NULL, @"The name set after the cache first saw the thread is missing");
+    if (cName != NULL) {
+        XCTAssertEqualObjects([NSString stringWithUTF8String:cName], @"Named later");
+    }
+
+    sentrycrashccd_unfreeze();
+    dispatch_semaphore_signal(shouldExit);
+}
+
 - (void)testFreezeUnfreeze_whenCycledMultipleTimes_shouldReturnConsistentResults
 {
     // -- Arrange --
@@ -282,6 +282,30 @@ testExceptionHandlerNoOp(
     [self waitForExpectations:@[ expectation ] timeout:1.0];
 }
 
+- (void)testSwapCxaThrowHandlerAfterUnswap_CallsHandler
+{
+    // Arrange
+    sentrycrashct_swap_cxa_throw(testExceptionHandlerNoOp);
+    sentrycrashct_unswap_cxa_throw();
+
+    try {
+        throw std::runtime_error("Runtime errrrrrorrrr!");
+    } catch (...) {
+    }
+    XCTAssertEqual(g_exceptionHandlerInvocations, 0);
+
+    sentrycrashct_swap_cxa_throw(testExceptionHandler);
+
+    // Act
+    try {
+        throw std::runtime_error("Runtime errrrrrorrrr!");
+    } catch (...) {
+    }
+
+    // Assert
+    XCTAssertEqual(g_exceptionHandlerInvocations, 1);
+}
+
 - (void)testCallSwapCxaThrowHandlerWithNULL_ReturnsMinusOne
 {
     // Test swapping with a NULL handler
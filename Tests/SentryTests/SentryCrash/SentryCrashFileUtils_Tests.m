@@ -397,6 +397,32 @@ isFileUtilsCanaryIntact(const GuardedSentryCrashFUPathBuffer *buffer)
     XCTAssertEqualObjects(actualFileContents, fileContents);
 }
 
+- (void)testWriteBuffered_WritesOverflowWithBufferedData
+{
+    int writeBufferSize = 4;
+    char writeBuffer[writeBufferSize];
+    SentryCrashBufferedWriter writer;
+    NSString *path = [self generateTempFilePath];
+    XCTAssertTrue(
+        sentrycrashfu_openBufferedWriter(&writer, path.UTF8String, writeBuffer, writeBufferSize));
+    XCTAssertTrue(sentrycrashfu_writeBufferedWriter(&writer, "123", 3));
+    XCTAssertEqual(writer.writeCalls, 0);
+    XCTAssertTrue(sentrycrashfu_writeBufferedWriter(&writer, "4567890", 7));
+    XCTAssertEqual(writer.writeCalls, 1);
+    XCTAssertEqual(writer.bytesWritten, 10);
+    XCTAssertTrue(sentrycrashfu_writeBufferedWriter(&writer, "ab", 2));
+    sentrycrashfu_closeBufferedWriter(&writer);
+    XCTAssertEqual(writer.writeCalls, 2);
+    XCTAssertEqual(writer.bytesWritten, 12);
+
+    NSError *error = nil;
+    NSString *actualFileContents = [NSString stringWithContentsOfFile:path
+                                                             encoding:NSUTF8StringEncoding
+                                                                error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(actualFileContents, @"1234567890ab");
+}
+
 - (void)testWriteBuffered_DataIsSmaller
 {
     int writeBufferSize = 10;
@@ -649,6 +675,25 @@ isFileUtilsCanaryIntact(const GuardedSentryCrashFUPathBuffer *buffer)
     XCTAssertEqualObjects(actual, expected, @"");
 }
 
+- (void)testMapFile
+{
+    NSError *error = nil;
+    NSString *path = [self.tempPath stringByAppendingPathComponent:@"test.txt"];
+    NSString *expected = @"testing a bunch of stuff.\nOh look, a newline!";
+    [expected writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:&error];
+    XCTAssertNil(error, @"");
+
+    const char *bytes;
+    int length;
+    XCTAssertFalse(sentrycrashfu_mapFile([path UTF8String], &bytes, &length, 10));
+    XCTAssertTrue(sentrycrashfu_mapFile([path UTF8String], &bytes, &length, 0));
+    NSString *actual = [[NSString alloc] initWithBytes:bytes
+                                                length:(NSUInteger)length
+                                              encoding:NSUTF8StringEncoding];
+    sentrycrashfu_unmapFile(bytes, length);
+    XCTAssertEqualObjects(actual, expected, @"");
+}
+
 - (void)testReadEntireFileBig
 {
     NSError *error = nil;
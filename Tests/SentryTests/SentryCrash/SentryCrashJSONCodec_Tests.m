@@ -813,6 +813,32 @@ toString(NSData *data)
     XCTAssertEqualObjects(result, original, @"");
 }
 
+- (void)testSerializeDeserializeLongStringWithEscapedChars
+{
+    NSError *error = (NSError *)self;
+    NSMutableString *string = [NSMutableString string];
+    NSMutableString *escaped = [NSMutableString string];
+    for (int i = 0; i < 200; i++) {
+        // Vary the run lengths so escapes land at every offset of a 16 byte block.
+        NSString *run = [@"abcdéfghijklmnopqrstuvwxyz0123456789ABCDEFGHIJ"
+            substringToIndex:(NSUInteger)(i % 47)];
+        [string appendFormat:@"%@%@", run, i % 2 == 0 ? @"\"" : @"\n"];
+        [escaped appendFormat:@"%@%@", run, i % 2 == 0 ? @"\\\"" : @"\\n"];
+    }
+    NSString *expected = [NSString stringWithFormat:@"[\"%@\"]", escaped];
+    id original = @[ string ];
+    NSString *jsonString = toString([SentryCrashJSONCodec encode:original
+                                                         options:SentryCrashJSONEncodeOptionSorted
+                                                           error:&error]);
+    XCTAssertNotNil(jsonString, @"");
+    XCTAssertNil(error, @"");
+    XCTAssertEqualObjects(jsonString, expected, @"");
+    id result = [SentryCrashJSONCodec decode:toData(jsonString) options:0 error:&error];
+    XCTAssertNotNil(result, @"");
+    XCTAssertNil(error, @"");
+    XCTAssertEqualObjects(result, original, @"");
+}
+
 - (void)testSerializeDeserializeFloat
 {
     NSError *error = (NSError *)self;
@@ -1805,6 +1831,137 @@ addJSONData(const char *data, int length, void *userData)
     [self expectEquivalentJSONData:encodedData toJSON:expectedJson];
 }
 
+typedef struct {
+    int elementCount;
+    int containerCount;
+    const char *lastSlice;
+    int lastSliceLength;
+} DecodeCounts;
+
+static int
+countElement(__unused const char *name, void *userData)
+{
+    ((DecodeCounts *)userData)->elementCount++;
+    return SentryCrashJSON_OK;
+}
+
+static int
+countBoolean(const char *name, __unused bool value, void *userData)
+{
+    return countElement(name, userData);
+}
+
+static int
+countFloatingPoint(const char *name, __unused double value, void *userData)
+{
+    return countElement(name, userData);
+}
+
+static int
+countInteger(const char *name, __unused int64_t value, void *userData)
+{
+    return countElement(name, userData);
+}
+
+static int
+countUInteger(const char *name, __unused uint64_t value, void *userData)
+{
+    return countElement(name, userData);
+}
+
+static int
+countString(const char *name, __unused const char *value, void *userData)
+{
+    return countElement(name, userData);
+}
+
+static int
+recordStringSlice(const char *name, const char *value, int length, void *userData)
+{
+    ((DecodeCounts *)userData)->lastSlice = value;
+    ((DecodeCounts *)userData)->lastSliceLength = length;
+    return countElement(name, userData);
+}
+
+static int
+skipMemoryContainers(const char *name, void *userData)
+{
+    if (name != NULL && strcmp(name, "memory") == 0) {
+        return SentryCrashJSON_SKIP_CONTAINER;
+    }
+    ((DecodeCounts *)userData)->containerCount++;
+    return SentryCrashJSON_OK;
+}
+
+static int
+countEndContainer(void *userData)
+{
+    ((DecodeCounts *)userData)->containerCount--;
+    return SentryCrashJSON_OK;
+}
+
+static int
+countEndData(__unused void *userData)
+{
+    return SentryCrashJSON_OK;
+}
+
+static SentryCrashJSONDecodeCallbacks g_countingCallbacks = {
+    .onBooleanElement = countBoolean,
+    .onFloatingPointElement = countFloatingPoint,
+    .onIntegerElement = countInteger,
+    .onUIntegerElement = countUInteger,
+    .onNullElement = countElement,
+    .onStringElement = countString,
+    .onBeginObject = skipMemoryContainers,
+    .onBeginArray = skipMemoryContainers,
+    .onEndContainer = countEndContainer,
+    .onEndData = countEndData,
+};
+
+- (void)testDecodeSkipsContainers
+{
+    const char *json = "{\"a\":1,\"memory\":{\"b\":[1,\"]}\\\"{\",{\"c\":null}]},"
+                       "\"memory\":[[],{}],\"d\":true}";
+    char stringBuffer[100];
+    DecodeCounts counts = { 0 };
+    int result = sentrycrashjson_decode(json, (int)strlen(json), stringBuffer,
+        sizeof(stringBuffer), &g_countingCallbacks, &counts, NULL);
+    XCTAssertEqual(result, SentryCrashJSON_OK);
+    XCTAssertEqual(counts.elementCount, 2);
+    XCTAssertEqual(counts.containerCount, 0);
+
+    const char *truncatedJSON = "{\"memory\":{\"b\":[1,2]";
+    result = sentrycrashjson_decode(truncatedJSON, (int)strlen(truncatedJSON), stringBuffer,
+        sizeof(stringBuffer), &g_countingCallbacks, &counts, NULL);
+    XCTAssertEqual(result, SentryCrashJSON_ERROR_INCOMPLETE);
+}
+
+- (void)testDecodeStringSlices
+{
+    SentryCrashJSONDecodeCallbacks callbacks = g_countingCallbacks;
+    callbacks.onStringSliceElement = recordStringSlice;
+    char stringBuffer[100];
+    DecodeCounts counts = { 0 };
+
+    // Strings without escapes point into the data, even if they don't fit the string buffer.
+    NSString *longString = [@"" stringByPaddingToLength:1000 withString:@"x" startingAtIndex:0];
+    NSString *json = [NSString stringWithFormat:@"[\"%@\"]", longString];
+    const char *data = json.UTF8String;
+    int result = sentrycrashjson_decode(data, (int)strlen(data), stringBuffer,
+        sizeof(stringBuffer), &callbacks, &counts, NULL);
+    XCTAssertEqual(result, SentryCrashJSON_OK);
+    XCTAssertEqual(counts.lastSlice, data + 2);
+    XCTAssertEqual(counts.lastSliceLength, 1000);
+
+    const char *escaped = "[\"a\\nb\"]";
+    result = sentrycrashjson_decode(escaped, (int)strlen(escaped), stringBuffer,
+        sizeof(stringBuffer), &callbacks, &counts, NULL);
+    XCTAssertEqual(result, SentryCrashJSON_OK);
+    XCTAssertEqual(counts.lastSliceLength, 3);
+    XCTAssertEqual(strncmp(counts.lastSlice, "a\nb", 3), 0);
+}
+
 - (NSArray<NSNumber *> *)decode:(NSString *)jsonString
 {
     NSError *error = nil;
@@ -1,8 +1,10 @@
+#include "SentryCompiler.h"
 #include "SentryCrashCxaThrowSwapper.h"
 #include "SentryCrashMonitorContext.h"
 #import "SentryCrashMonitor_CPPException.h"
 #import <XCTest/XCTest.h>
 
+#include <dlfcn.h>
 #include <stdexcept>
 
 @interface SentryTestNSExceptionSubclass : NSException
@@ -106,6 +108,35 @@ mockTerminationHandler(void)
     XCTAssertTrue(stackCursor.stackEntry.address > 0, "Stack trace should be captured.");
 }
 
+NEVER_INLINE void
+sentryTestThrowInvalidArgument(void)
+{
+    throw std::invalid_argument("Invalid Argument.");
+}
+
+- (void)testThrowCppException_FirstFrameIsTheThrowingFunction
+{
+    // Arrange
+    api->setEnabled(true);
+    sentrycrashcm_cppexception_enable_swap_cxa_throw();
+
+    try {
+        // Act
+        sentryTestThrowInvalidArgument();
+    } catch (...) {
+    }
+
+    // Assert
+    SentryCrashStackCursor stackCursor = sentrycrashcm_cppexception_getStackCursor();
+    XCTAssertTrue(stackCursor.advanceCursor(&stackCursor));
+    // The entry is the return address of the call to __cxa_throw, which can be the first byte
+    // after the throwing function, because __cxa_throw doesn't return.
+    Dl_info info;
+    XCTAssertNotEqual(dladdr((void *)(stackCursor.stackEntry.address - 1), &info), 0);
+    XCTAssertEqual(info.dli_saddr, (void *)sentryTestThrowInvalidArgument,
+        "The first frame should be the throwing function, but was %s.", info.dli_sname);
+}
+
 - (void)testThrowNSException_DoesNotCapturesStacktrace
 {
     // Arrange
@@ -125,6 +156,57 @@ mockTerminationHandler(void)
         stackCursor.stackEntry.address, (uintptr_t)0, "Stack trace should NOT be captured.");
 }
 
+- (void)testThrowCppException_CountsThrowAndCapturedStacktrace
+{
+    // Arrange
+    api->setEnabled(true);
+    sentrycrashcm_cppexception_enable_swap_cxa_throw();
+
+    // Act
+    for (int i = 0; i < 3; i++) {
+        try {
+            throw std::invalid_argument("Invalid Argument.");
+        } catch (...) {
+        }
+    }
+
+    // Assert
+    SentryCrashCPPExceptionThrowStatistics statistics
+        = sentrycrashcm_cppexception_getThrowStatistics();
+    XCTAssertEqual(statistics.throwCount, 3ULL);
+    XCTAssertEqual(statistics.nsExceptionThrowCount, 0ULL);
+    XCTAssertEqual(statistics.capturedStackTraceCount, 3ULL);
+}
+
+- (void)testThrowNSExceptionSubclassRepeatedly_CountsThrowsWithoutCapturingStacktrace
+{
+    // Arrange
+    api->setEnabled(true);
+    sentrycrashcm_cppexception_enable_swap_cxa_throw();
+
+    // Act
+    // The first throw classifies the class, the second one uses the cached classification.
+    for (int i = 0; i < 2; i++) {
+        @try {
+            [[SentryTestNSExceptionSubclass exceptionWithName:@"TestException"
+                                                       reason:@"Test"
+                                                     userInfo:nil] raise];
+        } @catch (...) {
+        }
+    }
+
+    // Assert
+    SentryCrashCPPExceptionThrowStatistics statistics
+        = sentrycrashcm_cppexception_getThrowStatistics();
+    XCTAssertEqual(statistics.nsExceptionThrowCount, statistics.throwCount);
+    XCTAssertEqual(statistics.capturedStackTraceCount, 0ULL);
+
+    SentryCrashStackCursor stackCursor = sentrycrashcm_cppexception_getStackCursor();
+    stackCursor.advanceCursor(&stackCursor);
+    XCTAssertEqual(
+        stackCursor.stackEntry.address, (uintptr_t)0, "Stack trace should NOT be captured.");
+}
+
 void
 mockHandleExceptionHandler(struct SentryCrash_MonitorContext *context)
 {
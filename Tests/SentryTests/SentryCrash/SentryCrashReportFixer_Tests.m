@@ -47,4 +47,70 @@
     XCTAssertEqualObjects(fixedObjects, processedObjects);
 }
 
+- (void)testSkipsMemoryIntrospectionSubtrees
+{
+    // Pretty printed, as the fixed report is pretty printed into a buffer 1.5 times the size of the
+    // raw report.
+    const char *rawReport = "{\n"
+                            "    \"crash\": {\n"
+                            "        \"threads\": [\n"
+                            "            {\n"
+                            "                \"index\": 0,\n"
+                            "                \"notable_addresses\": {\n"
+                            "                    \"x0\": {\n"
+                            "                        \"type\": \"object\",\n"
+                            "                        \"class\": \"Foo\",\n"
+                            "                        \"ivars\": {\n"
+                            "                            \"_bar\": {\n"
+                            "                                \"type\": \"string\",\n"
+                            "                                \"value\": \"baz\"\n"
+                            "                            }\n"
+                            "                        }\n"
+                            "                    },\n"
+                            "                    \"x1\": {\n"
+                            "                        \"type\": \"string\",\n"
+                            "                        \"value\": \"message\",\n"
+                            "                        \"first_object\": [\n"
+                            "                            1,\n"
+                            "                            2\n"
+                            "                        ]\n"
+                            "                    }\n"
+                            "                }\n"
+                            "            }\n"
+                            "        ]\n"
+                            "    },\n"
+                            "    \"user\": {\n"
+                            "        \"ivars\": [\n"
+                            "            1\n"
+                            "        ]\n"
+                            "    }\n"
+                            "}";
+    char *fixedBytes = sentrycrashcrf_fixupCrashReport(rawReport);
+    if (fixedBytes == NULL) {
+        XCTFail(@"Failed to fix up the report.");
+        return;
+    }
+    NSData *fixedData = [NSData dataWithBytesNoCopy:fixedBytes length:strlen(fixedBytes)];
+    NSError *error = nil;
+    NSDictionary *fixedObjects = [NSJSONSerialization JSONObjectWithData:fixedData
+                                                                 options:0
+                                                                   error:&error];
+    XCTAssertNil(error);
+
+    NSDictionary *expected = @{
+        @"crash" : @ {
+            @"threads" : @[ @{
+                @"index" : @0,
+                @"notable_addresses" : @ {
+                    @"x0" : @ { @"type" : @"object", @"class" : @"Foo" },
+                    @"x1" : @ { @"type" : @"string", @"value" : @"message" },
+                },
+            } ]
+        },
+        // Only the memory introspection is left out, not other fields that happen to share a name.
+        @"user" : @ { @"ivars" : @[ @1 ] },
+    };
+    XCTAssertEqualObjects(fixedObjects, expected);
+}
+
 @end
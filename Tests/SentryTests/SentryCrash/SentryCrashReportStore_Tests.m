@@ -467,6 +467,64 @@ makeUTCReportTime(int year, int month, int day, int hour, int minute, int second
     XCTAssertFalse([reportIDs containsObject:@(prunedReportID)]);
 }
 
+- (void)testPruneReports_whenExceedingMaxReportStoreSize_shouldDeleteOldestReports
+{
+    sentrycrashcrs_setMaxReportStoreSize(10);
+    [self prepareReportStoreWithPathEnd:@"testPruneReportsBySize"];
+    int64_t prunedReportID = [self writeUserReportWithStringContents:@"12345"];
+    int64_t keptReportID1 = [self writeUserReportWithStringContents:@"12345"];
+    int64_t keptReportID2 = [self writeCrashReportWithStringContents:@"12345"];
+    [self expectHasReportCount:3];
+
+    // Calls sentrycrashcrs_initialize() again, which prunes the reports.
+    [self prepareReportStoreWithPathEnd:@"testPruneReportsBySize"];
+    sentrycrashcrs_setMaxReportStoreSize(0);
+
+    NSArray *reportIDs = [self getReportIDs];
+    XCTAssertEqualObjects(reportIDs, (@[ @(keptReportID1), @(keptReportID2) ]));
+    XCTAssertFalse([reportIDs containsObject:@(prunedReportID)]);
+}
+
+- (void)testPruneReports_whenNewestReportExceedsMaxReportStoreSize_shouldKeepIt
+{
+    sentrycrashcrs_setMaxReportStoreSize(1);
+    [self prepareReportStoreWithPathEnd:@"testPruneReportsKeepsNewest"];
+    [self writeUserReportWithStringContents:@"12345"];
+    int64_t newestReportID = [self writeUserReportWithStringContents:@"12345"];
+
+    [self prepareReportStoreWithPathEnd:@"testPruneReportsKeepsNewest"];
+    sentrycrashcrs_setMaxReportStoreSize(0);
+
+    XCTAssertEqualObjects([self getReportIDs], @[ @(newestReportID) ]);
+}
+
+- (void)testReportCount_whenReportsDeletedOutsideOfStore_shouldNotCountThem
+{
+    [self prepareReportStoreWithPathEnd:@"testReportsDeletedOutsideOfStore"];
+    [self writeUserReportWithStringContents:@"1"];
+    [self writeCrashReportWithStringContents:@"2"];
+    [self expectHasReportCount:2];
+
+    [[NSFileManager defaultManager] removeItemAtPath:self.reportStorePath error:nil];
+    [[NSFileManager defaultManager] createDirectoryAtPath:self.reportStorePath
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:nil];
+
+    [self expectHasReportCount:0];
+}
+
+- (void)testDeleteReportWithID
+{
+    [self prepareReportStoreWithPathEnd:@"testDeleteReportWithID"];
+    int64_t deletedReportID = [self writeUserReportWithStringContents:@"1"];
+    int64_t keptReportID = [self writeCrashReportWithStringContents:@"2"];
+
+    sentrycrashcrs_deleteReportWithID(deletedReportID);
+
+    XCTAssertEqualObjects([self getReportIDs], @[ @(keptReportID) ]);
+}
+
 - (void)testStoresLoadsWithUnicodeAppName
 {
     self.appName = @"ЙогуртЙод";
@@ -1410,4 +1410,133 @@
     XCTAssertEqualObjects(messages.firstObject, unrelatedCrashInfo);
 }
 
+- (void)testBinaryImages_whenNotSortedByAddress_shouldResolveFramesAndDebugMeta
+{
+    // -- Arrange --
+    NSDictionary *mockReport = @{
+        @"crash" : @ {
+            @"threads" : @[ @{
+                @"index" : @0,
+                @"crashed" : @YES,
+                @"backtrace" : @ {
+                    @"contents" : @[
+                        @ { @"instruction_addr" : @0x5000 },
+                        @ { @"instruction_addr" : @0x1fff },
+                        @ { @"instruction_addr" : @0x3000 },
+                        @ { @"instruction_addr" : @0x9000 },
+                    ]
+                }
+            } ],
+            @"error" : @ { @"type" : @"signal" }
+        },
+        @"binary_images" : @[
+            @ { @"name" : @"/usr/lib/Unused", @"image_addr" : @0x7000, @"image_size" : @0x1000 },
+            @ { @"name" : @"/usr/lib/Second", @"image_addr" : @0x5000, @"image_size" : @0x1000 },
+            @ { @"name" : @"/usr/lib/Gap", @"image_addr" : @0x2000, @"image_size" : @0x1000 },
+            @ { @"name" : @"/usr/lib/First", @"image_addr" : @0x1000, @"image_size" : @0x1000 },
+        ],
+        @"system" : @ { @"application_stats" : @ { @"application_in_foreground" : @YES } }
+    };
+
+    // -- Act --
+    SentryCrashReportConverter *reportConverter =
+        [[SentryCrashReportConverter alloc] initWithReport:mockReport inAppLogic:self.inAppLogic];
+    SentryEvent *event = [reportConverter convertReportToEvent];
+
+    // -- Assert --
+    NSArray<SentryFrame *> *frames = event.threads.firstObject.stacktrace.frames;
+    XCTAssertEqual(frames.count, 4u);
+    // Frames are reversed, so the outermost frame comes first.
+    XCTAssertNil(frames[0].package);
+    XCTAssertEqualObjects(frames[1].package, @"/usr/lib/Gap");
+    XCTAssertEqualObjects(frames[1].imageAddress, @"0x0000000000002000");
+    XCTAssertEqualObjects(frames[2].package, @"/usr/lib/First");
+    XCTAssertEqualObjects(frames[3].package, @"/usr/lib/Second");
+
+    // Debug images keep the order of the report and only contain referenced images.
+    XCTAssertEqual(event.debugMeta.count, 3u);
+    XCTAssertEqualObjects(event.debugMeta[0].codeFile, @"/usr/lib/Second");
+    XCTAssertEqualObjects(event.debugMeta[1].codeFile, @"/usr/lib/Gap");
+    XCTAssertEqualObjects(event.debugMeta[2].codeFile, @"/usr/lib/First");
+}
+
+- (void)testBinaryImages_whenStartAddressesAreDuplicated_shouldResolveToFirstImage
+{
+    // -- Arrange --
+    NSDictionary *mockReport = @{
+        @"crash" : @ {
+            @"threads" : @[ @{
+                @"index" : @0,
+                @"crashed" : @YES,
+                @"backtrace" : @ {
+                    @"contents" : @[
+                        @ { @"instruction_addr" : @0x1800 },
+                        @ { @"instruction_addr" : @0x2800 },
+                    ]
+                }
+            } ],
+            @"error" : @ { @"type" : @"signal" }
+        },
+        @"binary_images" : @[
+            @ { @"name" : @"/usr/lib/First", @"image_addr" : @0x1000, @"image_size" : @0x1000 },
+            @ { @"name" : @"/usr/lib/Second", @"image_addr" : @0x1000, @"image_size" : @0x2000 },
+            @ { @"name" : @"/usr/lib/Third", @"image_addr" : @0x1000, @"image_size" : @0x2000 },
+        ],
+        @"system" : @ { @"application_stats" : @ { @"application_in_foreground" : @YES } }
+    };
+
+    // -- Act --
+    SentryCrashReportConverter *reportConverter =
+        [[SentryCrashReportConverter alloc] initWithReport:mockReport inAppLogic:self.inAppLogic];
+    SentryEvent *event = [reportConverter convertReportToEvent];
+
+    // -- Assert --
+    NSArray<SentryFrame *> *frames = event.threads.firstObject.stacktrace.frames;
+    XCTAssertEqual(frames.count, 2u);
+    // Frames are reversed, so the outermost frame comes first.
+    XCTAssertEqualObjects(frames[0].package, @"/usr/lib/Second");
+    XCTAssertEqualObjects(frames[1].package, @"/usr/lib/First");
+}
+
+- (void)testBinaryImages_whenImageIsNestedInLargerImage_shouldResolveToFirstContainingImage
+{
+    // -- Arrange --
+    NSDictionary *mockReport = @{
+        @"crash" : @ {
+            @"threads" : @[ @{
+                @"index" : @0,
+                @"crashed" : @YES,
+                @"backtrace" : @ {
+                    @"contents" : @[
+                        @ { @"instruction_addr" : @0x3800 },
+                        @ { @"instruction_addr" : @0x2000 },
+                        @ { @"instruction_addr" : @0x2800 },
+                    ]
+                }
+            } ],
+            @"error" : @ { @"type" : @"signal" }
+        },
+        @"binary_images" : @[
+            @ { @"name" : @"/usr/lib/Outer", @"image_addr" : @0x1000, @"image_size" : @0x4000 },
+            @ { @"name" : @"/usr/lib/Empty", @"image_addr" : @0x2000, @"image_size" : @0 },
+            @ { @"name" : @"/usr/lib/Nested", @"image_addr" : @0x3000, @"image_size" : @0x100 },
+        ],
+        @"system" : @ { @"application_stats" : @ { @"application_in_foreground" : @YES } }
+    };
+
+    // -- Act --
+    SentryCrashReportConverter *reportConverter =
+        [[SentryCrashReportConverter alloc] initWithReport:mockReport inAppLogic:self.inAppLogic];
+    SentryEvent *event = [reportConverter convertReportToEvent];
+
+    // -- Assert --
+    NSArray<SentryFrame *> *frames = event.threads.firstObject.stacktrace.frames;
+    XCTAssertEqual(frames.count, 3u);
+    // Frames are reversed, so the outermost frame comes first. Each address lies after a smaller
+    // image that starts closer to it, but only the outer image contains it.
+    XCTAssertEqualObjects(frames[0].package, @"/usr/lib/Outer");
+    XCTAssertEqualObjects(frames[1].package, @"/usr/lib/Outer");
+    XCTAssertEqualObjects(frames[2].package, @"/usr/lib/Outer");
+}
+
 @end